@@ -183,6 +183,7 @@ filter("platforms:Windows")
     "shcore",
     "shlwapi",
     "dxguid",
+    "synchronization",
   })
 
 -- Create scratch/ path
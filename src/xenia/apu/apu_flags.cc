@@ -10,3 +10,19 @@
 #include "xenia/apu/apu_flags.h"
 
 DEFINE_bool(mute, false, "Mutes all audio output.", "APU")
+
+DEFINE_int32(apu_decoder_threads, -1,
+             "Number of threads decoding XMA contexts. -1 to pick from the "
+             "number of host cores.",
+             "APU")
+
+DEFINE_int32(apu_min_queued_frames, 1,
+             "Frames of audio (256 samples each) to queue before playback "
+             "starts or resumes after running dry. Higher values trade latency "
+             "for fewer crackles under load.",
+             "APU")
+
+DEFINE_int32(apu_max_queued_frames, 0,
+             "Most frames of audio to keep queued; older frames are dropped to "
+             "catch up when the host falls behind. 0 for no limit.",
+             "APU")
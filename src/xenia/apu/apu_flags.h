@@ -13,4 +13,8 @@
 #include "xenia/base/cvar.h"
 DECLARE_bool(mute)
 
+DECLARE_int32(apu_decoder_threads)
+DECLARE_int32(apu_min_queued_frames)
+DECLARE_int32(apu_max_queued_frames)
+
 #endif  // XENIA_APU_APU_FLAGS_H_
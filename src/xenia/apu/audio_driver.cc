@@ -9,6 +9,13 @@
 
 #include "xenia/apu/audio_driver.h"
 
+#include <algorithm>
+#include <cstring>
+
+#include "xenia/apu/apu_flags.h"
+#include "xenia/base/assert.h"
+#include "xenia/base/math.h"
+
 namespace xe {
 namespace apu {
 
@@ -16,5 +23,71 @@ AudioDriver::AudioDriver(Memory* memory) : memory_(memory) {}
 
 AudioDriver::~AudioDriver() = default;
 
+void AudioDriver::InitializeFrameQueue(uint32_t frame_samples) {
+  frame_samples_ = frame_samples;
+  frames_.reset(new float[size_t(frame_samples) * kFrameQueueCapacity]);
+  read_count_ = 0;
+  write_count_ = 0;
+  refilling_ = true;
+}
+
+float* AudioDriver::AcquireFrame() {
+  assert_not_null(frames_);
+  uint32_t write_count = write_count_.load(std::memory_order_relaxed);
+  uint32_t read_count = read_count_.load(std::memory_order_acquire);
+  if (write_count - read_count >= kFrameQueueCapacity) {
+    ++overrun_count_;
+    return nullptr;
+  }
+  return &frames_[size_t(write_count % kFrameQueueCapacity) * frame_samples_];
+}
+
+void AudioDriver::CommitFrame() {
+  write_count_.store(write_count_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+}
+
+uint32_t AudioDriver::ReadFrame(float* output) {
+  uint32_t read_count = read_count_.load(std::memory_order_relaxed);
+  uint32_t queued_count =
+      write_count_.load(std::memory_order_acquire) - read_count;
+
+  // Hold off after running dry until there's enough to not run dry again on
+  // the next callback.
+  uint32_t min_queued_count = uint32_t(
+      xe::clamp(cvars::apu_min_queued_frames, 1, int(kFrameQueueCapacity)));
+  if (!queued_count) {
+    if (!refilling_) {
+      ++underrun_count_;
+      refilling_ = true;
+    }
+  } else if (queued_count >= min_queued_count) {
+    refilling_ = false;
+  }
+  if (refilling_) {
+    std::memset(output, 0, sizeof(float) * frame_samples_);
+    return 0;
+  }
+
+  // Skip ahead rather than let latency build up when the host falls behind.
+  uint32_t dropped_count = 0;
+  if (cvars::apu_max_queued_frames > 0) {
+    uint32_t max_queued_count = std::max(
+        uint32_t(cvars::apu_max_queued_frames), min_queued_count);
+    if (queued_count > max_queued_count) {
+      dropped_count = queued_count - max_queued_count;
+      read_count += dropped_count;
+      overrun_count_ += dropped_count;
+    }
+  }
+
+  std::memcpy(
+      output,
+      &frames_[size_t(read_count % kFrameQueueCapacity) * frame_samples_],
+      sizeof(float) * frame_samples_);
+  read_count_.store(read_count + 1, std::memory_order_release);
+  return dropped_count + 1;
+}
+
 }  // namespace apu
 }  // namespace xe
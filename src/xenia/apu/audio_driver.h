@@ -10,6 +10,9 @@
 #ifndef XENIA_APU_AUDIO_DRIVER_H_
 #define XENIA_APU_AUDIO_DRIVER_H_
 
+#include <atomic>
+#include <memory>
+
 #include "xenia/memory.h"
 #include "xenia/xbox.h"
 
@@ -18,17 +21,52 @@ namespace apu {
 
 class AudioDriver {
  public:
+  // Matches the most frames AudioSystem lets a client have in flight.
+  static const uint32_t kFrameQueueCapacity = 64;
+
   explicit AudioDriver(Memory* memory);
   virtual ~AudioDriver();
 
   virtual void SubmitFrame(uint32_t samples_ptr) = 0;
 
+  // Times the host ran out of queued frames and played silence.
+  uint64_t underrun_count() const { return underrun_count_; }
+  // Frames dropped because the queue was full or past the latency target.
+  uint64_t overrun_count() const { return overrun_count_; }
+
  protected:
   inline uint8_t* TranslatePhysical(uint32_t guest_address) const {
     return memory_->TranslatePhysical(guest_address);
   }
 
+  // Frames are handed from the thread submitting them to the host audio
+  // callback through a ring of preallocated frames, so that neither side
+  // takes a lock or allocates. Only one thread may produce and one consume.
+  void InitializeFrameQueue(uint32_t frame_samples);
+
+  // Producer side. Returns the frame to fill next, or nullptr (counted as an
+  // overrun) if the queue is full, then publishes it.
+  float* AcquireFrame();
+  void CommitFrame();
+
+  // Consumer side. Copies the oldest frame to output, or silence if there's
+  // none to play yet. Returns how many frames were taken off the queue,
+  // including any dropped to get back to the latency target.
+  uint32_t ReadFrame(float* output);
+
   Memory* memory_ = nullptr;
+
+ private:
+  uint32_t frame_samples_ = 0;
+  std::unique_ptr<float[]> frames_;
+  // Free running; the frame index is the count modulo the capacity.
+  std::atomic<uint32_t> read_count_ = {0};
+  std::atomic<uint32_t> write_count_ = {0};
+  // Consumer only: waiting for the queue to refill after running dry.
+  bool refilling_ = true;
+
+  std::atomic<uint64_t> underrun_count_ = {0};
+  std::atomic<uint64_t> overrun_count_ = {0};
 };
 
 }  // namespace apu
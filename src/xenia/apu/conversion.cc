@@ -0,0 +1,187 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/apu/conversion.h"
+
+#include "xenia/base/byte_order.h"
+#include "xenia/base/math.h"
+#include "xenia/base/memory.h"
+#include "xenia/base/platform.h"
+
+namespace xe {
+namespace apu {
+namespace conversion {
+
+namespace {
+
+uint16_t FloatToS16(float value) {
+  return uint16_t(int(xe::saturate(value) * ((1 << 15) - 1)));
+}
+
+void PlanarFloatBEToInterleavedFloatGeneric(float* output, const float* input,
+                                            uint32_t channel_count,
+                                            uint32_t channel_samples,
+                                            uint32_t first_sample) {
+  for (uint32_t i = first_sample; i < channel_samples; ++i) {
+    for (uint32_t j = 0; j < channel_count; ++j) {
+      output[i * channel_count + j] =
+          xe::byte_swap(input[j * channel_samples + i]);
+    }
+  }
+}
+
+void PlanarFloatToInterleavedS16BEGeneric(uint8_t* output,
+                                          const float* const* input,
+                                          uint32_t channel_count,
+                                          uint32_t channel_samples,
+                                          uint32_t first_sample) {
+  for (uint32_t i = first_sample; i < channel_samples; ++i) {
+    for (uint32_t j = 0; j < channel_count; ++j) {
+      xe::store_and_swap<uint16_t>(&output[(i * channel_count + j) * 2],
+                                   FloatToS16(input[j][i]));
+    }
+  }
+}
+
+#if XE_ARCH_AMD64
+__m128 LoadFloatBE(const float* input) {
+  const __m128i swap_mask =
+      _mm_set_epi8(0x0C, 0x0D, 0x0E, 0x0F, 0x08, 0x09, 0x0A, 0x0B, 0x04, 0x05,
+                   0x06, 0x07, 0x00, 0x01, 0x02, 0x03);
+  __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+  return _mm_castsi128_ps(_mm_shuffle_epi8(value, swap_mask));
+}
+
+// Converts 8 samples as FloatToS16 does and swaps them. The operand order of
+// min matters: it returns the second operand for NaN, like xe::saturate.
+__m128i LoadS16BE(const float* input) {
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 minus_one = _mm_set1_ps(-1.0f);
+  const __m128 scale = _mm_set1_ps(float((1 << 15) - 1));
+  const __m128i swap_mask =
+      _mm_set_epi8(0x0E, 0x0F, 0x0C, 0x0D, 0x0A, 0x0B, 0x08, 0x09, 0x06, 0x07,
+                   0x04, 0x05, 0x02, 0x03, 0x00, 0x01);
+  __m128 low = _mm_loadu_ps(input);
+  __m128 high = _mm_loadu_ps(input + 4);
+  low = _mm_mul_ps(_mm_max_ps(_mm_min_ps(low, one), minus_one), scale);
+  high = _mm_mul_ps(_mm_max_ps(_mm_min_ps(high, one), minus_one), scale);
+  __m128i value =
+      _mm_packs_epi32(_mm_cvttps_epi32(low), _mm_cvttps_epi32(high));
+  return _mm_shuffle_epi8(value, swap_mask);
+}
+
+// Stores x0 y0 z0 x1 y1 z1 x2 y2 z2 x3 y3 z3.
+void StoreInterleaved3(float* output, __m128 x, __m128 y, __m128 z) {
+  __m128 xy_low = _mm_unpacklo_ps(x, y);
+  __m128 xy_high = _mm_unpackhi_ps(x, y);
+  __m128 yz_low = _mm_unpacklo_ps(y, z);
+  __m128 yz_high = _mm_unpackhi_ps(y, z);
+  __m128 zx_low = _mm_unpacklo_ps(z, x);
+  __m128 zx_high = _mm_unpackhi_ps(z, x);
+  _mm_storeu_ps(output,
+                _mm_shuffle_ps(xy_low, zx_low, _MM_SHUFFLE(3, 0, 1, 0)));
+  _mm_storeu_ps(output + 4,
+                _mm_shuffle_ps(yz_low, xy_high, _MM_SHUFFLE(1, 0, 3, 2)));
+  _mm_storeu_ps(output + 8,
+                _mm_shuffle_ps(zx_high, yz_high, _MM_SHUFFLE(3, 2, 3, 0)));
+}
+#endif  // XE_ARCH_AMD64
+
+}  // namespace
+
+void PlanarFloatBEToInterleavedFloat(float* output, const float* input,
+                                     uint32_t channel_count,
+                                     uint32_t channel_samples) {
+  uint32_t i = 0;
+#if XE_ARCH_AMD64
+  if (channel_count == 1) {
+    for (; i + 4 <= channel_samples; i += 4) {
+      _mm_storeu_ps(&output[i], LoadFloatBE(&input[i]));
+    }
+  } else if (channel_count == 2) {
+    const float* left = input;
+    const float* right = input + channel_samples;
+    for (; i + 4 <= channel_samples; i += 4) {
+      __m128 l = LoadFloatBE(&left[i]);
+      __m128 r = LoadFloatBE(&right[i]);
+      _mm_storeu_ps(&output[i * 2], _mm_unpacklo_ps(l, r));
+      _mm_storeu_ps(&output[i * 2 + 4], _mm_unpackhi_ps(l, r));
+    }
+  } else if (channel_count == 6) {
+    for (; i + 4 <= channel_samples; i += 4) {
+      __m128 c[6];
+      for (uint32_t j = 0; j < 6; ++j) {
+        c[j] = LoadFloatBE(&input[j * channel_samples + i]);
+      }
+      // Pairs of channels make three 64-bit values per sample.
+      __m128 c01_low = _mm_unpacklo_ps(c[0], c[1]);
+      __m128 c01_high = _mm_unpackhi_ps(c[0], c[1]);
+      __m128 c23_low = _mm_unpacklo_ps(c[2], c[3]);
+      __m128 c23_high = _mm_unpackhi_ps(c[2], c[3]);
+      __m128 c45_low = _mm_unpacklo_ps(c[4], c[5]);
+      __m128 c45_high = _mm_unpackhi_ps(c[4], c[5]);
+      float* o = &output[i * 6];
+      _mm_storeu_ps(o, _mm_movelh_ps(c01_low, c23_low));
+      _mm_storeu_ps(o + 4, _mm_shuffle_ps(c45_low, c01_low,
+                                          _MM_SHUFFLE(3, 2, 1, 0)));
+      _mm_storeu_ps(o + 8, _mm_movehl_ps(c45_low, c23_low));
+      _mm_storeu_ps(o + 12, _mm_movelh_ps(c01_high, c23_high));
+      _mm_storeu_ps(o + 16, _mm_shuffle_ps(c45_high, c01_high,
+                                           _MM_SHUFFLE(3, 2, 1, 0)));
+      _mm_storeu_ps(o + 20, _mm_movehl_ps(c45_high, c23_high));
+    }
+  }
+#endif  // XE_ARCH_AMD64
+  PlanarFloatBEToInterleavedFloatGeneric(output, input, channel_count,
+                                         channel_samples, i);
+}
+
+void PlanarFloatToInterleavedS16BE(uint8_t* output, const float* const* input,
+                                   uint32_t channel_count,
+                                   uint32_t channel_samples) {
+  uint32_t i = 0;
+#if XE_ARCH_AMD64
+  auto output_vector = reinterpret_cast<__m128i*>(output);
+  if (channel_count == 1) {
+    for (; i + 8 <= channel_samples; i += 8) {
+      _mm_storeu_si128(output_vector++, LoadS16BE(&input[0][i]));
+    }
+  } else if (channel_count == 2) {
+    for (; i + 8 <= channel_samples; i += 8) {
+      __m128i l = LoadS16BE(&input[0][i]);
+      __m128i r = LoadS16BE(&input[1][i]);
+      _mm_storeu_si128(output_vector++, _mm_unpacklo_epi16(l, r));
+      _mm_storeu_si128(output_vector++, _mm_unpackhi_epi16(l, r));
+    }
+  } else if (channel_count == 6) {
+    for (; i + 8 <= channel_samples; i += 8) {
+      __m128i c[6];
+      for (uint32_t j = 0; j < 6; ++j) {
+        c[j] = LoadS16BE(&input[j][i]);
+      }
+      // Pairs of channels make three 32-bit values per sample.
+      auto o = reinterpret_cast<float*>(output_vector);
+      StoreInterleaved3(o, _mm_castsi128_ps(_mm_unpacklo_epi16(c[0], c[1])),
+                        _mm_castsi128_ps(_mm_unpacklo_epi16(c[2], c[3])),
+                        _mm_castsi128_ps(_mm_unpacklo_epi16(c[4], c[5])));
+      StoreInterleaved3(o + 12,
+                        _mm_castsi128_ps(_mm_unpackhi_epi16(c[0], c[1])),
+                        _mm_castsi128_ps(_mm_unpackhi_epi16(c[2], c[3])),
+                        _mm_castsi128_ps(_mm_unpackhi_epi16(c[4], c[5])));
+      output_vector += 6;
+    }
+  }
+#endif  // XE_ARCH_AMD64
+  PlanarFloatToInterleavedS16BEGeneric(output, input, channel_count,
+                                       channel_samples, i);
+}
+
+}  // namespace conversion
+}  // namespace apu
+}  // namespace xe
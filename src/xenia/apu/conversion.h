@@ -0,0 +1,39 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_APU_CONVERSION_H_
+#define XENIA_APU_CONVERSION_H_
+
+#include <cstdint>
+
+namespace xe {
+namespace apu {
+namespace conversion {
+
+// Converts samples stored one channel after another as big endian floats, as
+// the guest submits frames, to host endian floats with the channels of each
+// sample next to each other.
+// 1, 2 and 6 channels are vectorized.
+void PlanarFloatBEToInterleavedFloat(float* output, const float* input,
+                                     uint32_t channel_count,
+                                     uint32_t channel_samples);
+
+// Converts a host float array for each channel, such as libav decodes to, to
+// interleaved big endian 16 bit samples, as XMA output buffers hold. Samples
+// are clamped to [-1, 1] and scaled by 32767, rounding towards zero.
+// 1, 2 and 6 channels are vectorized.
+void PlanarFloatToInterleavedS16BE(uint8_t* output, const float* const* input,
+                                   uint32_t channel_count,
+                                   uint32_t channel_samples);
+
+}  // namespace conversion
+}  // namespace apu
+}  // namespace xe
+
+#endif  // XENIA_APU_CONVERSION_H_
@@ -12,6 +12,7 @@
 #include <array>
 
 #include "xenia/apu/apu_flags.h"
+#include "xenia/apu/conversion.h"
 #include "xenia/base/logging.h"
 #if XE_PLATFORM_WIN32
 #include "xenia/base/platform_win.h"
@@ -25,10 +26,7 @@ SDLAudioDriver::SDLAudioDriver(Memory* memory,
                                xe::threading::Semaphore* semaphore)
     : AudioDriver(memory), semaphore_(semaphore) {}
 
-SDLAudioDriver::~SDLAudioDriver() {
-  assert_true(frames_queued_.empty());
-  assert_true(frames_unused_.empty());
-};
+SDLAudioDriver::~SDLAudioDriver() = default;
 
 bool SDLAudioDriver::Initialize() {
   // With msvc delayed loading, exceptions are used to determine dll presence.
@@ -55,25 +53,20 @@ bool SDLAudioDriver::Initialize() {
   }
   sdl_initialized_ = true;
 
+  InitializeFrameQueue(frame_samples_);
+
   SDL_AudioCallback audio_callback = [](void* userdata, Uint8* stream,
                                         int len) -> void {
     assert_true(len == frame_size_);
     const auto driver = static_cast<SDLAudioDriver*>(userdata);
 
-    std::unique_lock<std::mutex> guard(driver->frames_mutex_);
-    if (driver->frames_queued_.empty()) {
+    // Runs on SDL's real-time audio thread, so this mustn't block.
+    uint32_t read_count = driver->ReadFrame(reinterpret_cast<float*>(stream));
+    if (cvars::mute) {
       memset(stream, 0, len);
-    } else {
-      auto buffer = driver->frames_queued_.front();
-      driver->frames_queued_.pop();
-      if (cvars::mute) {
-        memset(stream, 0, len);
-      } else {
-        memcpy(stream, buffer, len);
-      }
-      driver->frames_unused_.push(buffer);
-
-      auto ret = driver->semaphore_->Release(1, nullptr);
+    }
+    if (read_count) {
+      auto ret = driver->semaphore_->Release(read_count, nullptr);
       assert_true(ret);
     }
   };
@@ -97,29 +90,17 @@ bool SDLAudioDriver::Initialize() {
 
 void SDLAudioDriver::SubmitFrame(uint32_t frame_ptr) {
   const auto input_frame = memory_->TranslateVirtual<float*>(frame_ptr);
-  float* output_frame;
-  {
-    std::unique_lock<std::mutex> guard(frames_mutex_);
-    if (frames_unused_.empty()) {
-      output_frame = new float[frame_samples_];
-    } else {
-      output_frame = frames_unused_.top();
-      frames_unused_.pop();
-    }
-  }
-
-  // interleave the data
-  for (size_t index = 0, o = 0; index < channel_samples_; ++index) {
-    for (size_t channel = 0, table = 0; channel < frame_channels_;
-         ++channel, table += channel_samples_) {
-      output_frame[o++] = xe::byte_swap(input_frame[table + index]);
-    }
+  float* output_frame = AcquireFrame();
+  if (!output_frame) {
+    // Dropped, so give back the slot the callback would have released.
+    auto ret = semaphore_->Release(1, nullptr);
+    assert_true(ret);
+    return;
   }
 
-  {
-    std::unique_lock<std::mutex> guard(frames_mutex_);
-    frames_queued_.push(output_frame);
-  }
+  conversion::PlanarFloatBEToInterleavedFloat(
+      output_frame, input_frame, frame_channels_, channel_samples_);
+  CommitFrame();
 }
 
 void SDLAudioDriver::Shutdown() {
@@ -131,15 +112,11 @@ void SDLAudioDriver::Shutdown() {
     SDL_QuitSubSystem(SDL_INIT_AUDIO);
     sdl_initialized_ = false;
   }
-  std::unique_lock<std::mutex> guard(frames_mutex_);
-  while (!frames_unused_.empty()) {
-    delete[] frames_unused_.top();
-    frames_unused_.pop();
-  };
-  while (!frames_queued_.empty()) {
-    delete[] frames_queued_.front();
-    frames_queued_.pop();
-  };
+  if (underrun_count() || overrun_count()) {
+    XELOGAPU("SDLAudioDriver: %llu underruns, %llu frames dropped",
+             static_cast<unsigned long long>(underrun_count()),
+             static_cast<unsigned long long>(overrun_count()));
+  }
 }
 
 }  // namespace sdl
@@ -11,10 +11,6 @@
 #define XENIA_APU_SDL_SDL_AUDIO_DRIVER_H_
 #include <SDL2/SDL.h>
 
-#include <mutex>
-#include <queue>
-#include <stack>
-
 #include "xenia/apu/audio_driver.h"
 #include "xenia/base/threading.h"
 
@@ -42,9 +38,6 @@ class SDLAudioDriver : public AudioDriver {
   static const uint32_t channel_samples_ = 256;
   static const uint32_t frame_samples_ = frame_channels_ * channel_samples_;
   static const uint32_t frame_size_ = sizeof(float) * frame_samples_;
-  std::queue<float*> frames_queued_ = {};
-  std::stack<float*> frames_unused_ = {};
-  std::mutex frames_mutex_ = {};
 };
 
 }  // namespace sdl
@@ -0,0 +1,172 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/apu/audio_driver.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "xenia/apu/apu_flags.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace apu {
+namespace test {
+
+// Exposes the frame queue without a host audio API behind it.
+class TestAudioDriver : public AudioDriver {
+ public:
+  static const uint32_t kFrameSamples = 4;
+
+  TestAudioDriver() : AudioDriver(nullptr) {
+    InitializeFrameQueue(kFrameSamples);
+  }
+
+  void SubmitFrame(uint32_t samples_ptr) override {}
+
+  bool Push(float value) {
+    float* frame = AcquireFrame();
+    if (!frame) {
+      return false;
+    }
+    for (uint32_t i = 0; i < kFrameSamples; ++i) {
+      frame[i] = value;
+    }
+    CommitFrame();
+    return true;
+  }
+
+  // Returns the value the frame was filled with, or 0 for silence.
+  float Pop(uint32_t* read_count = nullptr) {
+    float frame[kFrameSamples];
+    uint32_t count = ReadFrame(frame);
+    if (read_count) {
+      *read_count = count;
+    }
+    for (uint32_t i = 1; i < kFrameSamples; ++i) {
+      REQUIRE(frame[i] == frame[0]);
+    }
+    return frame[0];
+  }
+};
+
+// Restores the latency targets the tests change.
+class ScopedQueuedFrames {
+ public:
+  ScopedQueuedFrames(int32_t min_frames, int32_t max_frames)
+      : min_frames_(cvars::apu_min_queued_frames),
+        max_frames_(cvars::apu_max_queued_frames) {
+    cvars::apu_min_queued_frames = min_frames;
+    cvars::apu_max_queued_frames = max_frames;
+  }
+  ~ScopedQueuedFrames() {
+    cvars::apu_min_queued_frames = min_frames_;
+    cvars::apu_max_queued_frames = max_frames_;
+  }
+
+ private:
+  int32_t min_frames_;
+  int32_t max_frames_;
+};
+
+TEST_CASE("audio_frame_queue_order", "AudioDriver") {
+  ScopedQueuedFrames queued_frames(1, 0);
+  TestAudioDriver driver;
+  REQUIRE(driver.Pop() == 0.0f);
+  // Silence before the first frame isn't an underrun.
+  REQUIRE(driver.underrun_count() == 0);
+
+  for (uint32_t i = 0; i < AudioDriver::kFrameQueueCapacity; ++i) {
+    REQUIRE(driver.Push(float(i + 1)));
+  }
+  REQUIRE(!driver.Push(-1.0f));
+  REQUIRE(driver.overrun_count() == 1);
+
+  for (uint32_t i = 0; i < AudioDriver::kFrameQueueCapacity; ++i) {
+    uint32_t read_count = 0;
+    REQUIRE(driver.Pop(&read_count) == float(i + 1));
+    REQUIRE(read_count == 1);
+  }
+  uint32_t read_count = 1;
+  REQUIRE(driver.Pop(&read_count) == 0.0f);
+  REQUIRE(read_count == 0);
+  REQUIRE(driver.underrun_count() == 1);
+  // Still dry, but the same underrun.
+  REQUIRE(driver.Pop() == 0.0f);
+  REQUIRE(driver.underrun_count() == 1);
+}
+
+TEST_CASE("audio_frame_queue_min_queued", "AudioDriver") {
+  ScopedQueuedFrames queued_frames(3, 0);
+  TestAudioDriver driver;
+  driver.Push(1.0f);
+  driver.Push(2.0f);
+  REQUIRE(driver.Pop() == 0.0f);
+  driver.Push(3.0f);
+  REQUIRE(driver.Pop() == 1.0f);
+  // Once playing, it drains what's left before refilling.
+  REQUIRE(driver.Pop() == 2.0f);
+  REQUIRE(driver.Pop() == 3.0f);
+  // A frame arriving before the queue is found dry keeps playing.
+  driver.Push(4.0f);
+  REQUIRE(driver.Pop() == 4.0f);
+  REQUIRE(driver.Pop() == 0.0f);
+  REQUIRE(driver.underrun_count() == 1);
+  driver.Push(5.0f);
+  REQUIRE(driver.Pop() == 0.0f);
+  REQUIRE(driver.underrun_count() == 1);
+}
+
+TEST_CASE("audio_frame_queue_max_queued", "AudioDriver") {
+  ScopedQueuedFrames queued_frames(1, 2);
+  TestAudioDriver driver;
+  for (uint32_t i = 0; i < 5; ++i) {
+    driver.Push(float(i + 1));
+  }
+  uint32_t read_count = 0;
+  REQUIRE(driver.Pop(&read_count) == 4.0f);
+  REQUIRE(read_count == 4);
+  REQUIRE(driver.overrun_count() == 3);
+  REQUIRE(driver.Pop() == 5.0f);
+}
+
+TEST_CASE("audio_frame_queue_threads", "AudioDriver") {
+  ScopedQueuedFrames queued_frames(1, 0);
+  TestAudioDriver driver;
+  const uint32_t frame_count = 20000;
+  // Frames go in order and are never torn, however the threads interleave.
+  std::thread producer([&]() {
+    for (uint32_t i = 1; i <= frame_count;) {
+      if (driver.Push(float(i))) {
+        ++i;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+  float last_value = 0.0f;
+  bool in_order = true;
+  while (last_value < float(frame_count)) {
+    float value = driver.Pop();
+    if (value != 0.0f) {
+      in_order = in_order && value == last_value + 1.0f;
+      last_value = value;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  REQUIRE(in_order);
+}
+
+}  // namespace test
+}  // namespace apu
+}  // namespace xe
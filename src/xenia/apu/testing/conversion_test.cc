@@ -0,0 +1,180 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/apu/conversion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "xenia/base/byte_order.h"
+#include "xenia/base/math.h"
+#include "xenia/base/memory.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace apu {
+namespace test {
+
+using conversion::PlanarFloatBEToInterleavedFloat;
+using conversion::PlanarFloatToInterleavedS16BE;
+
+// The loops the conversions replaced.
+void ReferenceFloatBEToFloat(float* output, const float* input,
+                             uint32_t channel_count, uint32_t channel_samples) {
+  for (uint32_t index = 0, o = 0; index < channel_samples; ++index) {
+    for (uint32_t channel = 0, table = 0; channel < channel_count;
+         ++channel, table += channel_samples) {
+      output[o++] = xe::byte_swap(input[table + index]);
+    }
+  }
+}
+
+void ReferenceFloatToS16BE(uint8_t* output, const float* const* input,
+                           uint32_t channel_count, uint32_t channel_samples) {
+  uint32_t o = 0;
+  for (uint32_t i = 0; i < channel_samples; i++) {
+    for (uint32_t j = 0; j < channel_count; j++) {
+      float raw_sample = xe::saturate(input[j][i]);
+      float scaled_sample = raw_sample * ((1 << 15) - 1);
+      int sample = static_cast<int>(scaled_sample);
+      xe::store_and_swap<uint16_t>(&output[o++ * 2], sample & 0xFFFF);
+    }
+  }
+}
+
+std::vector<float> MakeSamples(std::mt19937& random, size_t count) {
+  std::uniform_real_distribution<float> distribution(-1.25f, 1.25f);
+  std::vector<float> samples(count);
+  for (auto& sample : samples) {
+    sample = distribution(random);
+  }
+  // Out of range and odd values must come out the same too.
+  const float special[] = {0.0f,
+                           -0.0f,
+                           1.0f,
+                           -1.0f,
+                           0.99999f,
+                           -0.99999f,
+                           std::numeric_limits<float>::infinity(),
+                           -std::numeric_limits<float>::infinity(),
+                           std::numeric_limits<float>::quiet_NaN(),
+                           std::numeric_limits<float>::denorm_min()};
+  for (size_t i = 0; i < xe::countof(special) && i * 7 < count; ++i) {
+    samples[i * 7] = special[i];
+  }
+  return samples;
+}
+
+TEST_CASE("conversion_float_be_to_interleaved", "Audio Conversion") {
+  std::mt19937 random(1234);
+  for (uint32_t channel_count : {1u, 2u, 3u, 6u}) {
+    for (uint32_t channel_samples : {1u, 3u, 4u, 13u, 256u}) {
+      auto input = MakeSamples(random, channel_count * channel_samples);
+      std::vector<float> output(input.size());
+      std::vector<float> expected(input.size());
+      PlanarFloatBEToInterleavedFloat(output.data(), input.data(),
+                                      channel_count, channel_samples);
+      ReferenceFloatBEToFloat(expected.data(), input.data(), channel_count,
+                              channel_samples);
+      REQUIRE(std::memcmp(output.data(), expected.data(),
+                          output.size() * sizeof(float)) == 0);
+    }
+  }
+}
+
+TEST_CASE("conversion_float_to_s16_be", "Audio Conversion") {
+  std::mt19937 random(1234);
+  for (uint32_t channel_count : {1u, 2u, 3u, 6u}) {
+    for (uint32_t channel_samples : {1u, 7u, 8u, 21u, 512u}) {
+      std::vector<std::vector<float>> channels;
+      std::vector<const float*> input;
+      for (uint32_t i = 0; i < channel_count; ++i) {
+        channels.push_back(MakeSamples(random, channel_samples));
+      }
+      for (auto& channel : channels) {
+        input.push_back(channel.data());
+      }
+      size_t output_size = channel_count * channel_samples * 2;
+      std::vector<uint8_t> output(output_size);
+      std::vector<uint8_t> expected(output_size);
+      PlanarFloatToInterleavedS16BE(output.data(), input.data(), channel_count,
+                                    channel_samples);
+      ReferenceFloatToS16BE(expected.data(), input.data(), channel_count,
+                            channel_samples);
+      REQUIRE(output == expected);
+    }
+  }
+}
+
+// Compares with the scalar loops on frames the size of those XMA decodes and
+// the audio drivers submit.
+TEST_CASE("conversion_benchmark", "[.benchmark]") {
+  const int iteration_count = 100000;
+  std::mt19937 random(1234);
+
+  auto time = [&](const char* name, uint32_t channel_count,
+                  uint32_t channel_samples, std::function<void()> function) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iteration_count; ++i) {
+      function();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    std::printf("%s, %u channels: %.1fns per frame (%.2fns per sample)\n", name,
+                channel_count, elapsed.count() * 1000.0 / iteration_count,
+                elapsed.count() * 1000.0 / iteration_count /
+                    (channel_count * channel_samples));
+  };
+
+  for (uint32_t channel_count : {1u, 2u, 6u}) {
+    const uint32_t channel_samples = 512;
+    std::vector<std::vector<float>> channels;
+    std::vector<const float*> input;
+    for (uint32_t i = 0; i < channel_count; ++i) {
+      channels.push_back(MakeSamples(random, channel_samples));
+    }
+    for (auto& channel : channels) {
+      input.push_back(channel.data());
+    }
+    std::vector<uint8_t> output(channel_count * channel_samples * 2);
+    time("XMA float to s16", channel_count, channel_samples, [&]() {
+      PlanarFloatToInterleavedS16BE(output.data(), input.data(),
+                                    channel_count, channel_samples);
+    });
+    time("XMA float to s16 (scalar)", channel_count, channel_samples, [&]() {
+      ReferenceFloatToS16BE(output.data(), input.data(), channel_count,
+                            channel_samples);
+    });
+  }
+
+  for (uint32_t channel_count : {1u, 2u, 6u}) {
+    const uint32_t channel_samples = 256;
+    auto input = MakeSamples(random, channel_count * channel_samples);
+    std::vector<float> output(input.size());
+    time("Driver frame", channel_count, channel_samples, [&]() {
+      PlanarFloatBEToInterleavedFloat(output.data(), input.data(),
+                                      channel_count, channel_samples);
+    });
+    time("Driver frame (scalar)", channel_count, channel_samples, [&]() {
+      ReferenceFloatBEToFloat(output.data(), input.data(), channel_count,
+                              channel_samples);
+    });
+  }
+}
+
+}  // namespace test
+}  // namespace apu
+}  // namespace xe
@@ -13,6 +13,7 @@
 #include "xenia/base/platform_win.h"
 
 #include "xenia/apu/apu_flags.h"
+#include "xenia/apu/conversion.h"
 #include "xenia/base/clock.h"
 #include "xenia/base/logging.h"
 
@@ -205,15 +206,9 @@ void XAudio2AudioDriver::SubmitFrame(uint32_t frame_ptr) {
 
   auto input_frame = memory_->TranslateVirtual<float*>(frame_ptr);
   auto output_frame = reinterpret_cast<float*>(frames_[current_frame_]);
-  auto interleave_channels = frame_channels_;
 
-  // interleave the data
-  for (uint32_t index = 0, o = 0; index < channel_samples_; ++index) {
-    for (uint32_t channel = 0, table = 0; channel < interleave_channels;
-         ++channel, table += channel_samples_) {
-      output_frame[o++] = xe::byte_swap(input_frame[table + index]);
-    }
-  }
+  conversion::PlanarFloatBEToInterleavedFloat(
+      output_frame, input_frame, frame_channels_, channel_samples_);
 
   api::XAUDIO2_BUFFER buffer;
   buffer.Flags = 0;
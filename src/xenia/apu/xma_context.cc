@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <cstring>
 
+#include "xenia/apu/conversion.h"
 #include "xenia/apu/xma_decoder.h"
 #include "xenia/apu/xma_helpers.h"
 #include "xenia/base/bit_stream.h"
@@ -33,11 +34,16 @@ extern AVCodec ff_xma2_decoder;
 namespace xe {
 namespace apu {
 
+// libav doesn't guard codec open and close against other threads without a
+// lock manager, and contexts are decoded on several threads at once.
+static std::mutex libav_open_mutex_;
+
 XmaContext::XmaContext() = default;
 
 XmaContext::~XmaContext() {
   if (context_) {
     if (avcodec_is_open(context_)) {
+      std::lock_guard<std::mutex> libav_lock(libav_open_mutex_);
       avcodec_close(context_);
     }
     av_free(context_);
@@ -629,6 +635,7 @@ int XmaContext::PrepareDecoder(uint8_t* block, size_t size, int sample_rate,
   if (context_->sample_rate != sample_rate || context_->channels != channels) {
     // We have to reopen the codec so it'll realloc whatever data it needs.
     // TODO(DrChat): Find a better way.
+    std::lock_guard<std::mutex> libav_lock(libav_open_mutex_);
     avcodec_close(context_);
 
     context_->sample_rate = sample_rate;
@@ -649,27 +656,11 @@ int XmaContext::PrepareDecoder(uint8_t* block, size_t size, int sample_rate,
 
 bool XmaContext::ConvertFrame(const uint8_t** samples, int num_channels,
                               int num_samples, uint8_t* output_buffer) {
-  // Loop through every sample, convert and drop it into the output array.
-  // If more than one channel, we need to interleave the samples from each
-  // channel next to each other.
-  // TODO: This can definitely be optimized with AVX/SSE intrinsics!
-  uint32_t o = 0;
-  for (int i = 0; i < num_samples; i++) {
-    for (int j = 0; j < num_channels; j++) {
-      // Select the appropriate array based on the current channel.
-      auto sample_array = reinterpret_cast<const float*>(samples[j]);
-
-      // Raw sample should be within [-1, 1].
-      // Clamp it, just in case.
-      float raw_sample = xe::saturate(sample_array[i]);
-
-      // Convert the sample and output it in big endian.
-      float scaled_sample = raw_sample * ((1 << 15) - 1);
-      int sample = static_cast<int>(scaled_sample);
-      xe::store_and_swap<uint16_t>(&output_buffer[o++ * 2], sample & 0xFFFF);
-    }
-  }
-
+  // Convert every sample to big endian 16 bit and, if more than one channel,
+  // interleave the samples from each channel next to each other.
+  conversion::PlanarFloatToInterleavedS16BE(
+      output_buffer, reinterpret_cast<const float* const*>(samples),
+      uint32_t(num_channels), uint32_t(num_samples));
   return true;
 }
 
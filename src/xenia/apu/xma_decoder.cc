@@ -9,12 +9,17 @@
 
 #include "xenia/apu/xma_decoder.h"
 
+#include <algorithm>
+
+#include "xenia/apu/apu_flags.h"
 #include "xenia/apu/xma_context.h"
+#include "xenia/base/clock.h"
 #include "xenia/base/cvar.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/math.h"
 #include "xenia/base/profiling.h"
 #include "xenia/base/ring_buffer.h"
+#include "xenia/base/string.h"
 #include "xenia/base/string_buffer.h"
 #include "xenia/cpu/processor.h"
 #include "xenia/cpu/thread_state.h"
@@ -126,71 +131,120 @@ X_STATUS XmaDecoder::Setup(kernel::KernelState* kernel_state) {
   register_file_[XE_XMA_REG_NEXT_CONTEXT_INDEX].u32 = 1;
   context_bitmap_.Resize(kContextCount);
 
+  // Most titles only keep a few voices decoding at once, so a handful of
+  // workers is plenty.
+  uint32_t logical_processor_count = xe::threading::logical_processor_count();
+  uint32_t thread_count;
+  if (cvars::apu_decoder_threads < 0) {
+    thread_count = std::max(std::min(logical_processor_count / 4, uint32_t(4)),
+                            uint32_t(1));
+  } else {
+    thread_count = std::max(std::min(uint32_t(cvars::apu_decoder_threads),
+                                     logical_processor_count),
+                            uint32_t(1));
+  }
+
   worker_running_ = true;
-  work_event_ = xe::threading::Event::CreateAutoResetEvent(false);
-  worker_thread_ = kernel::object_ref<kernel::XHostThread>(
-      new kernel::XHostThread(kernel_state, 128 * 1024, 0, [this]() {
-        WorkerThreadMain();
-        return 0;
-      }));
-  worker_thread_->set_name("XMA Decoder Worker");
-  worker_thread_->set_can_debugger_suspend(true);
-  worker_thread_->Create();
+  for (uint32_t i = 0; i < thread_count; ++i) {
+    auto worker_thread = kernel::object_ref<kernel::XHostThread>(
+        new kernel::XHostThread(kernel_state, 128 * 1024, 0, [this]() {
+          WorkerThreadMain();
+          return 0;
+        }));
+    worker_thread->set_name(xe::format_string("XMA Decoder Worker %u", i));
+    worker_thread->set_can_debugger_suspend(true);
+    worker_thread->Create();
+    worker_threads_.push_back(std::move(worker_thread));
+  }
 
   return X_STATUS_SUCCESS;
 }
 
-void XmaDecoder::WorkerThreadMain() {
-  uint32_t idle_loop_count = 0;
-  while (worker_running_) {
-    // Okay, let's loop through XMA contexts to find ones we need to decode!
-    bool did_work = false;
-    for (uint32_t n = 0; n < kContextCount; n++) {
-      XmaContext& context = contexts_[n];
-      did_work = context.Work() || did_work;
-
-      // TODO: Need thread safety to do this.
-      // Probably not too important though.
-      // registers_.current_context = n;
-      // registers_.next_context = (n + 1) % kContextCount;
+void XmaDecoder::QueueContext(uint32_t context_id) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (context_queued_[context_id]) {
+      // Already waiting; its latency counts from the first kick.
+      return;
     }
+    context_queued_[context_id] = true;
+    context_kick_ticks_[context_id] = Clock::host_tick_count_platform();
+    ready_contexts_.push_back(context_id);
+  }
+  queue_cond_.notify_one();
+}
 
-    if (paused_) {
-      pause_fence_.Signal();
-      resume_fence_.Wait();
+void XmaDecoder::WorkerThreadMain() {
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  while (true) {
+    queue_cond_.wait(lock, [this]() {
+      return !worker_running_ || (!paused_ && !ready_contexts_.empty());
+    });
+    if (!worker_running_) {
+      break;
     }
 
-    if (!did_work) {
-      idle_loop_count++;
-    } else {
-      idle_loop_count = 0;
+    uint32_t context_id = ready_contexts_.front();
+    ready_contexts_.pop_front();
+    // Kicks from here on queue it again, so they aren't lost if they land
+    // while it's decoding.
+    context_queued_[context_id] = false;
+    uint64_t kick_ticks = context_kick_ticks_[context_id];
+    ++busy_worker_count_;
+    lock.unlock();
+
+    // The context lock keeps other workers off the same context.
+    bool did_work = contexts_[context_id].Work();
+    uint64_t end_ticks = Clock::host_tick_count_platform();
+
+    lock.lock();
+    --busy_worker_count_;
+    if (did_work) {
+      auto& stats = context_stats_[context_id];
+      uint64_t latency_ticks = end_ticks - kick_ticks;
+      ++stats.decode_count;
+      stats.total_latency_ticks += latency_ticks;
+      stats.max_latency_ticks =
+          std::max(stats.max_latency_ticks, latency_ticks);
     }
-
-    if (idle_loop_count > 500) {
-      // Idle for an extended period. Introduce a 20ms wait.
-      xe::threading::Wait(work_event_.get(), false,
-                          std::chrono::milliseconds(20));
+    if (!busy_worker_count_) {
+      idle_cond_.notify_all();
     }
-
-    xe::threading::MaybeYield();
   }
 }
 
-void XmaDecoder::Shutdown() {
-  worker_running_ = false;
+XmaDecodeStats XmaDecoder::GetDecodeStats(uint32_t context_id) {
+  assert_true(context_id < kContextCount);
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  return context_stats_[context_id];
+}
 
-  if (work_event_) {
-    work_event_->Set();
+void XmaDecoder::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    worker_running_ = false;
   }
+  queue_cond_.notify_all();
 
-  if (paused_) {
-    Resume();
+  for (auto& worker_thread : worker_threads_) {
+    // Wait for work thread.
+    xe::threading::Wait(worker_thread->thread(), false);
   }
+  worker_threads_.clear();
 
-  if (worker_thread_) {
-    // Wait for work thread.
-    xe::threading::Wait(worker_thread_->thread(), false);
-    worker_thread_.reset();
+  double tick_frequency = double(Clock::host_tick_frequency_platform());
+  for (uint32_t i = 0; i < kContextCount; ++i) {
+    const auto& stats = context_stats_[i];
+    if (!stats.decode_count) {
+      continue;
+    }
+    XELOGAPU(
+        "XmaDecoder: context %u decoded %llu times, latency %.3fms average, "
+        "%.3fms max",
+        i, static_cast<unsigned long long>(stats.decode_count),
+        stats.total_latency_ticks * 1000.0 / tick_frequency /
+            stats.decode_count,
+        stats.max_latency_ticks * 1000.0 / tick_frequency);
   }
 
   if (context_data_first_ptr_) {
@@ -311,11 +365,9 @@ void XmaDecoder::WriteRegister(uint32_t addr, uint32_t value) {
         uint32_t context_id = base_context_id + i;
         XmaContext& context = contexts_[context_id];
         context.Enable();
+        QueueContext(context_id);
       }
     }
-
-    // Signal the decoder thread to start processing.
-    work_event_->Set();
   } else if (r >= XE_XMA_REG_CONTEXT_LOCK_0 && r <= XE_XMA_REG_CONTEXT_LOCK_9) {
     // Context lock command.
     // This requests a lock by flagging the context.
@@ -328,9 +380,6 @@ void XmaDecoder::WriteRegister(uint32_t addr, uint32_t value) {
         context.Disable();
       }
     }
-
-    // Signal the decoder thread to start processing.
-    work_event_->Set();
   } else if (r >= XE_XMA_REG_CONTEXT_CLEAR_0 &&
              r <= XE_XMA_REG_CONTEXT_CLEAR_9) {
     // Context clear command.
@@ -350,18 +399,22 @@ void XmaDecoder::Pause() {
   if (paused_) {
     return;
   }
-  paused_ = true;
 
-  pause_fence_.Wait();
+  // Workers finish the context they're on and then leave the queue alone.
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  paused_ = true;
+  idle_cond_.wait(lock, [this]() { return !busy_worker_count_; });
 }
 
 void XmaDecoder::Resume() {
   if (!paused_) {
     return;
   }
-  paused_ = false;
-
-  resume_fence_.Signal();
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    paused_ = false;
+  }
+  queue_cond_.notify_all();
 }
 
 }  // namespace apu
@@ -11,8 +11,10 @@
 #define XENIA_APU_XMA_DECODER_H_
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
-#include <queue>
+#include <vector>
 
 #include "xenia/apu/xma_context.h"
 #include "xenia/apu/xma_register_file.h"
@@ -25,6 +27,13 @@ namespace apu {
 
 struct XMA_CONTEXT_DATA;
 
+// Time from a context being kicked to its packets being decoded, in host ticks.
+struct XmaDecodeStats {
+  uint64_t decode_count = 0;
+  uint64_t total_latency_ticks = 0;
+  uint64_t max_latency_ticks = 0;
+};
+
 class XmaDecoder {
  public:
   explicit XmaDecoder(cpu::Processor* processor);
@@ -51,10 +60,13 @@ class XmaDecoder {
   void Pause();
   void Resume();
 
+  XmaDecodeStats GetDecodeStats(uint32_t context_id);
+
  protected:
   int GetContextId(uint32_t guest_ptr);
 
  private:
+  void QueueContext(uint32_t context_id);
   void WorkerThreadMain();
 
   static uint32_t MMIOReadRegisterThunk(void* ppc_context, XmaDecoder* as,
@@ -71,12 +83,9 @@ class XmaDecoder {
   cpu::Processor* processor_ = nullptr;
 
   std::atomic<bool> worker_running_ = {false};
-  kernel::object_ref<kernel::XHostThread> worker_thread_;
-  std::unique_ptr<xe::threading::Event> work_event_ = nullptr;
+  std::vector<kernel::object_ref<kernel::XHostThread>> worker_threads_;
 
-  bool paused_ = false;
-  xe::threading::Fence pause_fence_;   // Signaled when worker paused.
-  xe::threading::Fence resume_fence_;  // Signaled when resume requested.
+  std::atomic<bool> paused_ = {false};
 
   XmaRegisterFile register_file_;
 
@@ -84,6 +93,16 @@ class XmaDecoder {
   XmaContext contexts_[kContextCount];
   BitMap context_bitmap_;
 
+  // Kicked contexts waiting for a worker, each in the queue at most once.
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cond_;  // Signaled when work is queued.
+  std::condition_variable idle_cond_;   // Signaled when a worker goes idle.
+  std::deque<uint32_t> ready_contexts_;
+  bool context_queued_[kContextCount] = {};
+  uint64_t context_kick_ticks_[kContextCount] = {};
+  XmaDecodeStats context_stats_[kContextCount];
+  uint32_t busy_worker_count_ = 0;
+
   uint32_t context_data_first_ptr_ = 0;
   uint32_t context_data_last_ptr_ = 0;
 };
@@ -0,0 +1,280 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/free_page_index.h"
+
+#include <algorithm>
+
+#include "xenia/base/assert.h"
+#include "xenia/base/math.h"
+
+namespace xe {
+
+namespace {
+// Unlike xe::round_up, keeps 0 as 0.
+uint32_t RoundUp(uint32_t value, uint32_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+}  // namespace
+
+void FreePageIndex::Reset(uint32_t page_count) {
+  page_count_ = page_count;
+  free_page_count_ = page_count;
+  uint32_t word_count = (page_count + 63) / 64;
+  leaf_count_ = 1;
+  while (leaf_count_ < word_count) {
+    leaf_count_ <<= 1;
+  }
+  // Leaves past the end are padded with used pages.
+  words_.assign(leaf_count_, 0);
+  for (uint32_t i = 0; i < page_count / 64; ++i) {
+    words_[i] = UINT64_MAX;
+  }
+  if (page_count % 64) {
+    words_[page_count / 64] = (uint64_t(1) << (page_count % 64)) - 1;
+  }
+
+  nodes_.resize(leaf_count_ * 2);
+  for (uint32_t i = 0; i < leaf_count_; ++i) {
+    UpdateLeaf(i);
+  }
+  uint32_t child_page_count = 64;
+  for (uint32_t level_begin = leaf_count_ / 2; level_begin;
+       level_begin /= 2, child_page_count *= 2) {
+    for (uint32_t i = level_begin; i < level_begin * 2; ++i) {
+      UpdateParent(i, child_page_count);
+    }
+  }
+}
+
+void FreePageIndex::MarkUsed(uint32_t first_page_number,
+                             uint32_t page_count) {
+  SetRange(first_page_number, page_count, false);
+}
+
+void FreePageIndex::MarkFree(uint32_t first_page_number,
+                             uint32_t page_count) {
+  SetRange(first_page_number, page_count, true);
+}
+
+void FreePageIndex::SetRange(uint32_t first_page_number, uint32_t page_count,
+                             bool free) {
+  if (!page_count) {
+    return;
+  }
+  uint32_t last_page_number = first_page_number + page_count - 1;
+  assert_true(last_page_number < page_count_);
+  uint32_t first_word = first_page_number / 64;
+  uint32_t last_word = last_page_number / 64;
+  for (uint32_t i = first_word; i <= last_word; ++i) {
+    uint32_t first_bit = i == first_word ? first_page_number % 64 : 0;
+    uint32_t last_bit = i == last_word ? last_page_number % 64 : 63;
+    uint64_t mask = (UINT64_MAX >> (63 - last_bit)) & (UINT64_MAX << first_bit);
+    uint64_t old_word = words_[i];
+    uint64_t new_word = free ? old_word | mask : old_word & ~mask;
+    if (new_word == old_word) {
+      continue;
+    }
+    free_page_count_ += xe::bit_count(new_word);
+    free_page_count_ -= xe::bit_count(old_word);
+    words_[i] = new_word;
+    UpdateLeaf(i);
+  }
+
+  uint32_t child_page_count = 64;
+  for (uint32_t first_node = (leaf_count_ + first_word) / 2,
+                last_node = (leaf_count_ + last_word) / 2;
+       first_node; first_node /= 2, last_node /= 2, child_page_count *= 2) {
+    for (uint32_t i = first_node; i <= last_node; ++i) {
+      UpdateParent(i, child_page_count);
+    }
+  }
+}
+
+void FreePageIndex::UpdateLeaf(uint32_t word_index) {
+  uint64_t word = words_[word_index];
+  auto& node = nodes_[leaf_count_ + word_index];
+  node.prefix = xe::tzcnt(~word);
+  node.suffix = xe::lzcnt(~word);
+  // Each step shortens every run of set bits by one.
+  uint32_t longest = 0;
+  for (; word; word &= word >> 1) {
+    ++longest;
+  }
+  node.longest = longest;
+}
+
+void FreePageIndex::UpdateParent(uint32_t node_index,
+                                 uint32_t child_page_count) {
+  const auto& left = nodes_[node_index * 2];
+  const auto& right = nodes_[node_index * 2 + 1];
+  auto& node = nodes_[node_index];
+  node.prefix = left.prefix == child_page_count
+                    ? child_page_count + right.prefix
+                    : left.prefix;
+  node.suffix = right.suffix == child_page_count
+                    ? child_page_count + left.suffix
+                    : right.suffix;
+  node.longest = std::max(std::max(left.longest, right.longest),
+                          left.suffix + right.prefix);
+}
+
+uint32_t FreePageIndex::FindFirstRun(uint32_t node_index, uint32_t node_base,
+                                     uint32_t node_page_count,
+                                     uint32_t from_page_number,
+                                     uint32_t page_count,
+                                     uint32_t* run) const {
+  if (node_base + node_page_count <= from_page_number) {
+    return kNotFound;
+  }
+  if (node_base >= from_page_number) {
+    // The whole subtree is eligible, so the summary can answer or skip it.
+    const auto& node = nodes_[node_index];
+    if (*run + node.prefix >= page_count) {
+      return node_base - *run;
+    }
+    if (node.longest < page_count) {
+      *run = node.prefix == node_page_count ? *run + node_page_count
+                                            : node.suffix;
+      return kNotFound;
+    }
+  }
+  if (node_page_count == 64) {
+    uint64_t word = words_[node_base / 64];
+    uint32_t i = std::max(from_page_number, node_base) - node_base;
+    for (; i < 64; ++i) {
+      if ((word >> i) & 1) {
+        if (++*run >= page_count) {
+          return node_base + i + 1 - *run;
+        }
+      } else {
+        *run = 0;
+      }
+    }
+    return kNotFound;
+  }
+  uint32_t half_page_count = node_page_count / 2;
+  uint32_t result =
+      FindFirstRun(node_index * 2, node_base, half_page_count,
+                   from_page_number, page_count, run);
+  if (result != kNotFound) {
+    return result;
+  }
+  return FindFirstRun(node_index * 2 + 1, node_base + half_page_count,
+                      half_page_count, from_page_number, page_count, run);
+}
+
+uint32_t FreePageIndex::FindLastRun(uint32_t node_index, uint32_t node_base,
+                                    uint32_t node_page_count,
+                                    uint32_t to_page_number,
+                                    uint32_t page_count, uint32_t* run) const {
+  if (node_base > to_page_number) {
+    return kNotFound;
+  }
+  uint32_t node_last = node_base + node_page_count - 1;
+  if (node_last <= to_page_number) {
+    const auto& node = nodes_[node_index];
+    if (*run + node.suffix >= page_count) {
+      return node_last + *run;
+    }
+    if (node.longest < page_count) {
+      *run = node.suffix == node_page_count ? *run + node_page_count
+                                            : node.prefix;
+      return kNotFound;
+    }
+  }
+  if (node_page_count == 64) {
+    uint64_t word = words_[node_base / 64];
+    uint32_t i = std::min(to_page_number, node_last) - node_base + 1;
+    while (i--) {
+      if ((word >> i) & 1) {
+        if (++*run >= page_count) {
+          return node_base + i + *run - 1;
+        }
+      } else {
+        *run = 0;
+      }
+    }
+    return kNotFound;
+  }
+  uint32_t half_page_count = node_page_count / 2;
+  uint32_t result =
+      FindLastRun(node_index * 2 + 1, node_base + half_page_count,
+                  half_page_count, to_page_number, page_count, run);
+  if (result != kNotFound) {
+    return result;
+  }
+  return FindLastRun(node_index * 2, node_base, half_page_count,
+                     to_page_number, page_count, run);
+}
+
+uint32_t FreePageIndex::FindFirst(uint32_t low_page_number,
+                                  uint32_t high_page_number,
+                                  uint32_t page_count,
+                                  uint32_t alignment) const {
+  if (!page_count_) {
+    return kNotFound;
+  }
+  page_count = std::max(page_count, uint32_t(1));
+  alignment = std::max(alignment, uint32_t(1));
+  high_page_number = std::min(high_page_number, page_count_ - 1);
+  uint32_t from_page_number = RoundUp(low_page_number, alignment);
+  while (from_page_number <= high_page_number &&
+         high_page_number - from_page_number + 1 >= page_count) {
+    uint32_t run = 0;
+    uint32_t base = FindFirstRun(1, 0, leaf_count_ * 64, from_page_number,
+                                 page_count, &run);
+    if (base == kNotFound || base + (page_count - 1) > high_page_number) {
+      return kNotFound;
+    }
+    if (base % alignment == 0) {
+      return base;
+    }
+    // Retry from the next aligned page, which may still be in this run.
+    from_page_number = RoundUp(base, alignment);
+  }
+  return kNotFound;
+}
+
+uint32_t FreePageIndex::FindLast(uint32_t low_page_number,
+                                 uint32_t high_page_number,
+                                 uint32_t page_count,
+                                 uint32_t alignment) const {
+  if (!page_count_) {
+    return kNotFound;
+  }
+  page_count = std::max(page_count, uint32_t(1));
+  alignment = std::max(alignment, uint32_t(1));
+  uint32_t to_page_number = std::min(high_page_number, page_count_ - 1);
+  while (to_page_number >= low_page_number &&
+         to_page_number - low_page_number + 1 >= page_count) {
+    uint32_t run = 0;
+    uint32_t last = FindLastRun(1, 0, leaf_count_ * 64, to_page_number,
+                                page_count, &run);
+    if (last == kNotFound) {
+      return kNotFound;
+    }
+    uint32_t base = last - (page_count - 1);
+    if (base < low_page_number) {
+      return kNotFound;
+    }
+    uint32_t aligned_base = base - base % alignment;
+    if (aligned_base == base) {
+      return base;
+    }
+    if (aligned_base < low_page_number) {
+      return kNotFound;
+    }
+    // Retry ending where a run from the previous aligned page would.
+    to_page_number = aligned_base + (page_count - 1);
+  }
+  return kNotFound;
+}
+
+}  // namespace xe
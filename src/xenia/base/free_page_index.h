@@ -0,0 +1,91 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_BASE_FREE_PAGE_INDEX_H_
+#define XENIA_BASE_FREE_PAGE_INDEX_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace xe {
+
+// Tracks which pages of an address range are free and finds runs of free
+// pages without walking the range.
+//
+// Pages are kept in a bitmap, with a segment tree over its 64 page words
+// recording the longest free run in each subtree along with the free runs
+// touching either end. Marking pages is O(k + log n) for k words touched, and
+// finding the first or last run of a given length is O(log n), plus a repeat
+// for each run passed over that can't fit the requested alignment.
+//
+// Not thread safe.
+class FreePageIndex {
+ public:
+  static const uint32_t kNotFound = UINT32_MAX;
+
+  // Resizes to page_count pages, all free.
+  void Reset(uint32_t page_count);
+
+  uint32_t page_count() const { return page_count_; }
+  uint32_t free_page_count() const { return free_page_count_; }
+
+  bool IsFree(uint32_t page_number) const {
+    return (words_[page_number / 64] >> (page_number % 64)) & 1;
+  }
+
+  // Marks the given pages as allocated or free. They may already be.
+  void MarkUsed(uint32_t first_page_number, uint32_t page_count);
+  void MarkFree(uint32_t first_page_number, uint32_t page_count);
+
+  // Finds the lowest (FindFirst) or highest (FindLast) base page number that
+  // is a multiple of alignment and at least low_page_number where page_count
+  // free pages start, with the last of them at most high_page_number.
+  // Returns kNotFound if there are none.
+  uint32_t FindFirst(uint32_t low_page_number, uint32_t high_page_number,
+                     uint32_t page_count, uint32_t alignment) const;
+  uint32_t FindLast(uint32_t low_page_number, uint32_t high_page_number,
+                    uint32_t page_count, uint32_t alignment) const;
+
+ private:
+  struct Node {
+    // Free pages at the start and end of the subtree, and its longest run.
+    uint32_t prefix;
+    uint32_t suffix;
+    uint32_t longest;
+  };
+
+  void SetRange(uint32_t first_page_number, uint32_t page_count, bool free);
+  void UpdateLeaf(uint32_t word_index);
+  void UpdateParent(uint32_t node_index, uint32_t child_page_count);
+
+  // Lowest page number at or after from_page_number starting page_count free
+  // pages. run is the number of free pages right before the subtree, not
+  // before from_page_number, and is updated to those at its end.
+  uint32_t FindFirstRun(uint32_t node_index, uint32_t node_base,
+                        uint32_t node_page_count, uint32_t from_page_number,
+                        uint32_t page_count, uint32_t* run) const;
+  // Highest page number at or before to_page_number ending page_count free
+  // pages, mirroring FindFirstRun.
+  uint32_t FindLastRun(uint32_t node_index, uint32_t node_base,
+                       uint32_t node_page_count, uint32_t to_page_number,
+                       uint32_t page_count, uint32_t* run) const;
+
+  uint32_t page_count_ = 0;
+  uint32_t free_page_count_ = 0;
+  // Set bits are free pages. Bits past page_count_ are never set.
+  std::vector<uint64_t> words_;
+  // 1-based, with the children of node n at 2n and 2n + 1 and the leaf for
+  // word w at leaf_count_ + w.
+  std::vector<Node> nodes_;
+  uint32_t leaf_count_ = 0;
+};
+
+}  // namespace xe
+
+#endif  // XENIA_BASE_FREE_PAGE_INDEX_H_
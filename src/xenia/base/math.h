@@ -17,6 +17,7 @@
 #include <limits>
 #include <numeric>
 #include <type_traits>
+#include <utility>
 #include "xenia/base/platform.h"
 
 #if XE_ARCH_AMD64
@@ -28,6 +28,29 @@ void copy_128_aligned(void* dest, const void* src, size_t count) {
 }
 
 #if XE_ARCH_AMD64
+void copy_streaming(void* dest_ptr, const void* src_ptr, size_t length) {
+  auto dest = reinterpret_cast<uint8_t*>(dest_ptr);
+  auto src = reinterpret_cast<const uint8_t*>(src_ptr);
+  // Streaming stores need an aligned destination.
+  size_t head_length = std::min(
+      length, (16 - (reinterpret_cast<uintptr_t>(dest) & 0xF)) & 0xF);
+  std::memcpy(dest, src, head_length);
+  size_t i = head_length;
+  for (; i + 64 <= length; i += 64) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i]));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i + 16]));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i + 32]));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i + 48]));
+    _mm_stream_si128(reinterpret_cast<__m128i*>(&dest[i]), a);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(&dest[i + 16]), b);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(&dest[i + 32]), c);
+    _mm_stream_si128(reinterpret_cast<__m128i*>(&dest[i + 48]), d);
+  }
+  std::memcpy(&dest[i], &src[i], length - i);
+  // Make the stores visible to other threads before returning.
+  _mm_sfence();
+}
+
 void copy_and_swap_16_aligned(void* dest_ptr, const void* src_ptr,
                               size_t count) {
   assert_zero(reinterpret_cast<uintptr_t>(dest_ptr) & 0xF);
@@ -153,8 +176,8 @@ void copy_and_swap_64_unaligned(void* dest_ptr, const void* src_ptr,
 
 void copy_and_swap_16_in_32_aligned(void* dest_ptr, const void* src_ptr,
                                     size_t count) {
-  auto dest = reinterpret_cast<uint64_t*>(dest_ptr);
-  auto src = reinterpret_cast<const uint64_t*>(src_ptr);
+  auto dest = reinterpret_cast<uint32_t*>(dest_ptr);
+  auto src = reinterpret_cast<const uint32_t*>(src_ptr);
   size_t i;
   for (i = 0; i + 4 <= count; i += 4) {
     __m128i input = _mm_load_si128(reinterpret_cast<const __m128i*>(&src[i]));
@@ -169,8 +192,8 @@ void copy_and_swap_16_in_32_aligned(void* dest_ptr, const void* src_ptr,
 
 void copy_and_swap_16_in_32_unaligned(void* dest_ptr, const void* src_ptr,
                                       size_t count) {
-  auto dest = reinterpret_cast<uint64_t*>(dest_ptr);
-  auto src = reinterpret_cast<const uint64_t*>(src_ptr);
+  auto dest = reinterpret_cast<uint32_t*>(dest_ptr);
+  auto src = reinterpret_cast<const uint32_t*>(src_ptr);
   size_t i;
   for (i = 0; i + 4 <= count; i += 4) {
     __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i]));
@@ -184,6 +207,10 @@ void copy_and_swap_16_in_32_unaligned(void* dest_ptr, const void* src_ptr,
 }
 #else
 // Generic routines.
+void copy_streaming(void* dest, const void* src, size_t length) {
+  std::memcpy(dest, src, length);
+}
+
 void copy_and_swap_16_aligned(void* dest, const void* src, size_t count) {
   return copy_and_swap_16_unaligned(dest, src, count);
 }
@@ -229,8 +256,8 @@ void copy_and_swap_16_in_32_aligned(void* dest, const void* src, size_t count) {
 
 void copy_and_swap_16_in_32_unaligned(void* dest_ptr, const void* src_ptr,
                                       size_t count) {
-  auto dest = reinterpret_cast<uint64_t*>(dest_ptr);
-  auto src = reinterpret_cast<const uint64_t*>(src_ptr);
+  auto dest = reinterpret_cast<uint32_t*>(dest_ptr);
+  auto src = reinterpret_cast<const uint32_t*>(src_ptr);
   for (size_t i = 0; i < count; ++i) {
     dest[i] = (src[i] >> 16) | (src[i] << 16);
   }
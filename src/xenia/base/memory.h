@@ -70,6 +70,10 @@ bool Protect(void* base_address, size_t length, PageAccess access,
 // the region.
 bool QueryProtect(void* base_address, size_t& length, PageAccess& access_out);
 
+// Hints that the given range, usually of a mapped file, will be read soon so
+// the OS can start paging it in. Does nothing if unsupported.
+void Prefetch(const void* base_address, size_t length);
+
 // Allocates a block of memory for a type with the given alignment.
 // The memory must be freed with AlignedFree.
 template <typename T>
@@ -123,6 +127,11 @@ inline void* low_address(void* address) {
 
 void copy_128_aligned(void* dest, const void* src, size_t count);
 
+// Copies length bytes with non-temporal stores where available, for large
+// copies whose destination won't be read again soon, so they don't evict
+// everything else from the cache.
+void copy_streaming(void* dest, const void* src, size_t length);
+
 void copy_and_swap_16_aligned(void* dest, const void* src, size_t count);
 void copy_and_swap_16_unaligned(void* dest, const void* src, size_t count);
 void copy_and_swap_32_aligned(void* dest, const void* src, size_t count);
@@ -61,6 +61,14 @@ bool QueryProtect(void* base_address, size_t& length, PageAccess& access_out) {
   return false;
 }
 
+void Prefetch(const void* base_address, size_t length) {
+  // madvise needs a page aligned address.
+  uintptr_t address = reinterpret_cast<uintptr_t>(base_address);
+  uintptr_t aligned_address = address & ~uintptr_t(page_size() - 1);
+  madvise(reinterpret_cast<void*>(aligned_address),
+          length + (address - aligned_address), MADV_WILLNEED);
+}
+
 FileMappingHandle CreateFileMappingHandle(std::wstring path, size_t length,
                                           PageAccess access, bool commit) {
   int oflag;
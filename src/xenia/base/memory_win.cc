@@ -142,6 +142,13 @@ bool QueryProtect(void* base_address, size_t& length, PageAccess& access_out) {
   return true;
 }
 
+void Prefetch(const void* base_address, size_t length) {
+  WIN32_MEMORY_RANGE_ENTRY range;
+  range.VirtualAddress = const_cast<void*>(base_address);
+  range.NumberOfBytes = length;
+  PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
 FileMappingHandle CreateFileMappingHandle(std::wstring path, size_t length,
                                           PageAccess access, bool commit) {
   DWORD protect =
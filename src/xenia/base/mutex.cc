@@ -9,8 +9,84 @@
 
 #include "xenia/base/mutex.h"
 
+#include <xmmintrin.h>
+
+#include "xenia/base/assert.h"
+
 namespace xe {
 
+// Number of times a contended lock is polled before the thread parks. Long
+// enough to cover a typical guest interrupts-disabled section.
+constexpr uint32_t kSpinCount = 1000;
+
+uintptr_t fast_recursive_mutex::current_thread_token() {
+  // Address of a thread-local is unique per live thread and never 0.
+  static thread_local uint8_t token;
+  return reinterpret_cast<uintptr_t>(&token);
+}
+
+bool fast_recursive_mutex::try_acquire(uintptr_t token) {
+  uintptr_t expected = 0;
+  if (!owner_.compare_exchange_strong(expected, token,
+                                      std::memory_order_seq_cst)) {
+    return false;
+  }
+  recursion_count_ = 1;
+  acquire_count_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void fast_recursive_mutex::lock() {
+  uintptr_t token = current_thread_token();
+  if (owner_.load(std::memory_order_relaxed) == token) {
+    ++recursion_count_;
+    return;
+  }
+  if (try_acquire(token)) {
+    return;
+  }
+
+  contended_count_.fetch_add(1, std::memory_order_relaxed);
+  for (uint32_t i = 0; i < kSpinCount; ++i) {
+    _mm_pause();
+    if (!owner_.load(std::memory_order_relaxed) && try_acquire(token)) {
+      return;
+    }
+  }
+
+  // Park. The waiter count is published before the owner is rechecked under
+  // park_mutex_, so an unlock either sees us waiting or we see it unlocked.
+  waiter_count_.fetch_add(1, std::memory_order_seq_cst);
+  {
+    std::unique_lock<std::mutex> park_lock(park_mutex_);
+    park_cond_.wait(park_lock, [this, token]() { return try_acquire(token); });
+  }
+  waiter_count_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool fast_recursive_mutex::try_lock() {
+  uintptr_t token = current_thread_token();
+  if (owner_.load(std::memory_order_relaxed) == token) {
+    ++recursion_count_;
+    return true;
+  }
+  return try_acquire(token);
+}
+
+void fast_recursive_mutex::unlock() {
+  assert_true(is_locked_by_current_thread());
+  if (--recursion_count_) {
+    return;
+  }
+  owner_.store(0, std::memory_order_seq_cst);
+  if (waiter_count_.load(std::memory_order_seq_cst)) {
+    // Taking park_mutex_ ensures the waiter is either before its recheck (and
+    // will see the lock free) or asleep (and will get the notification).
+    { std::lock_guard<std::mutex> park_lock(park_mutex_); }
+    park_cond_.notify_one();
+  }
+}
+
 std::recursive_mutex& global_critical_region::mutex() {
   static std::recursive_mutex global_mutex;
   return global_mutex;
@@ -10,10 +10,62 @@
 #ifndef XENIA_BASE_MUTEX_H_
 #define XENIA_BASE_MUTEX_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
 #include <mutex>
 
 namespace xe {
 
+// Recursive mutex tuned for short, frequently taken critical sections.
+// The owning thread and recursion count are tracked inline so uncontended and
+// recursive acquisitions are a single atomic operation. Contended acquisitions
+// spin briefly in case the owner is about to leave, then park until woken.
+//
+// Acquisitions and contended acquisitions are counted so that hot locks can be
+// identified; see acquire_count() and contended_count().
+//
+// Satisfies Lockable, so it can be used with std::unique_lock/lock_guard.
+class fast_recursive_mutex {
+ public:
+  fast_recursive_mutex() = default;
+  fast_recursive_mutex(const fast_recursive_mutex&) = delete;
+  fast_recursive_mutex& operator=(const fast_recursive_mutex&) = delete;
+
+  void lock();
+  bool try_lock();
+  void unlock();
+
+  // True if the calling thread currently holds the lock.
+  bool is_locked_by_current_thread() const {
+    return owner_.load(std::memory_order_relaxed) == current_thread_token();
+  }
+
+  // Number of times the lock was taken by a thread not already holding it.
+  uint64_t acquire_count() const {
+    return acquire_count_.load(std::memory_order_relaxed);
+  }
+  // Number of those acquisitions that found the lock held by another thread.
+  uint64_t contended_count() const {
+    return contended_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static uintptr_t current_thread_token();
+  bool try_acquire(uintptr_t token);
+
+  std::atomic<uintptr_t> owner_ = {0};
+  // Only touched by the owning thread.
+  uint32_t recursion_count_ = 0;
+
+  std::atomic<uint32_t> waiter_count_ = {0};
+  std::mutex park_mutex_;
+  std::condition_variable park_cond_;
+
+  std::atomic<uint64_t> acquire_count_ = {0};
+  std::atomic<uint64_t> contended_count_ = {0};
+};
+
 // The global critical region mutex singleton.
 // This must guard any operation that may suspend threads or be sensitive to
 // being suspended such as global table locks and such.
@@ -25,11 +77,12 @@ namespace xe {
 // will touch it. If it will be accessed from non-guest threads you may need
 // some additional protection.
 //
-// You can think of this as disabling interrupts in the guest. The thread in the
-// global critical region has exclusive access to the entire system and cannot
-// be preempted. This also means that all activity done while in the critical
-// region must be extremely fast (no IO!), as it has the chance to block any
-// other thread until its done.
+// The thread in the global critical region has exclusive access to the host
+// side of the system and cannot be suspended. This also means that all
+// activity done while in the critical region must be extremely fast (no IO!),
+// as it has the chance to block any other thread until its done. Guest code
+// disabling interrupts uses its own lock (PPCBuiltins::global_lock) and does
+// not take this one.
 //
 // For example, in the following situation thread 1 will not be able to suspend
 // thread 0 until it has exited its critical region, preventing it from being
@@ -0,0 +1,199 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/free_page_index.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace base {
+namespace test {
+
+// What a linear scan over the pages in steps of alignment would find.
+uint32_t ScanFirst(const std::vector<bool>& free, uint32_t low, uint32_t high,
+                   uint32_t count, uint32_t alignment) {
+  for (uint32_t base = (low + alignment - 1) / alignment * alignment;
+       base + count - 1 <= high && base + count <= free.size();
+       base += alignment) {
+    uint32_t i = 0;
+    while (i < count && free[base + i]) {
+      ++i;
+    }
+    if (i == count) {
+      return base;
+    }
+  }
+  return FreePageIndex::kNotFound;
+}
+
+uint32_t ScanLast(const std::vector<bool>& free, uint32_t low, uint32_t high,
+                  uint32_t count, uint32_t alignment) {
+  uint32_t result = FreePageIndex::kNotFound;
+  for (uint32_t base = (low + alignment - 1) / alignment * alignment;
+       base + count - 1 <= high && base + count <= free.size();
+       base += alignment) {
+    uint32_t i = 0;
+    while (i < count && free[base + i]) {
+      ++i;
+    }
+    if (i == count) {
+      result = base;
+    }
+  }
+  return result;
+}
+
+TEST_CASE("free_page_index_empty", "FreePageIndex") {
+  FreePageIndex index;
+  index.Reset(1000);
+  REQUIRE(index.page_count() == 1000);
+  REQUIRE(index.free_page_count() == 1000);
+  REQUIRE(index.FindFirst(0, 999, 1000, 1) == 0);
+  REQUIRE(index.FindFirst(0, 999, 1001, 1) == FreePageIndex::kNotFound);
+  REQUIRE(index.FindFirst(5, 999, 10, 16) == 16);
+  REQUIRE(index.FindLast(0, 999, 10, 1) == 990);
+  REQUIRE(index.FindLast(0, 999, 10, 16) == 976);
+  REQUIRE(index.FindLast(0, 100, 1, 1) == 100);
+}
+
+TEST_CASE("free_page_index_mark", "FreePageIndex") {
+  FreePageIndex index;
+  index.Reset(300);
+  index.MarkUsed(60, 10);
+  REQUIRE(index.free_page_count() == 290);
+  REQUIRE(!index.IsFree(60));
+  REQUIRE(!index.IsFree(69));
+  REQUIRE(index.IsFree(59));
+  REQUIRE(index.IsFree(70));
+  // Marking twice doesn't count twice.
+  index.MarkUsed(65, 10);
+  REQUIRE(index.free_page_count() == 285);
+
+  REQUIRE(index.FindFirst(0, 299, 60, 1) == 0);
+  REQUIRE(index.FindFirst(0, 299, 61, 1) == 75);
+  REQUIRE(index.FindFirst(1, 299, 60, 1) == 75);
+  REQUIRE(index.FindLast(0, 74, 60, 1) == 0);
+  REQUIRE(index.FindLast(0, 299, 225, 1) == 75);
+  REQUIRE(index.FindLast(0, 299, 226, 1) == FreePageIndex::kNotFound);
+
+  index.MarkFree(60, 15);
+  REQUIRE(index.free_page_count() == 300);
+  REQUIRE(index.FindFirst(0, 299, 300, 1) == 0);
+}
+
+TEST_CASE("free_page_index_alignment", "FreePageIndex") {
+  FreePageIndex index;
+  index.Reset(256);
+  index.MarkUsed(0, 1);
+  index.MarkUsed(100, 1);
+  // Free from 1, but the first aligned base with room is past the hole.
+  REQUIRE(index.FindFirst(0, 255, 16, 1) == 1);
+  REQUIRE(index.FindFirst(0, 255, 16, 32) == 32);
+  REQUIRE(index.FindFirst(0, 255, 80, 32) == 128);
+  REQUIRE(index.FindLast(0, 255, 80, 32) == 160);
+  REQUIRE(index.FindLast(0, 150, 40, 32) == 32);
+  REQUIRE(index.FindLast(40, 150, 40, 32) == FreePageIndex::kNotFound);
+}
+
+TEST_CASE("free_page_index_random", "FreePageIndex") {
+  std::mt19937 random(1234);
+  for (uint32_t page_count : {1u, 63u, 64u, 65u, 1000u, 4096u}) {
+    FreePageIndex index;
+    index.Reset(page_count);
+    std::vector<bool> free(page_count, true);
+    for (int i = 0; i < 1000; ++i) {
+      uint32_t first = random() % page_count;
+      uint32_t count = 1 + random() % std::min(page_count - first, 100u);
+      bool mark_free = random() % 3 == 0;
+      if (mark_free) {
+        index.MarkFree(first, count);
+      } else {
+        index.MarkUsed(first, count);
+      }
+      for (uint32_t j = first; j < first + count; ++j) {
+        free[j] = mark_free;
+      }
+
+      uint32_t low = random() % page_count;
+      uint32_t high = low + random() % (page_count - low);
+      uint32_t find_count = 1 + random() % 32;
+      uint32_t alignment = 1u << (random() % 5);
+      REQUIRE(index.FindFirst(low, high, find_count, alignment) ==
+              ScanFirst(free, low, high, find_count, alignment));
+      REQUIRE(index.FindLast(low, high, find_count, alignment) ==
+              ScanLast(free, low, high, find_count, alignment));
+    }
+    uint32_t free_page_count = 0;
+    for (uint32_t j = 0; j < page_count; ++j) {
+      free_page_count += free[j] ? 1 : 0;
+      REQUIRE(index.IsFree(j) == free[j]);
+    }
+    REQUIRE(index.free_page_count() == free_page_count);
+  }
+}
+
+// Compares against a linear scan of a 512 MB heap of 4 KB pages fragmented by
+// 64 KB aligned allocations.
+TEST_CASE("free_page_index_benchmark", "[.benchmark]") {
+  const uint32_t page_count = 512 * 1024 * 1024 / 4096;
+  const uint32_t alignment = 16;
+  const int iteration_count = 10000;
+  std::mt19937 random(1234);
+  FreePageIndex index;
+  index.Reset(page_count);
+  std::vector<bool> free(page_count, true);
+  // Fill most of the heap, then free every other allocation.
+  std::vector<std::pair<uint32_t, uint32_t>> allocations;
+  while (index.free_page_count() > page_count / 8) {
+    uint32_t count = 1 + random() % 64;
+    uint32_t base = index.FindFirst(0, page_count - 1, count, alignment);
+    if (base == FreePageIndex::kNotFound) {
+      break;
+    }
+    index.MarkUsed(base, count);
+    allocations.emplace_back(base, count);
+  }
+  for (size_t i = 0; i < allocations.size(); i += 2) {
+    index.MarkFree(allocations[i].first, allocations[i].second);
+  }
+  for (uint32_t i = 0; i < page_count; ++i) {
+    free[i] = index.IsFree(i);
+  }
+
+  auto run = [&](const char* name, bool use_index) {
+    std::mt19937 sizes(5678);
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iteration_count; ++i) {
+      uint32_t count = 1 + sizes() % 128;
+      checksum +=
+          use_index
+              ? index.FindFirst(0, page_count - 1, count, alignment)
+              : ScanFirst(free, 0, page_count - 1, count, alignment);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    std::printf("%s: %.1fns per search (checksum %llu)\n", name,
+                elapsed.count() * 1000.0 / iteration_count,
+                static_cast<unsigned long long>(checksum));
+  };
+  run("FreePageIndex", true);
+  run("Linear scan", false);
+}
+
+}  // namespace test
+}  // namespace base
+}  // namespace xe
@@ -34,6 +34,29 @@ TEST_CASE("copy_128_aligned", "Copy and Swap") {
   REQUIRE(std::memcmp(dest, src + 1, 128));
 }
 
+TEST_CASE("copy_streaming", "Copy and Swap") {
+  alignas(16) uint8_t src[300], dest[300];
+  for (size_t i = 0; i < sizeof(src); ++i) {
+    src[i] = uint8_t(i * 7);
+  }
+  // Every alignment of both ends, and lengths around the 64 byte blocks.
+  for (size_t dest_offset = 0; dest_offset < 16; ++dest_offset) {
+    for (size_t src_offset = 0; src_offset < 16; src_offset += 5) {
+      for (size_t length : {0, 1, 15, 16, 63, 64, 65, 200, 270}) {
+        std::memset(dest, 0xCD, sizeof(dest));
+        copy_streaming(dest + dest_offset, src + src_offset, length);
+        REQUIRE(std::memcmp(dest + dest_offset, src + src_offset, length) == 0);
+        if (dest_offset + length < sizeof(dest)) {
+          REQUIRE(dest[dest_offset + length] == 0xCD);
+        }
+        if (dest_offset) {
+          REQUIRE(dest[dest_offset - 1] == 0xCD);
+        }
+      }
+    }
+  }
+}
+
 TEST_CASE("copy_and_swap_16_aligned", "Copy and Swap") {
   alignas(16) uint16_t a = 0x1111, b = 0xABCD;
   copy_and_swap_16_aligned(&a, &b, 1);
@@ -405,13 +428,51 @@ TEST_CASE("copy_and_swap_64_unaligned", "Copy and Swap") {
 }
 
 TEST_CASE("copy_and_swap_16_in_32_aligned", "Copy and Swap") {
-  // TODO(bwrsandman): test once properly understood.
-  REQUIRE(true == true);
+  alignas(32) uint32_t a = 0x11111111, b = 0x89ABCDEF;
+  copy_and_swap_16_in_32_aligned(&a, &b, 1);
+  REQUIRE(a == 0xCDEF89AB);
+  REQUIRE(b == 0x89ABCDEF);
+
+  alignas(32) uint32_t c[] = {0x00000000, 0x00000000, 0x00000000, 0x00000000,
+                              0x00000000, 0x00000000};
+  alignas(32) uint32_t d[] = {0x01234567, 0x89ABCDEF, 0xE887EEED,
+                              0xD8514199, 0x00112233, 0x44556677};
+  copy_and_swap_16_in_32_aligned(c, d, 1);
+  REQUIRE(c[0] == 0x45670123);
+  REQUIRE(c[1] == 0x00000000);
+
+  copy_and_swap_16_in_32_aligned(c, d, 5);
+  REQUIRE(c[0] == 0x45670123);
+  REQUIRE(c[1] == 0xCDEF89AB);
+  REQUIRE(c[2] == 0xEEEDE887);
+  REQUIRE(c[3] == 0x4199D851);
+  REQUIRE(c[4] == 0x22330011);
+  REQUIRE(c[5] == 0x00000000);
+
+  copy_and_swap_16_in_32_aligned(c, d, 6);
+  REQUIRE(c[4] == 0x22330011);
+  REQUIRE(c[5] == 0x66774455);
 }
 
 TEST_CASE("copy_and_swap_16_in_32_unaligned", "Copy and Swap") {
-  // TODO(bwrsandman): test once properly understood.
-  REQUIRE(true == true);
+  uint8_t a[28] = {};
+  uint8_t b[28];
+  for (uint8_t i = 0; i < 28; ++i) {
+    b[i] = i;
+  }
+  // Each group of four bytes has its halves exchanged, wherever it starts.
+  for (size_t offset = 0; offset < 4; ++offset) {
+    std::memset(a, 0, sizeof(a));
+    copy_and_swap_16_in_32_unaligned(a + offset, b + offset, 6);
+    for (size_t i = 0; i < 28; ++i) {
+      uint8_t expected = 0;
+      if (i >= offset && i < offset + 24) {
+        size_t j = i - offset;
+        expected = b[offset + (j & ~size_t(3)) + ((j & 3) ^ 2)];
+      }
+      REQUIRE(a[i] == expected);
+    }
+  }
 }
 
 }  // namespace test
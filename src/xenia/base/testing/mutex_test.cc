@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/mutex.h"
+
+#include <thread>
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace base {
+namespace test {
+
+TEST_CASE("fast_recursive_mutex_recursion", "Mutex") {
+  fast_recursive_mutex mutex;
+  REQUIRE(!mutex.is_locked_by_current_thread());
+  mutex.lock();
+  mutex.lock();
+  REQUIRE(mutex.try_lock());
+  REQUIRE(mutex.is_locked_by_current_thread());
+  mutex.unlock();
+  mutex.unlock();
+  REQUIRE(mutex.is_locked_by_current_thread());
+  mutex.unlock();
+  REQUIRE(!mutex.is_locked_by_current_thread());
+  // Recursive acquisitions aren't counted.
+  REQUIRE(mutex.acquire_count() == 1);
+  REQUIRE(mutex.contended_count() == 0);
+}
+
+TEST_CASE("fast_recursive_mutex_exclusion", "Mutex") {
+  fast_recursive_mutex mutex;
+  mutex.lock();
+  bool other_acquired = true;
+  std::thread([&]() { other_acquired = mutex.try_lock(); }).join();
+  REQUIRE(!other_acquired);
+  mutex.unlock();
+  std::thread([&]() {
+    other_acquired = mutex.try_lock();
+    if (other_acquired) {
+      mutex.unlock();
+    }
+  }).join();
+  REQUIRE(other_acquired);
+}
+
+TEST_CASE("fast_recursive_mutex_contention", "Mutex") {
+  fast_recursive_mutex mutex;
+  const int thread_count = 4;
+  const int iteration_count = 100000;
+  int counter = 0;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < iteration_count; ++j) {
+        std::lock_guard<fast_recursive_mutex> lock(mutex);
+        std::lock_guard<fast_recursive_mutex> nested_lock(mutex);
+        ++counter;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(counter == thread_count * iteration_count);
+  REQUIRE(mutex.acquire_count() == uint64_t(thread_count * iteration_count));
+  REQUIRE(mutex.contended_count() <= mutex.acquire_count());
+}
+
+}  // namespace test
+}  // namespace base
+}  // namespace xe
@@ -0,0 +1,83 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/base/threading.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace base {
+namespace test {
+
+using std::chrono::steady_clock;
+
+// Far longer than any of the waits below should take, so hitting it means a
+// wake was missed.
+const std::chrono::seconds kLongTimeout(10);
+
+TEST_CASE("wait_for_address_change_wake", "Threading") {
+  volatile uint32_t value = 0;
+  const int thread_count = 4;
+  std::atomic<int> waiting_count(0);
+  std::atomic<int> woken_count(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&]() {
+      ++waiting_count;
+      // Returns may be spurious.
+      while (!value) {
+        threading::WaitForAddressChange(&value, 0, kLongTimeout);
+      }
+      ++woken_count;
+    });
+  }
+  while (waiting_count != thread_count) {
+    std::this_thread::yield();
+  }
+  // Give the threads time to block.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  REQUIRE(woken_count == 0);
+
+  auto start_time = steady_clock::now();
+  value = 1;
+  threading::WakeAddressWaiters(&value);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(woken_count == thread_count);
+  REQUIRE(steady_clock::now() - start_time < kLongTimeout / 2);
+}
+
+TEST_CASE("wait_for_address_change_timeout", "Threading") {
+  volatile uint32_t value = 0;
+  auto start_time = steady_clock::now();
+  threading::WaitForAddressChange(&value, 0, std::chrono::milliseconds(50));
+  REQUIRE(steady_clock::now() - start_time < kLongTimeout / 2);
+  REQUIRE(value == 0);
+
+  // Nothing to wake.
+  threading::WakeAddressWaiters(&value);
+}
+
+TEST_CASE("wait_for_address_change_mismatch", "Threading") {
+  // Returns right away if the value already differs.
+  volatile uint32_t value = 1;
+  auto start_time = steady_clock::now();
+  threading::WaitForAddressChange(&value, 0, kLongTimeout);
+  REQUIRE(steady_clock::now() - start_time < kLongTimeout / 2);
+}
+
+}  // namespace test
+}  // namespace base
+}  // namespace xe
@@ -77,6 +77,14 @@ void MaybeYield();
 // Memory barrier (request - may be ignored).
 void SyncMemory();
 
+// Blocks the current thread while *address == compare_value, until another
+// thread calls WakeAddressWaiters on it or the timeout passes. May also return
+// spuriously, so the caller must check the value again.
+void WaitForAddressChange(volatile uint32_t* address, uint32_t compare_value,
+                          std::chrono::microseconds timeout);
+// Wakes all threads blocked in WaitForAddressChange on the address.
+void WakeAddressWaiters(volatile uint32_t* address);
+
 // Sleeps the current thread for at least as long as the given duration.
 void Sleep(std::chrono::microseconds duration);
 template <typename Rep, typename Period>
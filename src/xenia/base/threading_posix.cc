@@ -12,6 +12,7 @@
 #include "xenia/base/assert.h"
 #include "xenia/base/logging.h"
 
+#include <linux/futex.h>
 #include <pthread.h>
 #include <sys/eventfd.h>
 #include <sys/syscall.h>
@@ -47,6 +48,19 @@ void MaybeYield() {
 
 void SyncMemory() { __sync_synchronize(); }
 
+void WaitForAddressChange(volatile uint32_t* address, uint32_t compare_value,
+                          std::chrono::microseconds timeout) {
+  timespec timeout_spec = {time_t(timeout.count() / 1000000),
+                           long(timeout.count() % 1000000 * 1000)};
+  syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, compare_value, &timeout_spec,
+          nullptr, 0);
+}
+
+void WakeAddressWaiters(volatile uint32_t* address) {
+  syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr,
+          0);
+}
+
 void Sleep(std::chrono::microseconds duration) {
   timespec rqtp = {time_t(duration.count() / 1000000),
                    time_t(duration.count() % 1000)};
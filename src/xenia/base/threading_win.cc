@@ -81,6 +81,18 @@ void MaybeYield() {
 
 void SyncMemory() { MemoryBarrier(); }
 
+void WaitForAddressChange(volatile uint32_t* address, uint32_t compare_value,
+                          std::chrono::microseconds timeout) {
+  auto timeout_ms = std::max(timeout.count() / 1000,
+                             std::chrono::microseconds::rep(1));
+  ::WaitOnAddress(address, &compare_value, sizeof(compare_value),
+                  static_cast<DWORD>(timeout_ms));
+}
+
+void WakeAddressWaiters(volatile uint32_t* address) {
+  ::WakeByAddressAll(const_cast<uint32_t*>(address));
+}
+
 void Sleep(std::chrono::microseconds duration) {
   if (duration.count() < 100) {
     MaybeYield();
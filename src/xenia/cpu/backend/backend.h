@@ -11,6 +11,7 @@
 #define XENIA_CPU_BACKEND_BACKEND_H_
 
 #include <memory>
+#include <string>
 
 #include "xenia/cpu/backend/machine_info.h"
 #include "xenia/cpu/thread_debug_info.h"
@@ -54,6 +55,18 @@ class Backend {
   virtual std::unique_ptr<GuestFunction> CreateGuestFunction(
       Module* module, uint32_t address) = 0;
 
+  // Sets up persistent storage of generated code for the title whose image
+  // occupies the given guest range. Returns false if unsupported.
+  virtual bool InitializeCodeStorage(const std::wstring& storage_root,
+                                     uint32_t title_id, uint32_t image_base,
+                                     uint32_t image_size) {
+    return false;
+  }
+  virtual void ShutdownCodeStorage() {}
+  // Defines the function from previously stored code, if available, without
+  // running it through the frontend.
+  virtual bool RestoreFunction(GuestFunction* function) { return false; }
+
   // Calculates the next host instruction based on the current thread state and
   // current PC. This will look for branches and other control flow
   // instructions.
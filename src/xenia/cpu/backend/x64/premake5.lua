@@ -10,6 +10,7 @@ project("xenia-cpu-backend-x64")
     "capstone",
     "xenia-base",
     "xenia-cpu",
+    "xxhash",
   })
   defines({
     "CAPSTONE_X86_ATT_DISABLE",
@@ -18,6 +18,7 @@
 #include "xenia/base/logging.h"
 #include "xenia/cpu/backend/x64/x64_assembler.h"
 #include "xenia/cpu/backend/x64/x64_code_cache.h"
+#include "xenia/cpu/backend/x64/x64_code_storage.h"
 #include "xenia/cpu/backend/x64/x64_emitter.h"
 #include "xenia/cpu/backend/x64/x64_function.h"
 #include "xenia/cpu/backend/x64/x64_sequences.h"
@@ -64,6 +65,8 @@ X64Backend::X64Backend() : Backend(), code_cache_(nullptr) {
 }
 
 X64Backend::~X64Backend() {
+  ShutdownCodeStorage();
+
   if (capstone_handle_) {
     cs_close(&capstone_handle_);
   }
@@ -129,6 +132,10 @@ bool X64Backend::Initialize(Processor* processor) {
   // Allocate emitter constant data.
   emitter_data_ = X64Emitter::PlaceConstData();
 
+  // Everything placed so far lands at the same offsets on every run, so stored
+  // guest code may reference it directly.
+  host_code_size_ = code_cache_->generated_code_size();
+
   // Setup exception callback
   ExceptionHandler::Install(&ExceptionCallbackThunk, this);
 
@@ -149,6 +156,33 @@ std::unique_ptr<GuestFunction> X64Backend::CreateGuestFunction(
   return std::make_unique<X64Function>(module, address);
 }
 
+bool X64Backend::InitializeCodeStorage(const std::wstring& storage_root,
+                                       uint32_t title_id, uint32_t image_base,
+                                       uint32_t image_size) {
+  ShutdownCodeStorage();
+  auto code_storage = std::make_unique<X64CodeStorage>(this);
+  if (!code_storage->Initialize(storage_root, title_id, image_base,
+                                image_size)) {
+    return false;
+  }
+  code_storage_ = std::move(code_storage);
+  return true;
+}
+
+void X64Backend::ShutdownCodeStorage() {
+  if (code_storage_) {
+    code_storage_->Shutdown();
+    code_storage_.reset();
+  }
+}
+
+bool X64Backend::RestoreFunction(GuestFunction* function) {
+  if (!code_storage_) {
+    return false;
+  }
+  return code_storage_->RestoreFunction(static_cast<X64Function*>(function));
+}
+
 uint64_t ReadCapstoneReg(X64Context* context, x86_reg reg) {
   switch (reg) {
     case X86_REG_RAX:
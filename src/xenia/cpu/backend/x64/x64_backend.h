@@ -26,6 +26,7 @@ namespace backend {
 namespace x64 {
 
 class X64CodeCache;
+class X64CodeStorage;
 
 #define XENIA_HAS_X64_BACKEND 1
 
@@ -41,7 +42,11 @@ class X64Backend : public Backend {
   ~X64Backend() override;
 
   X64CodeCache* code_cache() const { return code_cache_.get(); }
+  // Non-null only while persistent code storage is active.
+  X64CodeStorage* code_storage() const { return code_storage_.get(); }
   uintptr_t emitter_data() const { return emitter_data_; }
+  // Size of the host code (thunks/constants) placed at initialization.
+  size_t host_code_size() const { return host_code_size_; }
 
   // Call a generated function, saving all stack parameters.
   HostToGuestThunk host_to_guest_thunk() const { return host_to_guest_thunk_; }
@@ -61,6 +66,12 @@ class X64Backend : public Backend {
   std::unique_ptr<GuestFunction> CreateGuestFunction(Module* module,
                                                      uint32_t address) override;
 
+  bool InitializeCodeStorage(const std::wstring& storage_root,
+                             uint32_t title_id, uint32_t image_base,
+                             uint32_t image_size) override;
+  void ShutdownCodeStorage() override;
+  bool RestoreFunction(GuestFunction* function) override;
+
   uint64_t CalculateNextHostInstruction(ThreadDebugInfo* thread_info,
                                         uint64_t current_pc) override;
 
@@ -75,7 +86,9 @@ class X64Backend : public Backend {
   uintptr_t capstone_handle_ = 0;
 
   std::unique_ptr<X64CodeCache> code_cache_;
+  std::unique_ptr<X64CodeStorage> code_storage_;
   uintptr_t emitter_data_ = 0;
+  size_t host_code_size_ = 0;
 
   HostToGuestThunk host_to_guest_thunk_;
   GuestToHostThunk guest_to_host_thunk_;
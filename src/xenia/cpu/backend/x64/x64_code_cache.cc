@@ -105,6 +105,16 @@ void X64CodeCache::AddIndirection(uint32_t guest_address,
   *indirection_slot = host_address;
 }
 
+uint32_t X64CodeCache::LookupIndirection(uint32_t guest_address) {
+  if (!indirection_table_base_) {
+    return 0;
+  }
+
+  uint32_t* indirection_slot = reinterpret_cast<uint32_t*>(
+      indirection_table_base_ + (guest_address - kIndirectionTableBase));
+  return *indirection_slot;
+}
+
 void X64CodeCache::CommitExecutableRange(uint32_t guest_low,
                                          uint32_t guest_high) {
   if (!indirection_table_base_) {
@@ -49,13 +49,16 @@ class X64CodeCache : public CodeCache {
   uint32_t base_address() const override { return kGeneratedCodeBase; }
   uint32_t total_size() const override { return kGeneratedCodeSize; }
 
-  // TODO(benvanik): ELF serialization/etc
+  // NOTE: persisting guest code across runs is handled by X64CodeStorage.
   // TODO(benvanik): keep track of code blocks
   // TODO(benvanik): padding/guards/etc
 
   bool has_indirection_table() { return indirection_table_base_ != nullptr; }
   void set_indirection_default(uint32_t default_value);
   void AddIndirection(uint32_t guest_address, uint32_t host_address);
+  // Host address calls to the guest address are currently dispatched to, or 0
+  // without an indirection table.
+  uint32_t LookupIndirection(uint32_t guest_address);
 
   void CommitExecutableRange(uint32_t guest_low, uint32_t guest_high);
 
@@ -66,6 +69,12 @@ class X64CodeCache : public CodeCache {
                        GuestFunction* function_info);
   uint32_t PlaceData(const void* data, size_t length);
 
+  // Total bytes of code and data placed so far.
+  size_t generated_code_size() {
+    auto global_lock = global_critical_region_.Acquire();
+    return generated_code_offset_;
+  }
+
   GuestFunction* LookupFunction(uint64_t host_pc) override;
 
  protected:
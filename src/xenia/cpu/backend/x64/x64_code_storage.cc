@@ -0,0 +1,360 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/backend/x64/x64_code_storage.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "build/version.h"
+#include "third_party/xxhash/xxhash.h"
+#include "xenia/base/assert.h"
+#include "xenia/base/filesystem.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/math.h"
+#include "xenia/base/string.h"
+#include "xenia/cpu/backend/x64/x64_backend.h"
+#include "xenia/cpu/backend/x64/x64_code_cache.h"
+#include "xenia/cpu/backend/x64/x64_function.h"
+#include "xenia/cpu/cpu_flags.h"
+#include "xenia/cpu/processor.h"
+
+// NOTE: must be included last as it expects windows.h to already be included.
+#include "third_party/xbyak/xbyak/xbyak_util.h"
+
+DECLARE_bool(emit_source_annotations);
+DECLARE_bool(inline_mmio_access);
+DECLARE_bool(store_all_context_values);
+
+namespace xe {
+namespace cpu {
+namespace backend {
+namespace x64 {
+
+// 'XECC'.
+static const uint32_t kCodeStorageMagic = 0x43434558;
+// Bump whenever the record layout or anything influencing emitted code that
+// isn't covered by the config hash changes.
+static const uint32_t kCodeStorageVersion = 1;
+
+// Image pointers are stored relative to this so that only the image load
+// delta needs to be applied on restore.
+static const uint8_t image_anchor_ = 0;
+static uint64_t image_anchor() {
+  return reinterpret_cast<uint64_t>(&image_anchor_);
+}
+
+struct X64CodeStorage::FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t config_hash;
+  uint64_t module_hash;
+  uint32_t host_code_size;
+  uint32_t reserved;
+};
+
+// Followed by the machine code (padded to 8b), the relocations and the source
+// map.
+struct X64CodeStorage::RecordHeader {
+  uint32_t record_size;
+  uint32_t guest_address;
+  uint32_t guest_end_address;
+  uint32_t relocation_count;
+  uint64_t guest_code_hash;
+  uint32_t source_map_count;
+  uint32_t code_size_total;
+  uint32_t code_size_prolog;
+  uint32_t code_size_body;
+  uint32_t code_size_epilog;
+  uint32_t code_size_tail;
+  uint32_t prolog_stack_alloc_offset;
+  uint32_t stack_size;
+};
+static_assert(sizeof(X64Relocation) == 8, "Relocations are stored raw");
+static_assert(sizeof(SourceMapEntry) == 12, "Source maps are stored raw");
+
+X64CodeStorage::X64CodeStorage(X64Backend* backend) : backend_(backend) {}
+
+X64CodeStorage::~X64CodeStorage() { Shutdown(); }
+
+bool X64CodeStorage::Initialize(const std::wstring& storage_root,
+                                uint32_t title_id, uint32_t image_base,
+                                uint32_t image_size) {
+  Shutdown();
+
+  auto code_storage_root = xe::join_paths(storage_root, L"cache");
+  code_storage_root = xe::join_paths(code_storage_root, L"code");
+  if (!xe::filesystem::CreateFolder(code_storage_root)) {
+    XELOGE("Unable to create code storage folder");
+    return false;
+  }
+  file_path_ = xe::join_paths(code_storage_root,
+                              xe::format_string(L"%.8X.xcc", title_id));
+
+  config_hash_ = CalculateConfigHash();
+  module_hash_ = XXH64(
+      backend_->processor()->memory()->TranslateVirtual(image_base),
+      image_size, 0);
+  host_code_size_ = uint32_t(backend_->host_code_size());
+
+  file_valid_ = false;
+  stored_records_.clear();
+  mapped_file_ = MappedMemory::Open(file_path_, MappedMemory::Mode::kRead);
+  if (!mapped_file_ || mapped_file_->size() < sizeof(FileHeader)) {
+    mapped_file_.reset();
+    XELOGI("Code storage: no stored code for %.8X", title_id);
+    return true;
+  }
+
+  auto file_header =
+      reinterpret_cast<const FileHeader*>(mapped_file_->data());
+  if (file_header->magic != kCodeStorageMagic ||
+      file_header->version != kCodeStorageVersion ||
+      file_header->config_hash != config_hash_ ||
+      file_header->module_hash != module_hash_ ||
+      file_header->host_code_size != host_code_size_) {
+    // Stale - will be replaced on shutdown.
+    mapped_file_.reset();
+    XELOGI("Code storage: stored code for %.8X is out of date", title_id);
+    return true;
+  }
+  file_valid_ = true;
+
+  // Index all records, stopping at the first one that looks truncated.
+  size_t offset = sizeof(FileHeader);
+  size_t file_size = mapped_file_->size();
+  while (offset + sizeof(RecordHeader) <= file_size) {
+    auto record = reinterpret_cast<const RecordHeader*>(mapped_file_->data() +
+                                                        offset);
+    if (record->record_size < sizeof(RecordHeader) ||
+        record->record_size > file_size - offset ||
+        (record->record_size & 7)) {
+      break;
+    }
+    // Later records for the same address supersede earlier ones.
+    stored_records_[record->guest_address] = record;
+    offset += record->record_size;
+  }
+  valid_file_size_ = offset;
+
+  XELOGI("Code storage: %zu stored functions for %.8X", stored_records_.size(),
+         title_id);
+  return true;
+}
+
+void X64CodeStorage::Shutdown() {
+  std::vector<uint8_t> pending_records;
+  size_t pending_record_count;
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_records.swap(pending_records_);
+    pending_record_count = pending_record_count_;
+    pending_record_count_ = 0;
+  }
+
+  if (!pending_records.empty() && !file_path_.empty()) {
+    FILE* file;
+    if (file_valid_ && mapped_file_ &&
+        valid_file_size_ == mapped_file_->size()) {
+      // Can simply append to what's already there.
+      mapped_file_.reset();
+      file = xe::filesystem::OpenFile(file_path_, "ab");
+    } else {
+      // Rewrite from scratch, keeping any valid records.
+      std::vector<uint8_t> valid_records;
+      if (file_valid_ && mapped_file_) {
+        valid_records.assign(mapped_file_->data() + sizeof(FileHeader),
+                             mapped_file_->data() + valid_file_size_);
+      }
+      mapped_file_.reset();
+      file = xe::filesystem::OpenFile(file_path_, "wb");
+      if (file) {
+        FileHeader file_header = {};
+        file_header.magic = kCodeStorageMagic;
+        file_header.version = kCodeStorageVersion;
+        file_header.config_hash = config_hash_;
+        file_header.module_hash = module_hash_;
+        file_header.host_code_size = host_code_size_;
+        fwrite(&file_header, sizeof(file_header), 1, file);
+        if (!valid_records.empty()) {
+          fwrite(valid_records.data(), valid_records.size(), 1, file);
+        }
+      }
+    }
+    if (file) {
+      fwrite(pending_records.data(), pending_records.size(), 1, file);
+      fclose(file);
+      XELOGI("Code storage: stored %zu new functions", pending_record_count);
+    } else {
+      XELOGE("Code storage: unable to write %S", file_path_.c_str());
+    }
+  }
+
+  mapped_file_.reset();
+  stored_records_.clear();
+  file_valid_ = false;
+  valid_file_size_ = 0;
+  file_path_.clear();
+}
+
+uint64_t X64CodeStorage::CalculateConfigHash() const {
+  // Everything that changes emitted code for identical guest code.
+  XXH64_state_t hash_state;
+  XXH64_reset(&hash_state, 0);
+  XXH64_update(&hash_state, XE_BUILD_COMMIT, std::strlen(XE_BUILD_COMMIT));
+
+  Xbyak::util::Cpu cpu;
+  uint64_t config[] = {
+      kCodeStorageVersion,
+      uint64_t(cvars::use_haswell_instructions),
+      uint64_t(cpu.has(Xbyak::util::Cpu::tAVX2)),
+      uint64_t(cpu.has(Xbyak::util::Cpu::tFMA)),
+      uint64_t(cpu.has(Xbyak::util::Cpu::tLZCNT)),
+      uint64_t(cpu.has(Xbyak::util::Cpu::tBMI2)),
+      uint64_t(cpu.has(Xbyak::util::Cpu::tF16C)),
+      uint64_t(cpu.has(Xbyak::util::Cpu::tMOVBE)),
+      uint64_t(cvars::disable_global_lock),
+      uint64_t(cvars::emit_source_annotations),
+      uint64_t(cvars::inline_mmio_access),
+      uint64_t(cvars::store_all_context_values),
+      uint64_t(cvars::break_on_debugbreak),
+      uint64_t(cvars::break_on_instruction),
+      // Constant loads are absolute, and PlaceConstData may have had to move
+      // the table since the code was stored.
+      uint64_t(backend_->emitter_data()),
+  };
+  XXH64_update(&hash_state, config, sizeof(config));
+  return XXH64_digest(&hash_state);
+}
+
+uint64_t X64CodeStorage::HashGuestCode(uint32_t address,
+                                       uint32_t end_address) const {
+  // end_address is the address of the last instruction.
+  auto memory = backend_->processor()->memory();
+  return XXH64(memory->TranslateVirtual(address), end_address - address + 4,
+               0);
+}
+
+bool X64CodeStorage::RestoreFunction(X64Function* function) {
+  auto it = stored_records_.find(function->address());
+  if (it == stored_records_.end()) {
+    return false;
+  }
+  auto record = it->second;
+  if (record->guest_end_address < record->guest_address ||
+      HashGuestCode(record->guest_address, record->guest_end_address) !=
+          record->guest_code_hash) {
+    // Guest code changed (patched, or a different function ended up here).
+    return false;
+  }
+
+  auto code = reinterpret_cast<const uint8_t*>(record + 1);
+  auto relocations = reinterpret_cast<const X64Relocation*>(
+      code + xe::round_up(record->code_size_total, 8));
+  auto source_map = reinterpret_cast<const SourceMapEntry*>(
+      relocations + record->relocation_count);
+
+  // Relocate into a scratch copy; PlaceGuestCode copies it into the cache.
+  std::vector<uint8_t> machine_code(code, code + record->code_size_total);
+  for (uint32_t i = 0; i < record->relocation_count; ++i) {
+    const auto& relocation = relocations[i];
+    assert_true(relocation.type == X64Relocation::Type::kImage64);
+    assert_true(relocation.code_offset + 8 <= machine_code.size());
+    uint64_t value;
+    std::memcpy(&value, machine_code.data() + relocation.code_offset, 8);
+    value += image_anchor();
+    std::memcpy(machine_code.data() + relocation.code_offset, &value, 8);
+  }
+
+  EmitFunctionInfo func_info = {};
+  func_info.code_size.total = record->code_size_total;
+  func_info.code_size.prolog = record->code_size_prolog;
+  func_info.code_size.body = record->code_size_body;
+  func_info.code_size.epilog = record->code_size_epilog;
+  func_info.code_size.tail = record->code_size_tail;
+  func_info.prolog_stack_alloc_offset = record->prolog_stack_alloc_offset;
+  func_info.stack_size = record->stack_size;
+
+  function->set_end_address(record->guest_end_address);
+  function->source_map().assign(source_map,
+                                source_map + record->source_map_count);
+  auto code_address = backend_->code_cache()->PlaceGuestCode(
+      function->address(), machine_code.data(), func_info, function);
+  function->Setup(reinterpret_cast<uint8_t*>(code_address),
+                  record->code_size_total);
+
+  ++restored_function_count_;
+  return true;
+}
+
+void X64CodeStorage::StoreFunction(
+    GuestFunction* function, const void* machine_code,
+    const EmitFunctionInfo& func_info,
+    const std::vector<X64Relocation>& relocations,
+    const std::vector<SourceMapEntry>& source_map) {
+  if (file_path_.empty() || function->end_address() < function->address()) {
+    return;
+  }
+
+  RecordHeader record = {};
+  size_t code_size_aligned = xe::round_up(func_info.code_size.total, 8);
+  size_t record_size = sizeof(RecordHeader) + code_size_aligned +
+                       relocations.size() * sizeof(X64Relocation) +
+                       source_map.size() * sizeof(SourceMapEntry);
+  record_size = xe::round_up(record_size, 8);
+  record.record_size = uint32_t(record_size);
+  record.guest_address = function->address();
+  record.guest_end_address = function->end_address();
+  record.relocation_count = uint32_t(relocations.size());
+  record.guest_code_hash =
+      HashGuestCode(function->address(), function->end_address());
+  record.source_map_count = uint32_t(source_map.size());
+  record.code_size_total = uint32_t(func_info.code_size.total);
+  record.code_size_prolog = uint32_t(func_info.code_size.prolog);
+  record.code_size_body = uint32_t(func_info.code_size.body);
+  record.code_size_epilog = uint32_t(func_info.code_size.epilog);
+  record.code_size_tail = uint32_t(func_info.code_size.tail);
+  record.prolog_stack_alloc_offset =
+      uint32_t(func_info.prolog_stack_alloc_offset);
+  record.stack_size = uint32_t(func_info.stack_size);
+
+  std::lock_guard<std::mutex> lock(pending_mutex_);
+  size_t offset = pending_records_.size();
+  pending_records_.resize(offset + record_size);
+  uint8_t* p = pending_records_.data() + offset;
+  std::memset(p, 0, record_size);
+  std::memcpy(p, &record, sizeof(record));
+  p += sizeof(record);
+
+  // Image pointers are stored anchor-relative.
+  std::memcpy(p, machine_code, func_info.code_size.total);
+  for (const auto& relocation : relocations) {
+    uint64_t value;
+    std::memcpy(&value, p + relocation.code_offset, 8);
+    value -= image_anchor();
+    std::memcpy(p + relocation.code_offset, &value, 8);
+  }
+  p += code_size_aligned;
+
+  if (!relocations.empty()) {
+    std::memcpy(p, relocations.data(),
+                relocations.size() * sizeof(X64Relocation));
+    p += relocations.size() * sizeof(X64Relocation);
+  }
+  if (!source_map.empty()) {
+    std::memcpy(p, source_map.data(),
+                source_map.size() * sizeof(SourceMapEntry));
+  }
+  ++pending_record_count_;
+}
+
+}  // namespace x64
+}  // namespace backend
+}  // namespace cpu
+}  // namespace xe
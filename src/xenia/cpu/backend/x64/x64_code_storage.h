@@ -0,0 +1,118 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_CPU_BACKEND_X64_X64_CODE_STORAGE_H_
+#define XENIA_CPU_BACKEND_X64_X64_CODE_STORAGE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "xenia/base/mapped_memory.h"
+#include "xenia/cpu/function.h"
+
+namespace xe {
+namespace cpu {
+namespace backend {
+namespace x64 {
+
+class X64Backend;
+class X64Function;
+struct EmitFunctionInfo;
+
+// A host pointer baked into emitted machine code that must be patched when the
+// code is loaded by a later run of the process.
+struct X64Relocation {
+  enum class Type : uint32_t {
+    // 64-bit immediate pointing into the host executable image (functions or
+    // static tables). Stored relative to an anchor in the image so that ASLR
+    // only needs a single delta applied.
+    kImage64 = 0,
+  };
+  // Offset of the immediate from the start of the function's machine code.
+  uint32_t code_offset;
+  Type type;
+};
+
+// Persistent per-title store of generated guest machine code.
+// Functions emitted during a run are appended to
+// <storage_root>/cache/code/<title_id>.xcc on shutdown. On later runs the file
+// is memory-mapped and functions whose guest code is unchanged are placed
+// directly into the code cache, skipping the HIR pipeline entirely.
+//
+// Only code that references nothing but the executable image, the host code
+// emitted at backend initialization (thunks and constants, which land at fixed
+// offsets of the code cache) and guest memory is stored; the emitter flags
+// everything else (heap pointers, direct calls to other functions) as
+// unstorable.
+class X64CodeStorage {
+ public:
+  explicit X64CodeStorage(X64Backend* backend);
+  ~X64CodeStorage();
+
+  bool Initialize(const std::wstring& storage_root, uint32_t title_id,
+                  uint32_t image_base, uint32_t image_size);
+  // Writes any newly stored functions and releases the mapped file.
+  void Shutdown();
+
+  // Places stored machine code for the function into the code cache and sets
+  // it up as if it had just been assembled. Returns false if no valid stored
+  // copy exists and the function must be translated.
+  bool RestoreFunction(X64Function* function);
+  // Records freshly placed machine code to be written on shutdown.
+  void StoreFunction(GuestFunction* function, const void* machine_code,
+                     const EmitFunctionInfo& func_info,
+                     const std::vector<X64Relocation>& relocations,
+                     const std::vector<SourceMapEntry>& source_map);
+
+  size_t restored_function_count() const { return restored_function_count_; }
+  // Functions stored this run that will be written on shutdown.
+  size_t pending_function_count() {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    return pending_record_count_;
+  }
+
+ private:
+  struct FileHeader;
+  struct RecordHeader;
+
+  uint64_t CalculateConfigHash() const;
+  uint64_t HashGuestCode(uint32_t address, uint32_t end_address) const;
+
+  X64Backend* backend_ = nullptr;
+
+  std::wstring file_path_;
+  uint64_t config_hash_ = 0;
+  uint64_t module_hash_ = 0;
+  uint32_t host_code_size_ = 0;
+  bool file_valid_ = false;
+  size_t valid_file_size_ = 0;
+
+  // Records loaded from a previous run, by guest address. Points into
+  // mapped_file_.
+  std::unique_ptr<MappedMemory> mapped_file_;
+  std::unordered_map<uint32_t, const RecordHeader*> stored_records_;
+  std::atomic<size_t> restored_function_count_ = {0};
+
+  // Records generated this run, serialized and waiting to be appended.
+  std::mutex pending_mutex_;
+  std::vector<uint8_t> pending_records_;
+  size_t pending_record_count_ = 0;
+};
+
+}  // namespace x64
+}  // namespace backend
+}  // namespace cpu
+}  // namespace xe
+
+#endif  // XENIA_CPU_BACKEND_X64_X64_CODE_STORAGE_H_
@@ -98,8 +98,12 @@ bool X64Emitter::Emit(GuestFunction* function, HIRBuilder* builder,
   // Reset.
   debug_info_ = debug_info;
   debug_info_flags_ = debug_info_flags;
+  function_ = function;
   trace_data_ = &function->trace_data();
   source_map_arena_.Reset();
+  relocations_.clear();
+  // Trace data lives in this run's trace file.
+  storable_ = !(debug_info_flags & DebugInfoFlags::kDebugInfoAllTracing);
 
   // Fill the generator with code.
   EmitFunctionInfo func_info = {};
@@ -114,6 +118,13 @@ bool X64Emitter::Emit(GuestFunction* function, HIRBuilder* builder,
   // Stash source map.
   source_map_arena_.CloneContents(out_source_map);
 
+  // Keep a copy around for future runs, if enabled.
+  auto code_storage = backend_->code_storage();
+  if (code_storage && storable_) {
+    code_storage->StoreFunction(function, *out_code_address, func_info,
+                                relocations_, *out_source_map);
+  }
+
   return true;
 }
 
@@ -145,7 +156,7 @@ bool X64Emitter::Emit(HIRBuilder* builder, EmitFunctionInfo& func_info) {
 
   // Calculate stack size. We need to align things to their natural sizes.
   // This could be much better (sort by type/etc).
-  auto locals = builder->locals();
+  const auto& locals = builder->locals();
   size_t stack_offset = StackLayout::GUEST_STACK_SIZE;
   for (auto it = locals.begin(); it != locals.end(); ++it) {
     auto slot = *it;
@@ -157,6 +168,12 @@ bool X64Emitter::Emit(HIRBuilder* builder, EmitFunctionInfo& func_info) {
     stack_offset += type_size;
   }
 
+  if (debug_info_flags_ & DebugInfoFlags::kDebugInfoProfileFunctions) {
+    stack_offset = xe::align(stack_offset, static_cast<size_t>(8));
+    profile_stack_offset_ = stack_offset;
+    stack_offset += 16;
+  }
+
   // Ensure 16b alignment.
   stack_offset -= StackLayout::GUEST_STACK_SIZE;
   stack_offset = xe::align(stack_offset, static_cast<size_t>(16));
@@ -219,6 +236,12 @@ bool X64Emitter::Emit(HIRBuilder* builder, EmitFunctionInfo& func_info) {
     lock();
     bts(qword[low_address(&trace_header->function_thread_use)], rax);
   }
+  if (debug_info_flags_ & DebugInfoFlags::kDebugInfoProfileFunctions) {
+    EmitProfileFunctionEntry();
+  }
+  if (debug_info_flags_ & DebugInfoFlags::kDebugInfoTierUpCounter) {
+    EmitTierUpCheck();
+  }
 
   // Load membase.
   mov(GetMembaseReg(),
@@ -256,6 +279,9 @@ bool X64Emitter::Emit(HIRBuilder* builder, EmitFunctionInfo& func_info) {
   L(epilog_label);
   epilog_label_ = nullptr;
   EmitTraceUserCallReturn();
+  if (debug_info_flags_ & DebugInfoFlags::kDebugInfoProfileFunctions) {
+    EmitProfileFunctionExit(false);
+  }
   mov(GetContextReg(), qword[rsp + StackLayout::GUEST_CTX_HOME]);
 
   code_offsets.epilog = getSize();
@@ -315,6 +341,57 @@ void X64Emitter::EmitGetCurrentThreadId() {
 
 void X64Emitter::EmitTraceUserCallReturn() {}
 
+void X64Emitter::EmitProfileFunctionEntry() {
+  // Only rax, rcx and rdx are free here; the return address in rcx has been
+  // stored already.
+  auto counters = trace_data_->profile_counters();
+  mov(rcx, reinterpret_cast<uint64_t>(counters));
+  lock();
+  inc(qword[rcx + offsetof(FunctionTraceData::ProfileCounters, call_count)]);
+  mov(rax, qword[GetContextReg() +
+                 offsetof(ppc::PPCContext, profile_callee_cycles)]);
+  mov(qword[rsp + profile_stack_offset_ + 8], rax);
+  rdtsc();
+  shl(rdx, 32);
+  or_(rax, rdx);
+  mov(qword[rsp + profile_stack_offset_], rax);
+}
+
+void X64Emitter::EmitProfileFunctionExit(bool preserve_rax) {
+  size_t rsp_offset = 0;
+  if (preserve_rax) {
+    push(rax);
+    rsp_offset = 8;
+  }
+  rdtsc();
+  shl(rdx, 32);
+  or_(rax, rdx);
+  sub(rax, qword[rsp + rsp_offset + profile_stack_offset_]);
+  // rax = inclusive cycles. Whatever the thread's callee cycles grew by since
+  // entry was spent in callees; the rest is exclusive to us. Our caller then
+  // sees all of our inclusive time as callee time:
+  //   exclusive = entry_callee_cycles + inclusive - callee_cycles
+  //   callee_cycles += exclusive
+  mov(rcx, qword[rsp + rsp_offset + StackLayout::GUEST_CTX_HOME]);
+  mov(rdx, qword[rsp + rsp_offset + profile_stack_offset_ + 8]);
+  add(rdx, rax);
+  sub(rdx, qword[rcx + offsetof(ppc::PPCContext, profile_callee_cycles)]);
+  add(qword[rcx + offsetof(ppc::PPCContext, profile_callee_cycles)], rdx);
+  auto counters = trace_data_->profile_counters();
+  mov(rcx, reinterpret_cast<uint64_t>(counters));
+  lock();
+  add(qword[rcx + offsetof(FunctionTraceData::ProfileCounters,
+                           inclusive_cycles)],
+      rax);
+  lock();
+  add(qword[rcx + offsetof(FunctionTraceData::ProfileCounters,
+                           exclusive_cycles)],
+      rdx);
+  if (preserve_rax) {
+    pop(rax);
+  }
+}
+
 void X64Emitter::DebugBreak() {
   // TODO(benvanik): notify debugger.
   db(0xCC);
@@ -384,17 +461,42 @@ extern "C" uint64_t ResolveFunction(void* raw_context,
   auto fn =
       thread_state->processor()->ResolveFunction((uint32_t)target_address);
   assert_not_null(fn);
-  auto x64_fn = static_cast<X64Function*>(fn);
+  auto x64_fn = static_cast<X64Function*>(
+      static_cast<GuestFunction*>(fn)->installed_function());
   uint64_t addr = reinterpret_cast<uint64_t>(x64_fn->machine_code());
 
   return addr;
 }
 
+// Called by kWarmingUp code once its countdown runs out.
+uint64_t RequestOptimization(void* raw_context, uint64_t function_ptr) {
+  auto thread_state = *reinterpret_cast<ThreadState**>(raw_context);
+  thread_state->processor()->RequestOptimization(
+      reinterpret_cast<GuestFunction*>(function_ptr));
+  return 0;
+}
+
+void X64Emitter::EmitTierUpCheck() {
+  // Racy, but a lost decrement only delays the request a little.
+  Xbyak::Label skip;
+  mov(rax, reinterpret_cast<uint64_t>(function_->tier_up_countdown()));
+  dec(dword[rax]);
+  jnz(skip, CodeGenerator::T_NEAR);
+  CallNative(RequestOptimization, reinterpret_cast<uint64_t>(function_));
+  L(skip);
+  // Only optimized code is worth keeping.
+  MarkUnstorable();
+}
+
 void X64Emitter::Call(const hir::Instr* instr, GuestFunction* function) {
   assert_not_null(function);
-  auto fn = static_cast<X64Function*>(function);
   // Resolve address to the function to call and store in rax.
-  if (fn->machine_code()) {
+  // Direct calls bake in the callee's placement in this run, so they aren't
+  // used when code is being stored, nor to code about to be replaced. The
+  // tier is checked first as it's set after the code is installed.
+  bool warming_up = function->tier() == GuestFunction::Tier::kWarmingUp;
+  auto fn = static_cast<X64Function*>(function->installed_function());
+  if (!warming_up && fn->machine_code() && !backend_->code_storage()) {
     // TODO(benvanik): is it worth it to do this? It removes the need for
     // a ResolveFunction call, but makes the table less useful.
     assert_zero(uint64_t(fn->machine_code()) & 0xFFFFFFFF00000000);
@@ -416,6 +518,9 @@ void X64Emitter::Call(const hir::Instr* instr, GuestFunction* function) {
   if (instr->flags & hir::CALL_TAIL) {
     // Since we skip the prolog we need to mark the return here.
     EmitTraceUserCallReturn();
+    if (debug_info_flags_ & DebugInfoFlags::kDebugInfoProfileFunctions) {
+      EmitProfileFunctionExit(true);
+    }
 
     // Pass the callers return address over.
     mov(rcx, qword[rsp + StackLayout::GUEST_RET_ADDR]);
@@ -450,7 +555,7 @@ void X64Emitter::CallIndirect(const hir::Instr* instr,
     // Old-style resolve.
     // Not too important because indirection table is almost always available.
     mov(edx, reg.cvt32());
-    mov(rax, reinterpret_cast<uint64_t>(ResolveFunction));
+    MovImageAddress(rax, reinterpret_cast<void*>(ResolveFunction));
     mov(rcx, GetContextReg());
     call(rax);
   }
@@ -459,6 +564,9 @@ void X64Emitter::CallIndirect(const hir::Instr* instr,
   if (instr->flags & hir::CALL_TAIL) {
     // Since we skip the prolog we need to mark the return here.
     EmitTraceUserCallReturn();
+    if (debug_info_flags_ & DebugInfoFlags::kDebugInfoProfileFunctions) {
+      EmitProfileFunctionExit(true);
+    }
 
     // Pass the callers return address over.
     mov(rcx, qword[rsp + StackLayout::GUEST_RET_ADDR]);
@@ -496,9 +604,12 @@ void X64Emitter::CallExtern(const hir::Instr* instr, const Function* function) {
       // r9  = arg2
       auto thunk = backend()->guest_to_host_thunk();
       mov(rax, reinterpret_cast<uint64_t>(thunk));
-      mov(rcx, reinterpret_cast<uint64_t>(builtin_function->handler()));
+      MovImageAddress(rcx,
+                      reinterpret_cast<void*>(builtin_function->handler()));
       mov(rdx, reinterpret_cast<uint64_t>(builtin_function->arg0()));
       mov(r8, reinterpret_cast<uint64_t>(builtin_function->arg1()));
+      // Arguments are host objects.
+      MarkUnstorable();
       call(rax);
       // rax = host return
     }
@@ -512,7 +623,8 @@ void X64Emitter::CallExtern(const hir::Instr* instr, const Function* function) {
       // r9  = arg2
       auto thunk = backend()->guest_to_host_thunk();
       mov(rax, reinterpret_cast<uint64_t>(thunk));
-      mov(rcx, reinterpret_cast<uint64_t>(extern_function->extern_handler()));
+      MovImageAddress(
+          rcx, reinterpret_cast<void*>(extern_function->extern_handler()));
       mov(rdx,
           qword[GetContextReg() + offsetof(ppc::PPCContext, kernel_state)]);
       call(rax);
@@ -521,6 +633,7 @@ void X64Emitter::CallExtern(const hir::Instr* instr, const Function* function) {
   }
   if (undefined) {
     CallNative(UndefinedCallExtern, reinterpret_cast<uint64_t>(function));
+    MarkUnstorable();
   }
 }
 
@@ -547,11 +660,24 @@ void X64Emitter::CallNativeSafe(void* fn) {
   // r9  = arg2
   auto thunk = backend()->guest_to_host_thunk();
   mov(rax, reinterpret_cast<uint64_t>(thunk));
-  mov(rcx, reinterpret_cast<uint64_t>(fn));
+  MovImageAddress(rcx, fn);
   call(rax);
   // rax = host return
 }
 
+void X64Emitter::MovImageAddress(const Xbyak::Reg64& reg,
+                                 const void* address) {
+  // mov r64, imm64 (REX.W B8+r), encoded by hand as xbyak picks a shorter
+  // form for small values, which would leave no imm64 to patch.
+  db(0x48 | (reg.getIdx() >= 8 ? 0x01 : 0x00));
+  db(0xB8 | (reg.getIdx() & 7));
+  dq(reinterpret_cast<uint64_t>(address));
+  X64Relocation relocation;
+  relocation.code_offset = uint32_t(getSize() - sizeof(uint64_t));
+  relocation.type = X64Relocation::Type::kImage64;
+  relocations_.push_back(relocation);
+}
+
 void X64Emitter::SetReturnAddress(uint64_t value) {
   mov(rax, value);
   mov(qword[rsp + StackLayout::GUEST_CALL_RET_ADDR], rax);
@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "xenia/base/arena.h"
+#include "xenia/cpu/backend/x64/x64_code_storage.h"
 #include "xenia/cpu/function.h"
 #include "xenia/cpu/function_trace_data.h"
 #include "xenia/cpu/hir/hir_builder.h"
@@ -196,6 +197,14 @@ class X64Emitter : public Xbyak::CodeGenerator {
   void CallNativeSafe(void* fn);
   void SetReturnAddress(uint64_t value);
 
+  // Loads the address of static host code or data (anything within the
+  // executable image) into reg, recording a relocation so that the function
+  // can be persisted by X64CodeStorage.
+  void MovImageAddress(const Xbyak::Reg64& reg, const void* address);
+  // Flags the function as referencing host state that won't exist in a later
+  // run (heap pointers, other functions' code, etc) so it is never persisted.
+  void MarkUnstorable() { storable_ = false; }
+
   Xbyak::Reg64 GetNativeParam(uint32_t param);
 
   Xbyak::Reg64 GetContextReg();
@@ -232,6 +241,11 @@ class X64Emitter : public Xbyak::CodeGenerator {
   bool Emit(hir::HIRBuilder* builder, EmitFunctionInfo& func_info);
   void EmitGetCurrentThreadId();
   void EmitTraceUserCallReturn();
+  void EmitProfileFunctionEntry();
+  // Must be emitted on every path leaving the function. rax is clobbered
+  // unless preserve_rax is set (for tail calls holding their target in it).
+  void EmitProfileFunctionExit(bool preserve_rax);
+  void EmitTierUpCheck();
 
  protected:
   Processor* processor_ = nullptr;
@@ -247,10 +261,18 @@ class X64Emitter : public Xbyak::CodeGenerator {
 
   FunctionDebugInfo* debug_info_ = nullptr;
   uint32_t debug_info_flags_ = 0;
+  GuestFunction* function_ = nullptr;
   FunctionTraceData* trace_data_ = nullptr;
   Arena source_map_arena_;
 
+  // Host pointers baked into the current function, for X64CodeStorage.
+  std::vector<X64Relocation> relocations_;
+  bool storable_ = true;
+
   size_t stack_size_ = 0;
+  // Stack offset of the entry timestamp and the thread's callee cycles at
+  // entry, when profiling.
+  size_t profile_stack_offset_ = 0;
 
   static const uint32_t gpr_reg_map_[GPR_COUNT];
   static const uint32_t xmm_reg_map_[XMM_COUNT];
@@ -558,6 +558,8 @@ struct LOAD_MMIO_I32
     auto read_address = uint32_t(i.src2.value);
     e.mov(e.GetNativeParam(0), uint64_t(mmio_range->callback_context));
     e.mov(e.GetNativeParam(1).cvt32(), read_address);
+    // The callback context is a host object.
+    e.MarkUnstorable();
     e.CallNativeSafe(reinterpret_cast<void*>(mmio_range->read));
     e.bswap(e.eax);
     e.mov(i.dest, e.eax);
@@ -583,6 +585,8 @@ struct STORE_MMIO_I32
     auto write_address = uint32_t(i.src2.value);
     e.mov(e.GetNativeParam(0), uint64_t(mmio_range->callback_context));
     e.mov(e.GetNativeParam(1).cvt32(), write_address);
+    // The callback context is a host object.
+    e.MarkUnstorable();
     if (i.src3.is_constant) {
       e.mov(e.GetNativeParam(2).cvt32(), xe::byte_swap(i.src3.constant()));
     } else {
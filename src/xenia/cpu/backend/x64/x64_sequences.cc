@@ -66,6 +66,7 @@ struct COMMENT : Sequence<COMMENT, I<OPCODE_COMMENT, VoidOp, OffsetOp>> {
       auto str_copy = strdup(str);
       e.mov(e.rdx, reinterpret_cast<uint64_t>(str_copy));
       e.CallNative(reinterpret_cast<void*>(TraceString));
+      e.MarkUnstorable();
     }
   }
 };
@@ -447,6 +448,8 @@ struct LOAD_CLOCK : Sequence<LOAD_CLOCK, I<OPCODE_LOAD_CLOCK, I64Op>> {
     // overhead.
     if (cvars::clock_no_scaling && cvars::clock_source_raw) {
       auto ratio = Clock::guest_tick_ratio();
+      // The ratio depends on this run's host clock calibration.
+      e.MarkUnstorable();
       // The 360 CPU is an in-order CPU, AMD64 usually isn't. Without
       // mfence/lfence magic the rdtsc instruction can be executed sooner or
       // later in the cache window. Since it's resolution however is much higher
@@ -3138,7 +3141,7 @@ struct SET_ROUNDING_MODE_I32
   static void Emit(X64Emitter& e, const EmitArgType& i) {
     e.mov(e.rcx, i.src1);
     e.and_(e.rcx, 0x7);
-    e.mov(e.rax, uintptr_t(mxcsr_table));
+    e.MovImageAddress(e.rax, mxcsr_table);
     e.vldmxcsr(e.ptr[e.rax + e.rcx * 4]);
   }
 };
@@ -0,0 +1,168 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/background_compiler.h"
+
+#include <algorithm>
+
+#include "xenia/base/logging.h"
+#include "xenia/base/profiling.h"
+#include "xenia/cpu/processor.h"
+
+namespace xe {
+namespace cpu {
+
+namespace {
+// Workers resolve functions through the processor like any other thread; this
+// keeps them from boosting each other when they wait on the same function.
+thread_local bool is_worker_thread_ = false;
+}  // namespace
+
+BackgroundCompiler::BackgroundCompiler(Processor* processor,
+                                       uint32_t thread_count)
+    : processor_(processor) {
+  for (uint32_t i = 0; i < thread_count; ++i) {
+    auto worker = std::make_unique<Worker>();
+    auto worker_ptr = worker.get();
+    xe::threading::Thread::CreationParameters params;
+    params.initial_priority = xe::threading::ThreadPriority::kLowest;
+    worker->thread = xe::threading::Thread::Create(
+        params, [this, worker_ptr]() { WorkerThread(worker_ptr); });
+    if (!worker->thread) {
+      XELOGE("Unable to create background compiler thread");
+      break;
+    }
+    worker->thread->set_name("Background Compiler");
+    workers_.push_back(std::move(worker));
+  }
+}
+
+BackgroundCompiler::~BackgroundCompiler() { Shutdown(); }
+
+void BackgroundCompiler::Enqueue(uint32_t address) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (shutting_down_ || !queued_addresses_.insert(address).second) {
+      return;
+    }
+    queue_.push_back(address);
+  }
+  queue_cond_.notify_one();
+}
+
+void BackgroundCompiler::EnqueueOptimization(GuestFunction* function) {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    // The countdown is racy, so a function may ask more than once.
+    if (shutting_down_ || !queued_optimizations_.insert(function).second) {
+      return;
+    }
+    optimization_queue_.push_back(function);
+  }
+  queue_cond_.notify_one();
+}
+
+void BackgroundCompiler::Boost(uint32_t address) {
+  if (is_worker_thread_) {
+    return;
+  }
+  for (auto& worker : workers_) {
+    if (worker->address.load(std::memory_order_acquire) != address) {
+      continue;
+    }
+    // The worker may already have moved on; at worst its next function runs
+    // boosted too.
+    if (!worker->boosted.exchange(true, std::memory_order_acq_rel)) {
+      int32_t priority = xe::threading::ThreadPriority::kNormal;
+      auto current_thread = xe::threading::Thread::GetCurrentThread();
+      if (current_thread) {
+        priority = std::max(priority, current_thread->priority());
+      }
+      worker->thread->set_priority(priority);
+    }
+  }
+}
+
+void BackgroundCompiler::Shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (shutting_down_) {
+      return;
+    }
+    shutting_down_ = true;
+    queue_.clear();
+    optimization_queue_.clear();
+  }
+  queue_cond_.notify_all();
+  {
+    // Waiting on the threads themselves isn't supported everywhere, so they
+    // check out as they exit instead.
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    exited_cond_.wait(lock,
+                      [this]() { return exited_count_ == workers_.size(); });
+  }
+  workers_.clear();
+  XELOGCPU("Background compiler resolved %zu functions, optimized %zu",
+           size_t(compiled_function_count_),
+           size_t(optimized_function_count_));
+}
+
+void BackgroundCompiler::WorkerThread(Worker* worker) {
+  is_worker_thread_ = true;
+  while (true) {
+    uint32_t address = 0;
+    GuestFunction* function = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cond_.wait(lock, [this]() {
+        return shutting_down_ || !queue_.empty() ||
+               !optimization_queue_.empty();
+      });
+      if (shutting_down_) {
+        ++exited_count_;
+        exited_cond_.notify_all();
+        return;
+      }
+      // Nothing waits on optimizations, so they're never boosted.
+      if (!optimization_queue_.empty()) {
+        function = optimization_queue_.front();
+        optimization_queue_.pop_front();
+      } else {
+        address = queue_.front();
+        queue_.pop_front();
+        worker->address.store(address, std::memory_order_release);
+      }
+    }
+
+    if (function) {
+      SCOPE_profile_cpu_i("cpu", "BackgroundCompiler::OptimizeFunction");
+      if (processor_->OptimizeFunction(function)) {
+        ++optimized_function_count_;
+      }
+      continue;
+    }
+
+    {
+      SCOPE_profile_cpu_i("cpu", "BackgroundCompiler::WorkerThread");
+      // Already resolved functions return immediately and those being
+      // resolved elsewhere block until done, so there's no need to check.
+      if (processor_->ResolveFunction(address)) {
+        ++compiled_function_count_;
+      }
+    }
+
+    worker->address.store(0, std::memory_order_release);
+    if (worker->boosted.exchange(false, std::memory_order_acq_rel)) {
+      worker->thread->set_priority(xe::threading::ThreadPriority::kLowest);
+    }
+  }
+}
+
+}  // namespace cpu
+}  // namespace xe
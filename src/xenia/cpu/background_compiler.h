@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_CPU_BACKGROUND_COMPILER_H_
+#define XENIA_CPU_BACKGROUND_COMPILER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "xenia/base/threading.h"
+
+namespace xe {
+namespace cpu {
+
+class GuestFunction;
+class Processor;
+
+// Compiles guest functions on a pool of low priority host threads ahead of
+// their first call, so that guest threads find them already resolved in the
+// entry table instead of translating them on their own critical path.
+//
+// Work is seeded with the functions a module declares at load (imports,
+// save/restore helpers, the entry point) and grows as the scanner discovers
+// call targets in each function translated, by either the pool or a guest
+// thread. Functions a guest thread demands before the pool gets to them are
+// simply translated by that thread as usual; if a guest thread has to wait on
+// a function a worker is in the middle of translating, that worker's priority
+// is raised until it finishes.
+//
+// With tiered compilation, hot functions are also queued for recompilation
+// with more optimizations. These are picked up ahead of any other work.
+class BackgroundCompiler {
+ public:
+  BackgroundCompiler(Processor* processor, uint32_t thread_count);
+  ~BackgroundCompiler();
+
+  // Queues the function at the given guest address for translation, unless it
+  // has been queued before.
+  void Enqueue(uint32_t address);
+  // Queues a function for Processor::OptimizeFunction.
+  void EnqueueOptimization(GuestFunction* function);
+  // Called when a thread is about to block on the given address. If a worker
+  // is translating it, the worker is boosted to the caller's priority.
+  void Boost(uint32_t address);
+
+  // Drops all queued work and joins the worker threads. Functions being
+  // translated are completed first.
+  void Shutdown();
+
+  size_t compiled_function_count() const { return compiled_function_count_; }
+  size_t optimized_function_count() const {
+    return optimized_function_count_;
+  }
+
+ private:
+  struct Worker {
+    std::unique_ptr<xe::threading::Thread> thread;
+    // Guest address being translated, or 0 if idle.
+    std::atomic<uint32_t> address = {0};
+    std::atomic<bool> boosted = {false};
+  };
+
+  void WorkerThread(Worker* worker);
+
+  Processor* processor_ = nullptr;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cond_;
+  std::deque<uint32_t> queue_;
+  // Every address ever queued, so each function is only attempted once.
+  std::unordered_set<uint32_t> queued_addresses_;
+  std::deque<GuestFunction*> optimization_queue_;
+  std::unordered_set<GuestFunction*> queued_optimizations_;
+  bool shutting_down_ = false;
+  std::condition_variable exited_cond_;
+  size_t exited_count_ = 0;
+
+  std::atomic<size_t> compiled_function_count_ = {0};
+  std::atomic<size_t> optimized_function_count_ = {0};
+};
+
+}  // namespace cpu
+}  // namespace xe
+
+#endif  // XENIA_CPU_BACKGROUND_COMPILER_H_
@@ -75,21 +75,24 @@ void DataFlowAnalysisPass::AnalyzeFlow(HIRBuilder* builder,
   auto value_map = reinterpret_cast<Value**>(
       arena->Alloc(sizeof(Value*) * max_value_estimate));
 
-  // Allocate incoming bitvectors for use by blocks. We don't need outgoing
+  // Prepare incoming bitvectors for use by blocks. We don't need outgoing
   // because they are only used during the block iteration.
   // Mapped by block ordinal.
-  // TODO(benvanik): cache this list, grow as needed, etc.
-  auto incoming_bitvectors =
-      (llvm::BitVector**)arena->Alloc(sizeof(llvm::BitVector*) * block_count);
+  while (incoming_bitvectors_.size() < block_count) {
+    incoming_bitvectors_.push_back(std::make_unique<llvm::BitVector>());
+  }
   for (auto n = 0u; n < block_count; n++) {
-    incoming_bitvectors[n] = new llvm::BitVector(max_value_estimate);
+    incoming_bitvectors_[n]->resize(max_value_estimate);
+    incoming_bitvectors_[n]->reset();
   }
+  auto& outgoing_values = outgoing_values_;
+  outgoing_values.resize(max_value_estimate);
 
   // Walk blocks in reverse and calculate incoming/outgoing values.
   auto block = builder->last_block();
   while (block) {
     // Allocate bitsets based on max value number.
-    block->incoming_values = incoming_bitvectors[block->ordinal];
+    block->incoming_values = incoming_bitvectors_[block->ordinal].get();
     auto& incoming_values = *block->incoming_values;
 
     // Walk instructions and gather up incoming values.
@@ -117,7 +120,7 @@ void DataFlowAnalysisPass::AnalyzeFlow(HIRBuilder* builder,
 
     // Add all successor incoming values to our outgoing, as we need to
     // pass them through.
-    llvm::BitVector outgoing_values(max_value_estimate);
+    outgoing_values.reset();
     auto outgoing_edge = block->outgoing_edge_head;
     while (outgoing_edge) {
       if (outgoing_edge->dest->ordinal > block->ordinal) {
@@ -201,11 +204,6 @@ void DataFlowAnalysisPass::AnalyzeFlow(HIRBuilder* builder,
 
     block = block->prev;
   }
-
-  // Cleanup bitvectors.
-  for (auto n = 0u; n < block_count; n++) {
-    delete incoming_bitvectors[n];
-  }
 }
 
 }  // namespace passes
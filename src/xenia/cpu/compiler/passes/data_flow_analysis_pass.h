@@ -10,8 +10,22 @@
 #ifndef XENIA_CPU_COMPILER_PASSES_DATA_FLOW_ANALYSIS_PASS_H_
 #define XENIA_CPU_COMPILER_PASSES_DATA_FLOW_ANALYSIS_PASS_H_
 
+#include <memory>
+#include <vector>
+
+#include "xenia/base/platform.h"
 #include "xenia/cpu/compiler/compiler_pass.h"
 
+#if XE_COMPILER_MSVC
+#pragma warning(push)
+#pragma warning(disable : 4244)
+#pragma warning(disable : 4267)
+#include <llvm/ADT/BitVector.h>
+#pragma warning(pop)
+#else
+#include <llvm/ADT/BitVector.h>
+#endif  // XE_COMPILER_MSVC
+
 namespace xe {
 namespace cpu {
 namespace compiler {
@@ -27,6 +41,11 @@ class DataFlowAnalysisPass : public CompilerPass {
  private:
   uint32_t LinearizeBlocks(hir::HIRBuilder* builder);
   void AnalyzeFlow(hir::HIRBuilder* builder, uint32_t block_count);
+
+  // Kept across runs and only ever grown so that steady-state compilation
+  // doesn't allocate. Indexed by block ordinal.
+  std::vector<std::unique_ptr<llvm::BitVector>> incoming_bitvectors_;
+  llvm::BitVector outgoing_values_;
 };
 
 }  // namespace passes
@@ -48,6 +48,8 @@ RegisterAllocationPass::RegisterAllocationPass(const MachineInfo* machine_info)
     usage_sets_.all_sets[n] = usage_set;
     usage_set->count = mi_set.count;
     usage_set->set = &mi_set;
+    // Each entry holds a register, so the list never outgrows the set.
+    usage_set->upcoming_uses.reserve(mi_set.count);
     if (mi_set.types & MachineInfo::RegisterSet::INT_TYPES) {
       usage_sets_.int_set = usage_set;
     }
@@ -77,6 +79,9 @@ bool RegisterAllocationPass::Run(HIRBuilder* builder) {
   // Really, it'd just be nice to have someone who knew what they
   // were doing lower SSA and do this right.
 
+  stats_ = Stats();
+  spill_slots_.clear();
+
   uint16_t block_ordinal = 0;
   uint32_t instr_ordinal = 0;
   auto block = builder->first_block();
@@ -118,10 +123,8 @@ bool RegisterAllocationPass::Run(HIRBuilder* builder) {
           // Pull off preferred register. We will try to reuse this for the
           // dest.
           // NOTE: set may be null if this is a store local.
-          if (preferred_reg.set) {
-            has_preferred_reg = true;
-            preferred_reg = instr->src1.value->reg;
-          }
+          preferred_reg = instr->src1.value->reg;
+          has_preferred_reg = preferred_reg.set != nullptr;
         }
       }
 
@@ -203,6 +206,9 @@ void RegisterAllocationPass::PrepareBlockState() {
       usage_set->upcoming_uses.clear();
     }
   }
+  for (auto& spill_slot : spill_slots_) {
+    spill_slot.free_ordinal = 0;
+  }
   DumpUsage("PrepareBlockState");
 }
 
@@ -220,6 +226,7 @@ void RegisterAllocationPass::AdvanceUses(Instr* instr) {
         // This comes up from instructions where the dest is never used,
         // like the ATOMIC ops.
         MarkRegAvailable(upcoming_use.value->reg);
+        ReleaseSpillSlot(upcoming_use.value->local_slot, instr->ordinal);
         upcoming_uses.erase(upcoming_uses.begin() + j);
         // i remains the same.
         continue;
@@ -233,6 +240,7 @@ void RegisterAllocationPass::AdvanceUses(Instr* instr) {
       if (!upcoming_use.use->next) {
         // Last use of the value. We can retire it now.
         MarkRegAvailable(upcoming_use.value->reg);
+        ReleaseSpillSlot(upcoming_use.value->local_slot, instr->ordinal);
         upcoming_uses.erase(upcoming_uses.begin() + j);
         // i remains the same.
         continue;
@@ -364,75 +372,89 @@ bool RegisterAllocationPass::SpillOneRegister(HIRBuilder* builder, Block* block,
   // This makes it easier down below.
   auto new_head_use = next_use;
 
-  // Allocate local.
-  if (spill_value->local_slot) {
-    // Value is already assigned a slot. Since we allocate in order and this is
-    // all SSA we know the stored value will be exactly what we want. Yay,
-    // we can prevent the redundant store!
-    // In fact, we may even want to pin this spilled value so that we always
-    // use the spilled value and prevent the need for more locals.
+  Value* new_value;
+  if (!spill_value->local_slot && IsRematerializable(spill_value->def)) {
+    // Cheaper to compute the value again right before the next use than to
+    // round-trip it through the stack.
+    auto remat = builder->CloneInstr(spill_value->def);
+    remat->MoveBefore(next_use->instr);
+    new_value = remat->dest;
+    ++stats_.remat_count;
   } else {
-    // Allocate a local slot.
-    spill_value->local_slot = builder->AllocLocal(spill_value->type);
-
-    // Add store.
-    builder->StoreLocal(spill_value->local_slot, spill_value);
-    auto spill_store = builder->last_instr();
-    auto spill_store_use = spill_store->src2_use;
-    assert_null(spill_store_use->prev);
-    if (prev_use && prev_use->instr->opcode->flags & OPCODE_FLAG_PAIRED_PREV) {
-      // Instruction is paired. This is bad. We will insert the spill after the
-      // paired instruction.
-      assert_not_null(prev_use->instr->next);
-      spill_store->MoveBefore(prev_use->instr->next);
-
-      // Update last use.
-      spill_value->last_use = spill_store;
-    } else if (prev_use) {
-      // We insert the store immediately before the previous use.
-      // If we were smarter we could then re-run allocation and reuse the
-      // register
-      // once dropped.
-      spill_store->MoveBefore(prev_use->instr);
-
-      // Update last use.
-      spill_value->last_use = prev_use->instr;
+    // Allocate local.
+    if (spill_value->local_slot) {
+      // Value is already assigned a slot. Since we allocate in order and this
+      // is all SSA we know the stored value will be exactly what we want. Yay,
+      // we can prevent the redundant store!
     } else {
-      // This is the first use, so the only thing we have is the define.
-      // Move the store to right after that.
-      spill_store->MoveBefore(spill_value->def->next);
+      // The store goes no earlier than the previous use (or the define), so
+      // any slot whose value retired by then is safe to overwrite.
+      uint32_t store_ordinal =
+          prev_use ? prev_use->instr->ordinal : spill_value->def->ordinal;
+      spill_value->local_slot =
+          AllocSpillSlot(builder, spill_value->type, store_ordinal);
+
+      // Add store.
+      builder->StoreLocal(spill_value->local_slot, spill_value);
+      auto spill_store = builder->last_instr();
+      auto spill_store_use = spill_store->src2_use;
+      assert_null(spill_store_use->prev);
+      if (prev_use &&
+          prev_use->instr->opcode->flags & OPCODE_FLAG_PAIRED_PREV) {
+        // Instruction is paired. This is bad. We will insert the spill after
+        // the paired instruction.
+        assert_not_null(prev_use->instr->next);
+        spill_store->MoveBefore(prev_use->instr->next);
+
+        // Update last use.
+        spill_value->last_use = spill_store;
+      } else if (prev_use) {
+        // We insert the store immediately before the previous use.
+        // If we were smarter we could then re-run allocation and reuse the
+        // register once dropped.
+        spill_store->MoveBefore(prev_use->instr);
+
+        // Update last use.
+        spill_value->last_use = prev_use->instr;
+      } else {
+        // This is the first use, so the only thing we have is the define.
+        // Move the store to right after that.
+        spill_store->MoveBefore(spill_value->def->next);
 
-      // Update last use.
-      spill_value->last_use = spill_store;
+        // Update last use.
+        spill_value->last_use = spill_store;
+      }
+      ++stats_.spill_count;
     }
-  }
 
 #if ASSERT_NO_CYCLES
-  builder->AssertNoCycles();
-  spill_value->def->block->AssertNoCycles();
+    builder->AssertNoCycles();
+    spill_value->def->block->AssertNoCycles();
 #endif  // ASSERT_NO_CYCLES
 
-  // Add load.
-  // Inserted immediately before the next use. Since by definition the next
-  // use is after the instruction requesting the spill we know we haven't
-  // done allocation for that code yet and can let that be handled
-  // automatically when we get to it.
-  auto new_value = builder->LoadLocal(spill_value->local_slot);
-  auto spill_load = builder->last_instr();
-  spill_load->MoveBefore(next_use->instr);
-  // Note: implicit first use added.
+    // Add load.
+    // Inserted immediately before the next use. Since by definition the next
+    // use is after the instruction requesting the spill we know we haven't
+    // done allocation for that code yet and can let that be handled
+    // automatically when we get to it.
+    new_value = builder->LoadLocal(spill_value->local_slot);
+    auto spill_load = builder->last_instr();
+    spill_load->MoveBefore(next_use->instr);
+    // Note: implicit first use added.
+    ++stats_.reload_count;
+
+    // Set the local slot of the new value to our existing one. This way we
+    // will reuse that same memory if needed.
+    new_value->local_slot = spill_value->local_slot;
+  }
 
 #if ASSERT_NO_CYCLES
   builder->AssertNoCycles();
   spill_value->def->block->AssertNoCycles();
 #endif  // ASSERT_NO_CYCLES
 
-  // Set the local slot of the new value to our existing one. This way we will
-  // reuse that same memory if needed.
-  new_value->local_slot = spill_value->local_slot;
-
   // Rename all future uses of the SSA value to the new value as loaded
-  // from the local.
+  // from the local (or recomputed).
   // We can quickly do this by walking the use list. Because the list is
   // already sorted we know we are going to end up with a sorted list.
   auto walk_use = new_head_use;
@@ -482,6 +504,68 @@ RegisterAllocationPass::RegisterSetForValue(const Value* value) {
   }
 }
 
+bool RegisterAllocationPass::IsRematerializable(const Instr* def) {
+  // Only side-effect free instructions operating purely on constants can be
+  // replayed later on; anything reading context, locals or memory may see a
+  // different value by the time of the next use.
+  if (def->opcode->flags &
+      (OPCODE_FLAG_BRANCH | OPCODE_FLAG_MEMORY | OPCODE_FLAG_VOLATILE |
+       OPCODE_FLAG_PAIRED_PREV)) {
+    return false;
+  }
+  if (def->next && def->next->opcode->flags & OPCODE_FLAG_PAIRED_PREV) {
+    // The following instruction consumes flags set by this one.
+    return false;
+  }
+  uint32_t signature = def->opcode->signature;
+  const OpcodeSignatureType src_types[] = {
+      GET_OPCODE_SIG_TYPE_SRC1(signature),
+      GET_OPCODE_SIG_TYPE_SRC2(signature),
+      GET_OPCODE_SIG_TYPE_SRC3(signature),
+  };
+  const Value* src_values[] = {def->src1.value, def->src2.value,
+                               def->src3.value};
+  bool has_operands = false;
+  for (size_t i = 0; i < xe::countof(src_types); ++i) {
+    if (src_types[i] == OPCODE_SIG_TYPE_X) {
+      continue;
+    }
+    if (src_types[i] != OPCODE_SIG_TYPE_V || !src_values[i]->IsConstant()) {
+      return false;
+    }
+    has_operands = true;
+  }
+  return has_operands;
+}
+
+Value* RegisterAllocationPass::AllocSpillSlot(HIRBuilder* builder,
+                                              TypeName type,
+                                              uint32_t store_ordinal) {
+  for (auto& spill_slot : spill_slots_) {
+    if (spill_slot.local->type == type &&
+        spill_slot.free_ordinal <= store_ordinal) {
+      spill_slot.free_ordinal = UINT32_MAX;
+      return spill_slot.local;
+    }
+  }
+  auto local = builder->AllocLocal(type);
+  spill_slots_.push_back({local, UINT32_MAX});
+  ++stats_.spill_slot_count;
+  return local;
+}
+
+void RegisterAllocationPass::ReleaseSpillSlot(Value* local, uint32_t ordinal) {
+  if (!local) {
+    return;
+  }
+  for (auto& spill_slot : spill_slots_) {
+    if (spill_slot.local == local) {
+      spill_slot.free_ordinal = ordinal;
+      return;
+    }
+  }
+}
+
 namespace {
 int CompareValueUse(const Value::Use* a, const Value::Use* b) {
   return a->instr->ordinal - b->instr->ordinal;
@@ -30,6 +30,19 @@ class RegisterAllocationPass : public CompilerPass {
 
   bool Run(hir::HIRBuilder* builder) override;
 
+  // Counters for the last function run through the pass.
+  struct Stats {
+    // Values stored to a spill slot.
+    uint32_t spill_count = 0;
+    // Values loaded back from a spill slot.
+    uint32_t reload_count = 0;
+    // Spilled values recomputed at their next use instead of reloaded.
+    uint32_t remat_count = 0;
+    // Distinct stack slots the function needed for spills.
+    uint32_t spill_slot_count = 0;
+  };
+  const Stats& stats() const { return stats_; }
+
  private:
   // TODO(benvanik): rewrite all this set shit -- too much indirection, the
   // complexity is not needed.
@@ -69,6 +82,11 @@ class RegisterAllocationPass : public CompilerPass {
 
   void SortUsageList(hir::Value* value);
 
+  bool IsRematerializable(const hir::Instr* def);
+  hir::Value* AllocSpillSlot(hir::HIRBuilder* builder, hir::TypeName type,
+                             uint32_t store_ordinal);
+  void ReleaseSpillSlot(hir::Value* local, uint32_t ordinal);
+
  private:
   struct {
     RegisterSetUsage* int_set = nullptr;
@@ -76,6 +94,19 @@ class RegisterAllocationPass : public CompilerPass {
     RegisterSetUsage* vec_set = nullptr;
     RegisterSetUsage* all_sets[3];
   } usage_sets_;
+
+  // Locals allocated for spills. Spilled values never outlive their block, so
+  // slots are shared by all blocks and reused within a block once the value
+  // last loaded from them has retired.
+  struct SpillSlot {
+    hir::Value* local;
+    // Ordinal of the instruction retiring the value held in the slot; a new
+    // store may be placed at or after it. UINT32_MAX while held.
+    uint32_t free_ordinal;
+  };
+  std::vector<SpillSlot> spill_slots_;
+
+  Stats stats_;
 };
 
 }  // namespace passes
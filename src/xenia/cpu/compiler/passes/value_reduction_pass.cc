@@ -62,7 +62,8 @@ void ValueReductionPass::ComputeLastUse(Value* value) {
 bool ValueReductionPass::Run(HIRBuilder* builder) {
   // Walk each block and reuse variable ordinals as much as possible.
 
-  llvm::BitVector ordinals(builder->max_value_ordinal());
+  auto& ordinals = ordinals_;
+  ordinals.resize(builder->max_value_ordinal());
 
   auto block = builder->first_block();
   while (block) {
@@ -37,6 +37,50 @@ DEFINE_bool(
 
 DEFINE_bool(validate_hir, false,
             "Perform validation checks on the HIR during compilation.", "CPU");
+DEFINE_bool(log_register_allocation_stats, false,
+            "Log spill, reload and rematerialization counts for each "
+            "function compiled.",
+            "CPU");
+
+DEFINE_int32(inline_max_instructions, 24,
+             "Largest guest function, in instructions, that is inlined into "
+             "its callers instead of called. Only functions without branches "
+             "are inlined. 0 to disable.",
+             "CPU");
+
+DEFINE_bool(store_generated_code, false,
+            "Store generated machine code for titles in the storage root and "
+            "reuse it on later launches instead of recompiling.",
+            "CPU");
+
+DEFINE_int32(background_compile_threads, 0,
+             "Number of threads translating guest functions ahead of their "
+             "first call. -1 to calculate automatically (half of logical CPU "
+             "cores), 0 to only translate functions when they are called.",
+             "CPU");
+
+DEFINE_bool(tiered_compilation, false,
+            "Translate functions quickly at first and recompile those called "
+            "often with more optimizations on a background compiler thread.",
+            "CPU");
+DEFINE_int32(tier_up_call_count, 1000,
+             "Number of calls after which a function is recompiled with more "
+             "optimizations when --tiered_compilation is enabled.",
+             "CPU");
+
+DEFINE_bool(profile_functions, false,
+            "Count calls and time spent in each guest function, and report "
+            "the functions taking the most time on exit.",
+            "CPU");
+DEFINE_int32(profile_functions_report_count, 25,
+             "Number of functions listed in function profile reports.", "CPU");
+DEFINE_int32(profile_functions_report_interval, 0,
+             "Seconds between function profile reports while running. 0 to "
+             "only report on exit.",
+             "CPU");
+DEFINE_string(profile_functions_report_path, "",
+              "Also write function profile reports to this file as JSON.",
+              "CPU");
 
 // Breakpoints:
 DEFINE_uint64(break_on_instruction, 0,
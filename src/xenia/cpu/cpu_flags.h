@@ -25,6 +25,19 @@ DECLARE_bool(trace_function_data);
 DECLARE_bool(disable_global_lock);
 
 DECLARE_bool(validate_hir);
+DECLARE_bool(log_register_allocation_stats);
+DECLARE_int32(inline_max_instructions);
+
+DECLARE_bool(store_generated_code);
+DECLARE_int32(background_compile_threads);
+
+DECLARE_bool(tiered_compilation);
+DECLARE_int32(tier_up_call_count);
+
+DECLARE_bool(profile_functions);
+DECLARE_int32(profile_functions_report_count);
+DECLARE_int32(profile_functions_report_interval);
+DECLARE_string(profile_functions_report_path);
 
 DECLARE_uint64(break_on_instruction);
 DECLARE_int32(break_condition_gpr);
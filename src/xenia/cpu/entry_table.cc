@@ -9,29 +9,71 @@
 
 #include "xenia/cpu/entry_table.h"
 
+#include "xenia/base/assert.h"
 #include "xenia/base/profiling.h"
-#include "xenia/base/threading.h"
 
 namespace xe {
 namespace cpu {
 
-EntryTable::EntryTable() = default;
+// Must be a power of two. Large enough that most titles never grow.
+constexpr uint32_t kInitialTableCapacity = 16 * 1024;
+
+EntryTable::Table::Table(uint32_t capacity)
+    : mask(capacity - 1), slots(new std::atomic<Entry*>[capacity]) {
+  assert_true((capacity & mask) == 0);
+  for (uint32_t i = 0; i < capacity; ++i) {
+    slots[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+EntryTable::EntryTable() {
+  table_.store(new Table(kInitialTableCapacity), std::memory_order_release);
+}
 
 EntryTable::~EntryTable() {
-  auto global_lock = global_critical_region_.Acquire();
-  for (auto it : map_) {
-    Entry* entry = it.second;
-    delete entry;
+  std::lock_guard<std::mutex> lock(insert_mutex_);
+  Table* table = table_.load(std::memory_order_acquire);
+  for (uint32_t i = 0; i <= table->mask; ++i) {
+    delete table->slots[i].load(std::memory_order_relaxed);
+  }
+  delete table;
+  table_.store(nullptr, std::memory_order_release);
+}
+
+uint32_t EntryTable::HashAddress(uint32_t address) {
+  // Functions are 4b aligned; mix the remaining bits so that densely packed
+  // addresses don't cluster in linear probing.
+  uint32_t hash = (address >> 2) * 0x9E3779B1u;
+  return hash ^ (hash >> 15);
+}
+
+Entry* EntryTable::Find(const Table* table, uint32_t address) {
+  // Load factor is kept under 1/2 so probe chains are short and bounded.
+  for (uint32_t i = HashAddress(address);; ++i) {
+    Entry* entry =
+        table->slots[i & table->mask].load(std::memory_order_acquire);
+    if (!entry || entry->address == address) {
+      return entry;
+    }
+  }
+}
+
+void EntryTable::Insert(Table* table, Entry* entry) {
+  for (uint32_t i = HashAddress(entry->address);; ++i) {
+    auto& slot = table->slots[i & table->mask];
+    if (!slot.load(std::memory_order_relaxed)) {
+      slot.store(entry, std::memory_order_release);
+      return;
+    }
   }
 }
 
 Entry* EntryTable::Get(uint32_t address) {
-  auto global_lock = global_critical_region_.Acquire();
-  const auto& it = map_.find(address);
-  Entry* entry = it != map_.end() ? it->second : nullptr;
+  Entry* entry = Find(table_.load(std::memory_order_acquire), address);
   if (entry) {
     // TODO(benvanik): wait if needed?
-    if (entry->status != Entry::STATUS_READY) {
+    if (entry->status.load(std::memory_order_acquire) !=
+        Entry::STATUS_READY) {
       entry = nullptr;
     }
   }
@@ -39,47 +81,91 @@ Entry* EntryTable::Get(uint32_t address) {
 }
 
 Entry::Status EntryTable::GetOrCreate(uint32_t address, Entry** out_entry) {
-  // TODO(benvanik): replace with a map with wait-free for find.
-  // https://github.com/facebook/folly/blob/master/folly/AtomicHashMap.h
+  // Fast path: entry already exists, no locks taken.
+  Entry* entry = Find(table_.load(std::memory_order_acquire), address);
+  if (!entry) {
+    std::unique_lock<std::mutex> lock(insert_mutex_);
+    // Someone may have inserted (or grown the table) since we looked.
+    Table* table = table_.load(std::memory_order_relaxed);
+    entry = Find(table, address);
+    if (!entry) {
+      // Create and return for initialization.
+      entry = new Entry();
+      entry->address = address;
+      entry->end_address = 0;
+      entry->status.store(Entry::STATUS_COMPILING, std::memory_order_relaxed);
+      entry->function = nullptr;
+      entry->waiter_count.store(0, std::memory_order_relaxed);
 
-  auto global_lock = global_critical_region_.Acquire();
-  const auto& it = map_.find(address);
-  Entry* entry = it != map_.end() ? it->second : nullptr;
-  Entry::Status status;
-  if (entry) {
-    // If we aren't ready yet spin and wait.
-    if (entry->status == Entry::STATUS_COMPILING) {
-      // Still compiling, so spin.
-      do {
-        global_lock.unlock();
-        // TODO(benvanik): sleep for less time?
-        xe::threading::Sleep(std::chrono::microseconds(10));
-        global_lock.lock();
-      } while (entry->status == Entry::STATUS_COMPILING);
+      if ((entry_count_ + 1) * 2 > table->mask + 1) {
+        // Grow. Readers still probing the old table will either find what
+        // they want there or fall into this locked path and see the new one.
+        auto new_table = new Table((table->mask + 1) * 2);
+        for (uint32_t i = 0; i <= table->mask; ++i) {
+          Entry* existing = table->slots[i].load(std::memory_order_relaxed);
+          if (existing) {
+            Insert(new_table, existing);
+          }
+        }
+        retired_tables_.emplace_back(table);
+        table = new_table;
+        table_.store(table, std::memory_order_release);
+      }
+      Insert(table, entry);
+      ++entry_count_;
+      *out_entry = entry;
+      return Entry::STATUS_NEW;
     }
-    status = entry->status;
-  } else {
-    // Create and return for initialization.
-    entry = new Entry();
-    entry->address = address;
-    entry->end_address = 0;
-    entry->status = Entry::STATUS_COMPILING;
-    entry->function = 0;
-    map_[address] = entry;
-    status = Entry::STATUS_NEW;
   }
-  global_lock.unlock();
+
+  auto status = entry->status.load(std::memory_order_acquire);
+  if (status == Entry::STATUS_COMPILING) {
+    WaitForCompletion(entry);
+    status = entry->status.load(std::memory_order_acquire);
+  }
   *out_entry = entry;
   return status;
 }
 
+void EntryTable::WaitForCompletion(Entry* entry) {
+  SCOPE_profile_cpu_f("cpu");
+  entry->waiter_count.fetch_add(1, std::memory_order_acq_rel);
+  {
+    std::unique_lock<std::mutex> lock(entry->wait_mutex);
+    entry->wait_cond.wait(lock, [entry]() {
+      return entry->status.load(std::memory_order_acquire) !=
+             Entry::STATUS_COMPILING;
+    });
+  }
+  entry->waiter_count.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void EntryTable::Complete(Entry* entry, Entry::Status status) {
+  assert_true(status == Entry::STATUS_READY ||
+              status == Entry::STATUS_FAILED);
+  {
+    // Storing under the mutex ensures no waiter is between its predicate
+    // check and sleeping. Release orders function/end_address before status.
+    std::lock_guard<std::mutex> lock(entry->wait_mutex);
+    entry->status.store(status, std::memory_order_release);
+  }
+  if (entry->waiter_count.load(std::memory_order_acquire)) {
+    entry->wait_cond.notify_all();
+  }
+}
+
 std::vector<Function*> EntryTable::FindWithAddress(uint32_t address) {
-  auto global_lock = global_critical_region_.Acquire();
+  std::lock_guard<std::mutex> lock(insert_mutex_);
+  Table* table = table_.load(std::memory_order_relaxed);
   std::vector<Function*> fns;
-  for (auto& it : map_) {
-    Entry* entry = it.second;
+  for (uint32_t i = 0; i <= table->mask; ++i) {
+    Entry* entry = table->slots[i].load(std::memory_order_acquire);
+    if (!entry) {
+      continue;
+    }
     if (address >= entry->address && address <= entry->end_address) {
-      if (entry->status == Entry::STATUS_READY) {
+      if (entry->status.load(std::memory_order_acquire) ==
+          Entry::STATUS_READY) {
         fns.push_back(entry->function);
       }
     }
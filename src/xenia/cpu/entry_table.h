@@ -10,11 +10,12 @@
 #ifndef XENIA_CPU_ENTRY_TABLE_H_
 #define XENIA_CPU_ENTRY_TABLE_H_
 
-#include <unordered_map>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <vector>
 
-#include "xenia/base/mutex.h"
-
 namespace xe {
 namespace cpu {
 
@@ -30,24 +31,61 @@ typedef struct Entry_t {
 
   uint32_t address;
   uint32_t end_address;
-  Status status;
+  // Only ever transitions out of STATUS_COMPILING through
+  // EntryTable::Complete, which publishes function/end_address with it.
+  std::atomic<Status> status;
   Function* function;
+
+  // Threads blocked waiting for this entry to leave STATUS_COMPILING.
+  // Only touched on the slow path; READY lookups never look at these.
+  std::atomic<uint32_t> waiter_count;
+  std::mutex wait_mutex;
+  std::condition_variable wait_cond;
 } Entry;
 
+// Concurrent address -> Entry map.
+// Lookups are wait-free: they probe an open-addressed table of atomic entry
+// pointers without taking any lock. Only insertion of a new entry (which
+// happens once per function) takes the table's own insert mutex. Threads that
+// find an entry still compiling park on that entry alone until the compiling
+// thread calls Complete.
 class EntryTable {
  public:
   EntryTable();
   ~EntryTable();
 
+  // Returns the entry at the given address if it is ready for use.
   Entry* Get(uint32_t address);
+  // Returns the entry at the given address, creating it if needed.
+  // If STATUS_NEW is returned the caller owns compilation of the entry and
+  // must call Complete on it when done. Otherwise this blocks until the entry
+  // is no longer compiling.
   Entry::Status GetOrCreate(uint32_t address, Entry** out_entry);
+  // Transitions an entry out of STATUS_COMPILING and wakes any waiters.
+  void Complete(Entry* entry, Entry::Status status);
 
   std::vector<Function*> FindWithAddress(uint32_t address);
 
  private:
-  xe::global_critical_region global_critical_region_;
-  // TODO(benvanik): replace with a better data structure.
-  std::unordered_map<uint32_t, Entry*> map_;
+  struct Table {
+    explicit Table(uint32_t capacity);
+    uint32_t mask;
+    std::unique_ptr<std::atomic<Entry*>[]> slots;
+  };
+
+  static uint32_t HashAddress(uint32_t address);
+  static Entry* Find(const Table* table, uint32_t address);
+  static void Insert(Table* table, Entry* entry);
+  void WaitForCompletion(Entry* entry);
+
+  std::atomic<Table*> table_;
+  // Guards insertion and growth. Never held on the lookup path.
+  std::mutex insert_mutex_;
+  uint32_t entry_count_ = 0;
+  // Tables replaced by growth. Readers may still be probing them so they are
+  // kept alive until the table is destroyed; total size is bounded by 2x the
+  // live table.
+  std::vector<std::unique_ptr<Table>> retired_tables_;
 };
 
 }  // namespace cpu
@@ -129,7 +129,7 @@ bool GuestFunction::Call(ThreadState* thread_state, uint32_t return_address) {
     ThreadState::Bind(thread_state);
   }
 
-  bool result = CallImpl(thread_state, return_address);
+  bool result = installed_function()->CallImpl(thread_state, return_address);
 
   if (original_thread_state != thread_state) {
     ThreadState::Bind(original_thread_state);
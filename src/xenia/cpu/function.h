@@ -10,6 +10,7 @@
 #ifndef XENIA_CPU_FUNCTION_H_
 #define XENIA_CPU_FUNCTION_H_
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -100,6 +101,18 @@ class GuestFunction : public Function {
   typedef void (*ExternHandler)(ppc::PPCContext* ppc_context,
                                 kernel::KernelState* kernel_state);
 
+  // Optimization level of the machine code installed for the address.
+  enum class Tier {
+    // Quick to translate. Final unless tiered compilation is enabled.
+    kBaseline,
+    // Baseline code counting calls until it requests its own optimization;
+    // will be replaced, so callers shouldn't bake in its address.
+    kWarmingUp,
+    // Recompiled with the full set of optimizations. Final. For a function
+    // that was warming up, the code is in optimized_function().
+    kOptimized,
+  };
+
   GuestFunction(Module* module, uint32_t address);
   ~GuestFunction() override;
 
@@ -115,6 +128,31 @@ class GuestFunction : public Function {
   void set_debug_info(std::unique_ptr<FunctionDebugInfo> debug_info) {
     debug_info_ = std::move(debug_info);
   }
+  // Set after the machine code of that tier is installed.
+  Tier tier() const { return tier_.load(std::memory_order_acquire); }
+  void set_tier(Tier tier) { tier_.store(tier, std::memory_order_release); }
+  // Calls left before kWarmingUp code requests optimization. Decremented by
+  // generated code without synchronization.
+  int32_t* tier_up_countdown() { return &tier_up_countdown_; }
+  // Separate code object holding the kOptimized recompilation. This function
+  // keeps its baseline code and source map, so host PCs in the baseline code
+  // still resolve against it. Set once, before tier() becomes kOptimized, so
+  // other threads must check the tier first.
+  GuestFunction* optimized_function() const {
+    return optimized_function_.get();
+  }
+  void set_optimized_function(std::unique_ptr<GuestFunction> function) {
+    optimized_function_ = std::move(function);
+  }
+  // The code object holding the machine code currently installed for the
+  // address: this function, or optimized_function() once it has replaced it.
+  GuestFunction* installed_function() {
+    if (tier() == Tier::kOptimized && optimized_function_) {
+      return optimized_function_.get();
+    }
+    return this;
+  }
+
   FunctionTraceData& trace_data() { return trace_data_; }
   std::vector<SourceMapEntry>& source_map() { return source_map_; }
 
@@ -137,6 +175,9 @@ class GuestFunction : public Function {
 
  protected:
   std::unique_ptr<FunctionDebugInfo> debug_info_;
+  std::atomic<Tier> tier_ = {Tier::kBaseline};
+  int32_t tier_up_countdown_ = 0;
+  std::unique_ptr<GuestFunction> optimized_function_;
   FunctionTraceData trace_data_;
   std::vector<SourceMapEntry> source_map_;
   ExternHandler extern_handler_ = nullptr;
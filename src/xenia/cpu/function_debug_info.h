@@ -28,10 +28,15 @@ enum DebugInfoFlags : uint32_t {
   kDebugInfoTraceFunctionCoverage = (1 << 7) | kDebugInfoTraceFunctions,
   kDebugInfoTraceFunctionReferences = (1 << 8) | kDebugInfoTraceFunctions,
   kDebugInfoTraceFunctionData = (1 << 9) | kDebugInfoTraceFunctions,
+  // Entry counts and cycle timing; see FunctionTraceData::ProfileCounters.
+  kDebugInfoProfileFunctions = (1 << 10),
+  // Call countdown requesting recompilation at GuestFunction::Tier::kOptimized.
+  kDebugInfoTierUpCounter = (1 << 11),
 
   kDebugInfoAllTracing =
       kDebugInfoTraceFunctions | kDebugInfoTraceFunctionCoverage |
-      kDebugInfoTraceFunctionReferences | kDebugInfoTraceFunctionData,
+      kDebugInfoTraceFunctionReferences | kDebugInfoTraceFunctionData |
+      kDebugInfoProfileFunctions,
   kDebugInfoAll = 0xFFFFFFFF,
 };
 
@@ -0,0 +1,168 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/function_profiler.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+#include "xenia/base/clock.h"
+#include "xenia/base/filesystem.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/string.h"
+#include "xenia/cpu/cpu_flags.h"
+#include "xenia/cpu/function.h"
+#include "xenia/cpu/processor.h"
+
+namespace xe {
+namespace cpu {
+
+FunctionProfiler::FunctionProfiler(Processor* processor)
+    : processor_(processor) {
+  start_cycles_ = Clock::host_tick_count_raw();
+  start_host_ticks_ = Clock::host_tick_count_platform();
+}
+
+FunctionProfiler::~FunctionProfiler() { report_timer_.reset(); }
+
+void FunctionProfiler::StartPeriodicReports(std::chrono::milliseconds period) {
+  report_timer_ = xe::threading::HighResolutionTimer::CreateRepeating(
+      period, [this]() { Report(); });
+}
+
+std::vector<FunctionProfiler::Entry> FunctionProfiler::GatherEntries() {
+  std::vector<Entry> entries;
+  for (auto module : processor_->GetModules()) {
+    module->ForEachFunction([&entries](Function* function) {
+      if (!function->is_guest()) {
+        return;
+      }
+      // Read without synchronization; counters of running functions may be
+      // slightly behind.
+      auto guest_function = static_cast<GuestFunction*>(function);
+      // Optimized code counts into its own code object.
+      GuestFunction* optimized_function = nullptr;
+      if (guest_function->tier() == GuestFunction::Tier::kOptimized) {
+        optimized_function = guest_function->optimized_function();
+      }
+      Entry entry = {function, 0, 0, 0};
+      for (auto code_function : {guest_function, optimized_function}) {
+        if (!code_function) {
+          continue;
+        }
+        auto counters = code_function->trace_data().profile_counters();
+        entry.call_count += counters->call_count;
+        entry.inclusive_cycles += counters->inclusive_cycles;
+        entry.exclusive_cycles += counters->exclusive_cycles;
+      }
+      if (!entry.call_count) {
+        return;
+      }
+      entries.push_back(entry);
+    });
+  }
+  return entries;
+}
+
+double FunctionProfiler::CyclesPerMillisecond() {
+  uint64_t elapsed_cycles = Clock::host_tick_count_raw() - start_cycles_;
+  uint64_t elapsed_host_ticks =
+      Clock::host_tick_count_platform() - start_host_ticks_;
+  if (!elapsed_host_ticks) {
+    return 1.0;
+  }
+  double elapsed_ms = double(elapsed_host_ticks) * 1000.0 /
+                      double(Clock::host_tick_frequency_platform());
+  return double(elapsed_cycles) / elapsed_ms;
+}
+
+void FunctionProfiler::Report() {
+  std::lock_guard<std::mutex> lock(report_mutex_);
+
+  auto entries = GatherEntries();
+  uint64_t total_cycles = 0;
+  for (auto& entry : entries) {
+    total_cycles += entry.exclusive_cycles;
+  }
+  double cycles_per_ms = CyclesPerMillisecond();
+  size_t top_count =
+      std::min(size_t(std::max(cvars::profile_functions_report_count, 0)),
+               entries.size());
+
+  XELOGI("Function profile: %zu functions called, %.1fms total", entries.size(),
+         total_cycles / cycles_per_ms);
+  auto log_top = [&](const char* title) {
+    XELOGI("  Top %zu by %s time:", top_count, title);
+    XELOGI("    address  calls        exclusive        inclusive  name");
+    for (size_t i = 0; i < top_count; ++i) {
+      auto& entry = entries[i];
+      XELOGI("    %.8X %10" PRIu64 " %9.1fms %5.1f%% %9.1fms  %s",
+             entry.function->address(), entry.call_count,
+             entry.exclusive_cycles / cycles_per_ms,
+             total_cycles ? entry.exclusive_cycles * 100.0 / total_cycles : 0.0,
+             entry.inclusive_cycles / cycles_per_ms,
+             entry.function->name().c_str());
+    }
+  };
+  std::partial_sort(entries.begin(), entries.begin() + top_count,
+                    entries.end(), [](const Entry& a, const Entry& b) {
+                      return a.exclusive_cycles > b.exclusive_cycles;
+                    });
+  log_top("exclusive");
+  std::partial_sort(entries.begin(), entries.begin() + top_count,
+                    entries.end(), [](const Entry& a, const Entry& b) {
+                      return a.inclusive_cycles > b.inclusive_cycles;
+                    });
+  log_top("inclusive");
+
+  if (!cvars::profile_functions_report_path.empty()) {
+    // Everything, for tooling to slice as it likes.
+    WriteJson(xe::to_wstring(cvars::profile_functions_report_path), entries,
+              total_cycles);
+  }
+}
+
+void FunctionProfiler::WriteJson(const std::wstring& path,
+                                 const std::vector<Entry>& entries,
+                                 uint64_t total_cycles) {
+  FILE* file = xe::filesystem::OpenFile(path, "wb");
+  if (!file) {
+    XELOGE("Unable to open function profile report file");
+    return;
+  }
+  double cycles_per_ms = CyclesPerMillisecond();
+  fprintf(file, "{\n");
+  fprintf(file, "  \"cycles_per_ms\": %.1f,\n", cycles_per_ms);
+  fprintf(file, "  \"total_cycles\": %" PRIu64 ",\n", total_cycles);
+  fprintf(file, "  \"functions\": [\n");
+  for (size_t i = 0; i < entries.size(); ++i) {
+    auto& entry = entries[i];
+    std::string name;
+    for (char c : entry.function->name()) {
+      if (c == '"' || c == '\\') {
+        name.push_back('\\');
+      }
+      name.push_back(c);
+    }
+    fprintf(file,
+            "    {\"address\": %u, \"name\": \"%s\", \"calls\": %" PRIu64
+            ", \"inclusive_cycles\": %" PRIu64
+            ", \"exclusive_cycles\": %" PRIu64 "}%s\n",
+            entry.function->address(), name.c_str(), entry.call_count,
+            entry.inclusive_cycles, entry.exclusive_cycles,
+            i + 1 < entries.size() ? "," : "");
+  }
+  fprintf(file, "  ]\n");
+  fprintf(file, "}\n");
+  fclose(file);
+}
+
+}  // namespace cpu
+}  // namespace xe
@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_CPU_FUNCTION_PROFILER_H_
+#define XENIA_CPU_FUNCTION_PROFILER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "xenia/base/threading.h"
+
+namespace xe {
+namespace cpu {
+
+class Function;
+class Processor;
+
+// Reports the guest functions taking the most host time, from the counters
+// that code emitted with kDebugInfoProfileFunctions keeps in each function's
+// trace data. This works on JIT frames that external profilers can't make
+// sense of.
+//
+// Times are measured with the host timestamp counter. Inclusive time counts
+// everything until the function returns; exclusive time leaves out the guest
+// functions it calls (but not kernel calls, which have no counters).
+// Recursive functions count nested invocations towards their inclusive time
+// once per level.
+class FunctionProfiler {
+ public:
+  explicit FunctionProfiler(Processor* processor);
+  ~FunctionProfiler();
+
+  // Also reports every period until destruction, for watching a title live.
+  void StartPeriodicReports(std::chrono::milliseconds period);
+
+  // Logs the top --profile_functions_report_count functions by exclusive and
+  // inclusive time and writes them to --profile_functions_report_path as JSON,
+  // if set.
+  void Report();
+
+ private:
+  struct Entry {
+    Function* function;
+    uint64_t call_count;
+    uint64_t inclusive_cycles;
+    uint64_t exclusive_cycles;
+  };
+
+  std::vector<Entry> GatherEntries();
+  double CyclesPerMillisecond();
+  void WriteJson(const std::wstring& path, const std::vector<Entry>& entries,
+                 uint64_t total_cycles);
+
+  Processor* processor_ = nullptr;
+
+  // Timestamp counter and platform clock at creation, to convert cycles to
+  // time without relying on the CPU reporting its TSC frequency.
+  uint64_t start_cycles_ = 0;
+  uint64_t start_host_ticks_ = 0;
+
+  std::mutex report_mutex_;
+  std::unique_ptr<xe::threading::HighResolutionTimer> report_timer_;
+};
+
+}  // namespace cpu
+}  // namespace xe
+
+#endif  // XENIA_CPU_FUNCTION_PROFILER_H_
@@ -42,7 +42,18 @@ class FunctionTraceData {
     // uint64_t instruction_execute_count[];
   };
 
-  FunctionTraceData() : header_(nullptr) {}
+  // Maintained by code emitted with kDebugInfoProfileFunctions. Unlike the
+  // header these live with the function rather than in the trace file, so
+  // they are available without tracing enabled.
+  struct ProfileCounters {
+    uint64_t call_count;
+    // Host timestamp counter cycles spent in the function, including and
+    // excluding time spent in the guest functions it calls.
+    uint64_t inclusive_cycles;
+    uint64_t exclusive_cycles;
+  };
+
+  FunctionTraceData() : header_(nullptr), profile_counters_() {}
 
   void Reset(uint8_t* trace_data, size_t trace_data_size,
              uint32_t start_address, uint32_t end_address) {
@@ -71,6 +82,9 @@ class FunctionTraceData {
 
   Header* header() const { return header_; }
 
+  ProfileCounters* profile_counters() { return &profile_counters_; }
+  const ProfileCounters& profile_counters() const { return profile_counters_; }
+
   uint8_t* instruction_execute_counts() const {
     return reinterpret_cast<uint8_t*>(header_) + sizeof(Header);
   }
@@ -85,6 +99,7 @@ class FunctionTraceData {
 
  private:
   Header* header_;
+  ProfileCounters profile_counters_;
 };
 
 }  // namespace cpu
@@ -734,6 +734,28 @@ Value* HIRBuilder::CloneValue(Value* source) {
   return value;
 }
 
+Instr* HIRBuilder::CloneInstr(const Instr* source) {
+  Value* dest = source->dest ? AllocValue(source->dest->type) : NULL;
+  Instr* i = AppendInstr(*source->opcode, source->flags, dest);
+  uint32_t signature = source->opcode->signature;
+  if (GET_OPCODE_SIG_TYPE_SRC1(signature) == OPCODE_SIG_TYPE_V) {
+    i->set_src1(source->src1.value);
+  } else {
+    i->src1 = source->src1;
+  }
+  if (GET_OPCODE_SIG_TYPE_SRC2(signature) == OPCODE_SIG_TYPE_V) {
+    i->set_src2(source->src2.value);
+  } else {
+    i->src2 = source->src2;
+  }
+  if (GET_OPCODE_SIG_TYPE_SRC3(signature) == OPCODE_SIG_TYPE_V) {
+    i->set_src3(source->src3.value);
+  } else {
+    i->src3 = source->src3;
+  }
+  return i;
+}
+
 void HIRBuilder::Comment(const char* value) {
   size_t length = std::strlen(value);
   if (!length) {
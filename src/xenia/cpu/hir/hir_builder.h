@@ -99,6 +99,9 @@ class HIRBuilder {
 
   Value* AllocValue(TypeName type = INT64_TYPE);
   Value* CloneValue(Value* source);
+  // Appends a copy of the given instruction with a new dest value (if any).
+  // Value operands are shared with the source instruction.
+  Instr* CloneInstr(const Instr* source);
 
   // phi type_name, Block* b1, Value* v1, Block* b2, Value* v2, etc
   Value* Assign(Value* value);
@@ -53,6 +53,9 @@ class Module {
 
   bool ReadMap(const char* file_name);
 
+  // Guards the symbol tables; exposed for contention statistics.
+  const xe::fast_recursive_mutex& symbol_lock() const { return lock_; }
+
  protected:
   virtual std::unique_ptr<Function> CreateFunction(uint32_t address) = 0;
 
@@ -64,7 +67,9 @@ class Module {
                                Symbol** out_symbol);
   Symbol::Status DefineSymbol(Symbol* symbol);
 
-  xe::global_critical_region global_critical_region_;
+  // Kept separate from the global critical region so symbol lookups from the
+  // JIT don't contend with guest critical sections or kernel bookkeeping.
+  xe::fast_recursive_mutex lock_;
   // TODO(benvanik): replace with a better data structure.
   std::unordered_map<uint32_t, Symbol*> map_;
   std::vector<std::unique_ptr<Symbol>> list_;
@@ -11,9 +11,9 @@
 #define XENIA_CPU_PPC_PPC_CONTEXT_H_
 
 #include <cstdint>
-#include <mutex>
 #include <string>
 
+#include "xenia/base/mutex.h"
 #include "xenia/base/vec128.h"
 
 namespace xe {
@@ -408,8 +408,8 @@ typedef struct PPCContext_s {
   uint32_t thread_id;
 
   // Global interrupt lock, held while interrupts are disabled or interrupts are
-  // executing. This is shared among all threads and comes from the processor.
-  std::recursive_mutex* global_mutex;
+  // executing. This is shared among all threads and comes from the frontend.
+  xe::fast_recursive_mutex* global_mutex;
 
   // Used to shuttle data into externs. Contents volatile.
   uint64_t scratch;
@@ -426,6 +426,13 @@ typedef struct PPCContext_s {
   // Value of last reserved load
   uint64_t reserved_val;
 
+  // Timestamp counter cycles of all profiled functions that have returned on
+  // this thread. Functions sample it on entry and exit to split their own time
+  // from that of their callees. Only maintained when profiling functions.
+  uint64_t profile_callee_cycles;
+  // Keeps the context a multiple of 64b.
+  uint8_t padding[56];
+
   static std::string GetRegisterName(PPCRegister reg);
   std::string GetStringFromValue(PPCRegister reg) const;
   void SetValueFromString(PPCRegister reg, std::string value);
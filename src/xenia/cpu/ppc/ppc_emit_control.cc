@@ -14,6 +14,7 @@
 #include "xenia/cpu/ppc/ppc_context.h"
 #include "xenia/cpu/ppc/ppc_frontend.h"
 #include "xenia/cpu/ppc/ppc_hir_builder.h"
+#include "xenia/cpu/ppc/ppc_scanner.h"
 
 #include <stddef.h>
 
@@ -160,6 +161,10 @@ int InstrEmit_bx(PPCHIRBuilder& f, const InstrData& i) {
     nia = (uint32_t)(i.address + XEEXTS26(i.I.LI << 2));
   }
 
+  if (f.EmitInlineCall(i.address, nia, i.I.LK != 0)) {
+    return 0;
+  }
+
   return InstrEmit_branch(f, "bx", i.address, f.LoadConstantUint32(nia),
                           i.I.LK);
 }
@@ -268,6 +273,16 @@ int InstrEmit_bcctrx(PPCHIRBuilder& f, const InstrData& i) {
     }
   }
 
+  if (!cond_ok && !i.XL.LK) {
+    // Plain bctr. If the scanner decoded the jump table it goes through,
+    // branch to the target directly and only fall back to the indirect jump
+    // for addresses not in the table.
+    auto jump_table = f.LookupJumpTable(uint32_t(i.address));
+    if (jump_table) {
+      f.EmitJumpTableDispatch(*jump_table);
+    }
+  }
+
   bool expect_true = !not_cond_ok;
   return InstrEmit_branch(f, "bcctrx", i.address, f.LoadCTR(), i.XL.LK, cond_ok,
                           expect_true);
@@ -9,7 +9,10 @@
 
 #include "xenia/cpu/ppc/ppc_frontend.h"
 
+#include <cinttypes>
+
 #include "xenia/base/atomic.h"
+#include "xenia/base/logging.h"
 #include "xenia/cpu/ppc/ppc_context.h"
 #include "xenia/cpu/ppc/ppc_emit.h"
 #include "xenia/cpu/ppc/ppc_opcode_info.h"
@@ -48,6 +51,11 @@ PPCFrontend::PPCFrontend(Processor* processor) : processor_(processor) {
 PPCFrontend::~PPCFrontend() {
   // Force cleanup now before we deinit.
   translator_pool_.Reset();
+
+  XELOGCPU("Guest global lock: %" PRIu64 " acquisitions, %" PRIu64
+           " contended",
+           builtins_.global_lock.acquire_count(),
+           builtins_.global_lock.contended_count());
 }
 
 Memory* PPCFrontend::memory() const { return processor_->memory(); }
@@ -55,15 +63,15 @@ Memory* PPCFrontend::memory() const { return processor_->memory(); }
 // Checks the state of the global lock and sets scratch to the current MSR
 // value.
 void CheckGlobalLock(PPCContext* ppc_context, void* arg0, void* arg1) {
-  auto global_mutex = reinterpret_cast<std::recursive_mutex*>(arg0);
+  auto global_mutex = reinterpret_cast<xe::fast_recursive_mutex*>(arg0);
   auto global_lock_count = reinterpret_cast<int32_t*>(arg1);
-  std::lock_guard<std::recursive_mutex> lock(*global_mutex);
+  std::lock_guard<xe::fast_recursive_mutex> lock(*global_mutex);
   ppc_context->scratch = *global_lock_count ? 0 : 0x8000;
 }
 
 // Enters the global lock. Safe to recursion.
 void EnterGlobalLock(PPCContext* ppc_context, void* arg0, void* arg1) {
-  auto global_mutex = reinterpret_cast<std::recursive_mutex*>(arg0);
+  auto global_mutex = reinterpret_cast<xe::fast_recursive_mutex*>(arg0);
   auto global_lock_count = reinterpret_cast<int32_t*>(arg1);
   global_mutex->lock();
   xe::atomic_inc(global_lock_count);
@@ -71,7 +79,7 @@ void EnterGlobalLock(PPCContext* ppc_context, void* arg0, void* arg1) {
 
 // Leaves the global lock. Safe to recursion.
 void LeaveGlobalLock(PPCContext* ppc_context, void* arg0, void* arg1) {
-  auto global_mutex = reinterpret_cast<std::recursive_mutex*>(arg0);
+  auto global_mutex = reinterpret_cast<xe::fast_recursive_mutex*>(arg0);
   auto global_lock_count = reinterpret_cast<int32_t*>(arg1);
   auto new_lock_count = xe::atomic_dec(global_lock_count);
   assert_true(new_lock_count >= 0);
@@ -79,7 +87,7 @@ void LeaveGlobalLock(PPCContext* ppc_context, void* arg0, void* arg1) {
 }
 
 bool PPCFrontend::Initialize() {
-  void* arg0 = reinterpret_cast<void*>(&xe::global_critical_region::mutex());
+  void* arg0 = reinterpret_cast<void*>(&builtins_.global_lock);
   void* arg1 = reinterpret_cast<void*>(&builtins_.global_lock_count);
   builtins_.check_global_lock =
       processor_->DefineBuiltin("CheckGlobalLock", CheckGlobalLock, arg0, arg1);
@@ -100,9 +108,10 @@ bool PPCFrontend::DeclareFunction(GuestFunction* function) {
 }
 
 bool PPCFrontend::DefineFunction(GuestFunction* function,
-                                 uint32_t debug_info_flags) {
+                                 uint32_t debug_info_flags,
+                                 GuestFunction::Tier tier) {
   auto translator = translator_pool_.Allocate(this);
-  bool result = translator->Translate(function, debug_info_flags);
+  bool result = translator->Translate(function, debug_info_flags, tier);
   translator_pool_.Release(translator);
   return result;
 }
@@ -12,6 +12,7 @@
 
 #include <memory>
 
+#include "xenia/base/mutex.h"
 #include "xenia/base/type_pool.h"
 #include "xenia/cpu/function.h"
 #include "xenia/memory.h"
@@ -29,10 +30,14 @@ namespace ppc {
 class PPCTranslator;
 
 struct PPCBuiltins {
-  int32_t global_lock_count;
-  Function* check_global_lock;
-  Function* enter_global_lock;
-  Function* leave_global_lock;
+  // Taken by guest code while it has interrupts disabled (mtmsrd r13). This is
+  // deliberately separate from xe::global_critical_region so that guest
+  // critical sections don't contend with host-side table locks.
+  xe::fast_recursive_mutex global_lock;
+  int32_t global_lock_count = 0;
+  Function* check_global_lock = nullptr;
+  Function* enter_global_lock = nullptr;
+  Function* leave_global_lock = nullptr;
 };
 
 class PPCFrontend {
@@ -47,11 +52,13 @@ class PPCFrontend {
   PPCBuiltins* builtins() { return &builtins_; }
 
   bool DeclareFunction(GuestFunction* function);
-  bool DefineFunction(GuestFunction* function, uint32_t debug_info_flags);
+  bool DefineFunction(
+      GuestFunction* function, uint32_t debug_info_flags,
+      GuestFunction::Tier tier = GuestFunction::Tier::kBaseline);
 
  private:
   Processor* processor_;
-  PPCBuiltins builtins_ = {0};
+  PPCBuiltins builtins_;
   TypePool<PPCTranslator, PPCFrontend*> translator_pool_;
 };
 
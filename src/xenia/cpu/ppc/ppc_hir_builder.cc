@@ -22,6 +22,7 @@
 #include "xenia/cpu/ppc/ppc_decode_data.h"
 #include "xenia/cpu/ppc/ppc_frontend.h"
 #include "xenia/cpu/ppc/ppc_opcode_info.h"
+#include "xenia/cpu/ppc/ppc_scanner.h"
 #include "xenia/cpu/processor.h"
 
 namespace xe {
@@ -68,16 +69,19 @@ void PPCHIRBuilder::Reset() {
   instr_count_ = 0;
   instr_offset_list_ = NULL;
   label_list_ = NULL;
+  jump_tables_ = nullptr;
   with_debug_info_ = false;
   HIRBuilder::Reset();
 }
 
-bool PPCHIRBuilder::Emit(GuestFunction* function, uint32_t flags) {
+bool PPCHIRBuilder::Emit(GuestFunction* function, uint32_t flags,
+                         const std::vector<JumpTableInfo>* jump_tables) {
   SCOPE_profile_cpu_f("cpu");
 
   Memory* memory = frontend_->memory();
 
   function_ = function;
+  jump_tables_ = jump_tables;
   start_address_ = function_->address();
   instr_count_ = (function_->end_address() - function_->address()) / 4 + 1;
 
@@ -107,11 +111,8 @@ bool PPCHIRBuilder::Emit(GuestFunction* function, uint32_t flags) {
   uint32_t end_address = function_->end_address();
   for (uint32_t address = start_address, offset = 0; address <= end_address;
        address += 4, offset++) {
-    trace_info_.dest_count = 0;
     uint32_t code =
         xe::load_and_swap<uint32_t>(memory->TranslateVirtual(address));
-    auto opcode = LookupOpcode(code);
-    auto& opcode_info = GetOpcodeInfo(opcode);
 
     // Mark label, if we were assigned one earlier on in the walk.
     // We may still get a label, but it'll be inserted by LookupLabel
@@ -126,10 +127,7 @@ bool PPCHIRBuilder::Emit(GuestFunction* function, uint32_t flags) {
       if (label) {
         AnnotateLabel(address, label);
       }
-      comment_buffer_.Reset();
-      comment_buffer_.AppendFormat("%.8X %.8X ", address, code);
-      DisasmPPC(address, code, &comment_buffer_);
-      Comment(comment_buffer_);
+      CommentInstruction(address, code);
       first_instr = last_instr();
     }
 
@@ -143,35 +141,7 @@ bool PPCHIRBuilder::Emit(GuestFunction* function, uint32_t flags) {
     // Stash instruction offset. It's either the SOURCE_OFFSET or the COMMENT.
     instr_offset_list_[offset] = first_instr;
 
-    if (opcode == PPCOpcode::kInvalid) {
-      XELOGE("Invalid instruction %.8llX %.8X", address, code);
-      Comment("INVALID!");
-      // TraceInvalidInstruction(i);
-      continue;
-    }
-    ++opcode_translation_counts[static_cast<int>(opcode)];
-
-    // Synchronize the PPC context as required.
-    // This will ensure all registers are saved to the PPC context before this
-    // instruction executes.
-    if (opcode_info.type == PPCOpcodeType::kSync) {
-      ContextBarrier();
-    }
-
-    MaybeBreakOnInstruction(address);
-
-    InstrData i;
-    i.address = address;
-    i.code = code;
-    i.opcode = opcode;
-    i.opcode_info = &opcode_info;
-    if (!opcode_info.emit || opcode_info.emit(*this, i)) {
-      auto& disasm_info = GetOpcodeDisasmInfo(opcode);
-      XELOGE("Unimplemented instr %.8llX %.8X %s", address, code,
-             disasm_info.name);
-      Comment("UNIMPLEMENTED!");
-      DebugBreak();
-    }
+    EmitInstruction(address, code);
   }
 
   if (false) {
@@ -181,6 +151,49 @@ bool PPCHIRBuilder::Emit(GuestFunction* function, uint32_t flags) {
   return Finalize();
 }
 
+void PPCHIRBuilder::CommentInstruction(uint32_t address, uint32_t code) {
+  comment_buffer_.Reset();
+  comment_buffer_.AppendFormat("%.8X %.8X ", address, code);
+  DisasmPPC(address, code, &comment_buffer_);
+  Comment(comment_buffer_);
+}
+
+void PPCHIRBuilder::EmitInstruction(uint32_t address, uint32_t code) {
+  trace_info_.dest_count = 0;
+  auto opcode = LookupOpcode(code);
+  auto& opcode_info = GetOpcodeInfo(opcode);
+
+  if (opcode == PPCOpcode::kInvalid) {
+    XELOGE("Invalid instruction %.8llX %.8X", address, code);
+    Comment("INVALID!");
+    // TraceInvalidInstruction(i);
+    return;
+  }
+  ++opcode_translation_counts[static_cast<int>(opcode)];
+
+  // Synchronize the PPC context as required.
+  // This will ensure all registers are saved to the PPC context before this
+  // instruction executes.
+  if (opcode_info.type == PPCOpcodeType::kSync) {
+    ContextBarrier();
+  }
+
+  MaybeBreakOnInstruction(address);
+
+  InstrData i;
+  i.address = address;
+  i.code = code;
+  i.opcode = opcode;
+  i.opcode_info = &opcode_info;
+  if (!opcode_info.emit || opcode_info.emit(*this, i)) {
+    auto& disasm_info = GetOpcodeDisasmInfo(opcode);
+    XELOGE("Unimplemented instr %.8llX %.8X %s", address, code,
+           disasm_info.name);
+    Comment("UNIMPLEMENTED!");
+    DebugBreak();
+  }
+}
+
 void PPCHIRBuilder::MaybeBreakOnInstruction(uint32_t address) {
   if (address != cvars::break_on_instruction) {
     return;
@@ -273,6 +286,124 @@ Label* PPCHIRBuilder::LookupLabel(uint32_t address) {
   return label;
 }
 
+const JumpTableInfo* PPCHIRBuilder::LookupJumpTable(
+    uint32_t branch_address) const {
+  if (!jump_tables_) {
+    return nullptr;
+  }
+  for (auto& jump_table : *jump_tables_) {
+    if (jump_table.branch_address == branch_address) {
+      return &jump_table;
+    }
+  }
+  return nullptr;
+}
+
+bool PPCHIRBuilder::EmitInlineCall(uint32_t call_address,
+                                   uint32_t target_address, bool link) {
+  // Breakpoints and stepping need each guest instruction in its own function.
+  if (cvars::inline_max_instructions <= 0 || cvars::debug) {
+    return false;
+  }
+  // Branches within the function are handled with labels.
+  if (target_address >= function_->address() &&
+      target_address <= function_->end_address()) {
+    return false;
+  }
+  auto callee = LookupFunction(target_address);
+  if (!callee || !callee->is_guest() ||
+      callee->behavior() == Function::Behavior::kExtern) {
+    return false;
+  }
+
+  // Only straight-line code ending in an unconditional return is inlined, so
+  // the callee needs no labels of its own.
+  Memory* memory = frontend_->memory();
+  uint32_t body_count = 0;
+  for (uint32_t address = target_address;; address += 4, ++body_count) {
+    if (body_count > uint32_t(cvars::inline_max_instructions) ||
+        !callee->module()->ContainsAddress(address)) {
+      return false;
+    }
+    InstrData i;
+    i.code = xe::load_and_swap<uint32_t>(memory->TranslateVirtual(address));
+    auto opcode = LookupOpcode(i.code);
+    if (opcode == PPCOpcode::bclrx) {
+      if ((i.XL.BO & 0x14) != 0x14 || i.XL.LK) {
+        return false;
+      }
+      break;
+    }
+    if (opcode == PPCOpcode::kInvalid || !GetOpcodeInfo(opcode).emit ||
+        opcode == PPCOpcode::bx || opcode == PPCOpcode::bcx ||
+        opcode == PPCOpcode::bcctrx || opcode == PPCOpcode::sc) {
+      return false;
+    }
+    if (link && opcode == PPCOpcode::mtspr &&
+        (((i.XFX.spr & 0x1F) << 5) | ((i.XFX.spr >> 5) & 0x1F)) == 8) {
+      // The return would go somewhere other than back to us.
+      return false;
+    }
+  }
+
+  if (with_debug_info_) {
+    CommentFormat("inlined %s fn %.8X", callee->name().c_str(),
+                  target_address);
+  }
+  if (link) {
+    StoreLR(LoadConstantUint64(call_address + 4));
+  }
+
+  // After a call the return is a branch to the next instruction, which is
+  // where we already are. After a tail branch the callee returns for us.
+  // Inlined instructions share the source offset of the call, so faults and
+  // stack walks report the call site.
+  uint32_t emit_count = link ? body_count : body_count + 1;
+  for (uint32_t n = 0; n < emit_count; ++n) {
+    uint32_t address = target_address + n * 4;
+    uint32_t code =
+        xe::load_and_swap<uint32_t>(memory->TranslateVirtual(address));
+    if (with_debug_info_) {
+      CommentInstruction(address, code);
+    }
+    EmitInstruction(address, code);
+  }
+  return true;
+}
+
+void PPCHIRBuilder::EmitJumpTableDispatch(const JumpTableInfo& jump_table) {
+  // Binary search on CTR over the known targets. CTR is checked rather than
+  // the case index so that a table modified at runtime still lands in the
+  // right place (through the miss path).
+  Label* miss_label = NewLabel();
+  EmitJumpTableSearch(jump_table.targets, 0, jump_table.targets.size(),
+                      miss_label);
+  MarkLabel(miss_label);
+}
+
+void PPCHIRBuilder::EmitJumpTableSearch(const std::vector<uint32_t>& targets,
+                                        size_t begin, size_t end,
+                                        Label* miss_label) {
+  // Values don't live across blocks, so CTR is reloaded in each one.
+  if (end - begin == 1) {
+    Label* label = LookupLabel(targets[begin]);
+    if (label) {
+      Value* ctr = Truncate(LoadCTR(), INT32_TYPE);
+      BranchTrue(CompareEQ(ctr, LoadConstantUint32(targets[begin])), label);
+    }
+    Branch(miss_label);
+    return;
+  }
+  size_t middle = begin + (end - begin) / 2;
+  Label* upper_label = NewLabel();
+  Value* ctr = Truncate(LoadCTR(), INT32_TYPE);
+  BranchTrue(CompareUGE(ctr, LoadConstantUint32(targets[middle])),
+             upper_label);
+  EmitJumpTableSearch(targets, begin, middle, miss_label);
+  MarkLabel(upper_label);
+  EmitJumpTableSearch(targets, middle, end, miss_label);
+}
+
 // Value* PPCHIRBuilder::LoadXER() {
 //}
 //
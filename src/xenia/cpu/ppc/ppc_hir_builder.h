@@ -10,6 +10,8 @@
 #ifndef XENIA_CPU_PPC_PPC_HIR_BUILDER_H_
 #define XENIA_CPU_PPC_PPC_HIR_BUILDER_H_
 
+#include <vector>
+
 #include "xenia/base/string_buffer.h"
 #include "xenia/cpu/function.h"
 #include "xenia/cpu/hir/hir_builder.h"
@@ -18,6 +20,7 @@ namespace xe {
 namespace cpu {
 namespace ppc {
 
+struct JumpTableInfo;
 struct PPCBuiltins;
 class PPCFrontend;
 
@@ -38,11 +41,24 @@ class PPCHIRBuilder : public hir::HIRBuilder {
     // Emit comment nodes.
     EMIT_DEBUG_COMMENTS = 1 << 0,
   };
-  bool Emit(GuestFunction* function, uint32_t flags);
+  // Jump tables decoded by the scanner, if any, are dispatched directly.
+  bool Emit(GuestFunction* function, uint32_t flags,
+            const std::vector<JumpTableInfo>* jump_tables = nullptr);
 
   GuestFunction* function() const { return function_; }
   Function* LookupFunction(uint32_t address);
   Label* LookupLabel(uint32_t address);
+  const JumpTableInfo* LookupJumpTable(uint32_t branch_address) const;
+
+  // Emits the body of a small leaf function in place of a bl (link) or a tail
+  // branch to it, if it can be inlined (see --inline_max_instructions).
+  // Returns false if the call should be emitted normally.
+  bool EmitInlineCall(uint32_t call_address, uint32_t target_address,
+                      bool link);
+
+  // Branches to the label of the jump table target matching CTR. Falls
+  // through if CTR matches none of them.
+  void EmitJumpTableDispatch(const JumpTableInfo& jump_table);
 
   Value* LoadLR();
   void StoreLR(Value* value);
@@ -82,8 +98,12 @@ class PPCHIRBuilder : public hir::HIRBuilder {
   Value* LoadReserved();
 
  private:
+  void CommentInstruction(uint32_t address, uint32_t code);
+  void EmitInstruction(uint32_t address, uint32_t code);
   void MaybeBreakOnInstruction(uint32_t address);
   void AnnotateLabel(uint32_t address, Label* label);
+  void EmitJumpTableSearch(const std::vector<uint32_t>& targets, size_t begin,
+                           size_t end, Label* miss_label);
 
   PPCFrontend* frontend_;
 
@@ -97,6 +117,7 @@ class PPCHIRBuilder : public hir::HIRBuilder {
   uint64_t instr_count_;
   Instr** instr_offset_list_;
   Label** label_list_;
+  const std::vector<JumpTableInfo>* jump_tables_;
 
   // Reset each instruction.
   struct {
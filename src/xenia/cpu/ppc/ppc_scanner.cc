@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <map>
 
+#include "xenia/base/byte_order.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/memory.h"
 #include "xenia/base/profiling.h"
@@ -53,6 +54,8 @@ bool PPCScanner::Scan(GuestFunction* function, FunctionDebugInfo* debug_info) {
 
   LOGPPC("Analyzing function %.8X...", function->address());
 
+  jump_tables_.clear();
+
   // For debug info, only if needed.
   uint32_t address_reference_count = 0;
   uint32_t instruction_result_count = 0;
@@ -122,8 +125,16 @@ bool PPCScanner::Scan(GuestFunction* function, FunctionDebugInfo* debug_info) {
     } else if (code == 0x4E800420) {
       // bctr -- unconditional branch to CTR.
       // This is generally a jump to a function pointer (non-return).
-      // This is almost always a jump table.
-      // TODO(benvanik): decode jump tables.
+      // This is almost always a jump table. If we can decode it, all of its
+      // targets belong to this function.
+      JumpTableInfo jump_table;
+      if (DecodeJumpTable(start_address, end_address, address, &jump_table)) {
+        LOGPPC("bctr %.8X through jump table %.8X (%d targets)", address,
+               jump_table.table_address, int(jump_table.targets.size()));
+        furthest_target =
+            std::max(furthest_target, jump_table.targets.back());
+        jump_tables_.push_back(std::move(jump_table));
+      }
       if (furthest_target > address) {
         // Remaining targets within function, not end.
         LOGPPC("ignoring bctr %.8X (branch to %.8X)", address, furthest_target);
@@ -139,7 +150,7 @@ bool PPCScanner::Scan(GuestFunction* function, FunctionDebugInfo* debug_info) {
       if (d.I.LK()) {
         LOGPPC("bl %.8X -> %.8X", address, target);
         // Queue call target if needed.
-        // GetOrInsertFunction(target);
+        frontend_->processor()->PrecompileFunction(target);
       } else {
         LOGPPC("b %.8X -> %.8X", address, target);
 
@@ -289,6 +300,188 @@ bool PPCScanner::Scan(GuestFunction* function, FunctionDebugInfo* debug_info) {
   return true;
 }
 
+bool PPCScanner::DecodeJumpTable(uint32_t start_address, uint32_t end_address,
+                                 uint32_t branch_address,
+                                 JumpTableInfo* out_table) {
+  // Matches the bounds checked dispatch emitted for switch statements:
+  //   cmplwi    crN, rI, count - 1
+  //   bgt       crN, default
+  //   lis       rT, table@ha
+  //   addi      rT, rT, table@l
+  //   rlwinm    rO, rI, 2, 0, 29
+  //   lwzx      rO, rT, rO
+  //   mtctr     rO
+  //   bctr
+  // The compiler freely schedules everything between the compare and the
+  // bctr, so the sequence is evaluated instead of matched positionally. Any
+  // instruction other than the ones above rejects the match.
+  const uint32_t kMaxSequenceLength = 16;
+  const uint32_t kMaxTableEntryCount = 1024;
+
+  Memory* memory = frontend_->memory();
+  auto load_code = [memory](uint32_t address) {
+    return xe::load_and_swap<uint32_t>(memory->TranslateVirtual(address));
+  };
+
+  // Find the compare providing the bounds.
+  uint32_t compare_address = 0;
+  for (uint32_t i = 1; i <= kMaxSequenceLength; ++i) {
+    uint32_t address = branch_address - i * 4;
+    if (address < start_address) {
+      break;
+    }
+    if (LookupOpcode(load_code(address)) == PPCOpcode::cmpli) {
+      compare_address = address;
+      break;
+    }
+  }
+  if (!compare_address) {
+    return false;
+  }
+  PPCDecodeData d;
+  d.address = compare_address;
+  d.code = load_code(compare_address);
+  if (d.D.L()) {
+    // 64-bit compare.
+    return false;
+  }
+  uint32_t cr_field = d.D.CRFD();
+  uint32_t index_reg = d.D.RA();
+  uint32_t entry_count = d.D.UIMM() + 1;
+  if (entry_count > kMaxTableEntryCount) {
+    return false;
+  }
+
+  enum class RegState {
+    kUnknown,
+    // Still holds the index compared against.
+    kIndex,
+    kConstant,
+    // Index * 4.
+    kScaledIndex,
+    // Entry loaded from the table at value.
+    kTableEntry,
+  };
+  struct Reg {
+    RegState state;
+    uint32_t value;
+  };
+  Reg regs[32] = {};
+  regs[index_reg].state = RegState::kIndex;
+  auto is_constant = [&regs](uint32_t reg) {
+    return regs[reg].state == RegState::kConstant;
+  };
+
+  bool bounds_checked = false;
+  bool ctr_loaded = false;
+  uint32_t table_address = 0;
+  for (uint32_t address = compare_address + 4; address < branch_address;
+       address += 4) {
+    d.address = address;
+    d.code = load_code(address);
+    switch (LookupOpcode(d.code)) {
+      case PPCOpcode::bcx:
+        // Must be the bgt on our compare, branching away from the dispatch.
+        if (bounds_checked || d.B.LK() || (d.B.BO() & 0x1C) != 0x0C ||
+            d.B.BI() != cr_field * 4 + 1) {
+          return false;
+        }
+        bounds_checked = true;
+        break;
+      case PPCOpcode::addi:
+      case PPCOpcode::addis: {
+        bool known = !d.D.RA() || is_constant(d.D.RA());
+        uint32_t value = d.D.RA() ? regs[d.D.RA()].value : 0;
+        if (LookupOpcode(d.code) == PPCOpcode::addis) {
+          value += static_cast<uint32_t>(d.D.SIMM()) << 16;
+        } else {
+          value += static_cast<uint32_t>(d.D.SIMM());
+        }
+        regs[d.D.RT()] = {known ? RegState::kConstant : RegState::kUnknown,
+                          value};
+        break;
+      }
+      case PPCOpcode::ori:
+        // ori rA, rS, UIMM
+        regs[d.D.RA()] = {
+            is_constant(d.D.RS()) ? RegState::kConstant : RegState::kUnknown,
+            regs[d.D.RS()].value | d.D.UIMM()};
+        break;
+      case PPCOpcode::rlwinmx:
+        if (d.M.Rc()) {
+          return false;
+        }
+        if (regs[d.M.RS()].state == RegState::kIndex && d.M.SH() == 2 &&
+            d.M.MB() == 0 && d.M.ME() == 29) {
+          regs[d.M.RA()] = {RegState::kScaledIndex, 0};
+        } else {
+          regs[d.M.RA()] = {RegState::kUnknown, 0};
+        }
+        break;
+      case PPCOpcode::lwzx: {
+        Reg base = d.X.RA() ? regs[d.X.RA()] : Reg{RegState::kConstant, 0};
+        Reg offset = regs[d.X.RB()];
+        if (offset.state == RegState::kConstant) {
+          std::swap(base, offset);
+        }
+        if (base.state == RegState::kConstant &&
+            offset.state == RegState::kScaledIndex) {
+          regs[d.X.RT()] = {RegState::kTableEntry, base.value};
+        } else {
+          regs[d.X.RT()] = {RegState::kUnknown, 0};
+        }
+        break;
+      }
+      case PPCOpcode::mtspr: {
+        uint32_t spr =
+            ((d.XFX.SPR() & 0x1F) << 5) | ((d.XFX.SPR() >> 5) & 0x1F);
+        if (spr != 9) {
+          // Not mtctr.
+          return false;
+        }
+        ctr_loaded = regs[d.XFX.RT()].state == RegState::kTableEntry;
+        table_address = regs[d.XFX.RT()].value;
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  if (!bounds_checked || !ctr_loaded) {
+    return false;
+  }
+
+  // The table itself must be readable data outside of the code of the
+  // function.
+  uint32_t table_size = entry_count * 4;
+  auto heap = memory->LookupHeap(table_address);
+  if (!heap || heap->QueryRangeAccess(table_address,
+                                      table_address + table_size - 1) ==
+                   xe::memory::PageAccess::kNoAccess) {
+    return false;
+  }
+  auto table = reinterpret_cast<const xe::be<uint32_t>*>(
+      memory->TranslateVirtual(table_address));
+  std::vector<uint32_t> targets(table, table + entry_count);
+  for (uint32_t target : targets) {
+    if ((target & 0x3) || target < start_address ||
+        (end_address && target > end_address)) {
+      return false;
+    }
+  }
+  std::sort(targets.begin(), targets.end());
+  targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+  uint32_t code_end = std::max(branch_address, targets.back()) + 4;
+  if (table_address < code_end && table_address + table_size > start_address) {
+    return false;
+  }
+
+  out_table->branch_address = branch_address;
+  out_table->table_address = table_address;
+  out_table->targets = std::move(targets);
+  return true;
+}
+
 std::vector<BlockInfo> PPCScanner::FindBlocks(GuestFunction* function) {
   Memory* memory = frontend_->memory();
 
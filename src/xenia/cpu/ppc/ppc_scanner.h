@@ -26,6 +26,17 @@ struct BlockInfo {
   uint32_t end_address;
 };
 
+// A bctr dispatching through a table of code addresses, as emitted for switch
+// statements.
+struct JumpTableInfo {
+  // Address of the bctr.
+  uint32_t branch_address;
+  // Guest address of the table of targets.
+  uint32_t table_address;
+  // Distinct case targets, sorted by address.
+  std::vector<uint32_t> targets;
+};
+
 class PPCScanner {
  public:
   explicit PPCScanner(PPCFrontend* frontend);
@@ -35,10 +46,18 @@ class PPCScanner {
 
   std::vector<BlockInfo> FindBlocks(GuestFunction* function);
 
+  // Jump tables found by the last Scan.
+  const std::vector<JumpTableInfo>& jump_tables() const {
+    return jump_tables_;
+  }
+
  private:
   bool IsRestGprLr(uint32_t address);
+  bool DecodeJumpTable(uint32_t start_address, uint32_t end_address,
+                       uint32_t branch_address, JumpTableInfo* out_table);
 
   PPCFrontend* frontend_ = nullptr;
+  std::vector<JumpTableInfo> jump_tables_;
 };
 
 }  // namespace ppc
@@ -9,8 +9,11 @@
 
 #include "xenia/cpu/ppc/ppc_translator.h"
 
+#include <algorithm>
+
 #include "xenia/base/assert.h"
 #include "xenia/base/byte_order.h"
+#include "xenia/base/logging.h"
 #include "xenia/base/memory.h"
 #include "xenia/base/profiling.h"
 #include "xenia/base/reset_scope.h"
@@ -35,22 +38,30 @@ PPCTranslator::PPCTranslator(PPCFrontend* frontend) : frontend_(frontend) {
 
   scanner_.reset(new PPCScanner(frontend));
   builder_.reset(new PPCHIRBuilder(frontend));
-  compiler_.reset(new Compiler(frontend->processor()));
   assembler_ = backend->CreateAssembler();
   assembler_->Initialize();
 
+  InitializePipeline(&baseline_pipeline_, false);
+  InitializePipeline(&optimized_pipeline_, true);
+}
+
+void PPCTranslator::InitializePipeline(Pipeline* pipeline, bool optimize) {
+  Backend* backend = frontend_->processor()->backend();
+  pipeline->compiler.reset(new Compiler(frontend_->processor()));
+  auto& compiler = pipeline->compiler;
+
   bool validate = cvars::validate_hir;
 
   // Merge blocks early. This will let us use more context in other passes.
   // The CFG is required for simplification and dirtied by it.
-  compiler_->AddPass(std::make_unique<passes::ControlFlowAnalysisPass>());
-  compiler_->AddPass(std::make_unique<passes::ControlFlowSimplificationPass>());
+  compiler->AddPass(std::make_unique<passes::ControlFlowAnalysisPass>());
+  compiler->AddPass(std::make_unique<passes::ControlFlowSimplificationPass>());
 
   // Passes are executed in the order they are added. Multiple of the same
   // pass type may be used.
-  if (validate) compiler_->AddPass(std::make_unique<passes::ValidationPass>());
-  compiler_->AddPass(std::make_unique<passes::ContextPromotionPass>());
-  if (validate) compiler_->AddPass(std::make_unique<passes::ValidationPass>());
+  if (validate) compiler->AddPass(std::make_unique<passes::ValidationPass>());
+  compiler->AddPass(std::make_unique<passes::ContextPromotionPass>());
+  if (validate) compiler->AddPass(std::make_unique<passes::ValidationPass>());
 
   // Grouped simplification + constant propagation.
   // Loops until no changes are made.
@@ -59,49 +70,72 @@ PPCTranslator::PPCTranslator(PPCFrontend* frontend) : frontend_(frontend) {
   if (validate) sap->AddPass(std::make_unique<passes::ValidationPass>());
   sap->AddPass(std::make_unique<passes::ConstantPropagationPass>());
   if (validate) sap->AddPass(std::make_unique<passes::ValidationPass>());
-  compiler_->AddPass(std::move(sap));
+  compiler->AddPass(std::move(sap));
 
   if (backend->machine_info()->supports_extended_load_store) {
     // Backend supports the advanced LOAD/STORE instructions.
     // These will save us a lot of HIR opcodes.
-    compiler_->AddPass(
+    compiler->AddPass(
         std::make_unique<passes::MemorySequenceCombinationPass>());
     if (validate)
-      compiler_->AddPass(std::make_unique<passes::ValidationPass>());
+      compiler->AddPass(std::make_unique<passes::ValidationPass>());
   }
-  compiler_->AddPass(std::make_unique<passes::SimplificationPass>());
-  if (validate) compiler_->AddPass(std::make_unique<passes::ValidationPass>());
-  // compiler_->AddPass(std::make_unique<passes::DeadStoreEliminationPass>());
+  if (optimize) {
+    // Combined sequences often leave more to fold, so run the whole group to
+    // a fixed point again.
+    auto sap = std::make_unique<passes::ConditionalGroupPass>();
+    sap->AddPass(std::make_unique<passes::SimplificationPass>());
+    if (validate) sap->AddPass(std::make_unique<passes::ValidationPass>());
+    sap->AddPass(std::make_unique<passes::ConstantPropagationPass>());
+    if (validate) sap->AddPass(std::make_unique<passes::ValidationPass>());
+    compiler->AddPass(std::move(sap));
+  } else {
+    compiler->AddPass(std::make_unique<passes::SimplificationPass>());
+    if (validate)
+      compiler->AddPass(std::make_unique<passes::ValidationPass>());
+  }
+  // compiler->AddPass(std::make_unique<passes::DeadStoreEliminationPass>());
   // if (validate)
-  // compiler_->AddPass(std::make_unique<passes::ValidationPass>());
-  compiler_->AddPass(std::make_unique<passes::DeadCodeEliminationPass>());
-  if (validate) compiler_->AddPass(std::make_unique<passes::ValidationPass>());
-
-  //// Removes all unneeded variables. Try not to add new ones after this.
-  // compiler_->AddPass(new passes::ValueReductionPass());
-  // if (validate) compiler_->AddPass(new passes::ValidationPass());
+  // compiler->AddPass(std::make_unique<passes::ValidationPass>());
+  compiler->AddPass(std::make_unique<passes::DeadCodeEliminationPass>());
+  if (validate) compiler->AddPass(std::make_unique<passes::ValidationPass>());
+
+  // Removes all unneeded variables. Try not to add new ones after this.
+  // Too slow to run on everything, but hot functions can afford it.
+  if (optimize) {
+    compiler->AddPass(std::make_unique<passes::ValueReductionPass>());
+    if (validate)
+      compiler->AddPass(std::make_unique<passes::ValidationPass>());
+  }
 
   // Register allocation for the target backend.
   // Will modify the HIR to add loads/stores.
   // This should be the last pass before finalization, as after this all
   // registers are assigned and ready to be emitted.
-  compiler_->AddPass(std::make_unique<passes::RegisterAllocationPass>(
-      backend->machine_info()));
-  if (validate) compiler_->AddPass(std::make_unique<passes::ValidationPass>());
+  auto register_allocation_pass =
+      std::make_unique<passes::RegisterAllocationPass>(
+          backend->machine_info());
+  pipeline->register_allocation_pass = register_allocation_pass.get();
+  compiler->AddPass(std::move(register_allocation_pass));
+  if (validate) compiler->AddPass(std::make_unique<passes::ValidationPass>());
 
   // Must come last. The HIR is not really HIR after this.
-  compiler_->AddPass(std::make_unique<passes::FinalizationPass>());
+  compiler->AddPass(std::make_unique<passes::FinalizationPass>());
 }
 
 PPCTranslator::~PPCTranslator() = default;
 
 bool PPCTranslator::Translate(GuestFunction* function,
-                              uint32_t debug_info_flags) {
+                              uint32_t debug_info_flags,
+                              GuestFunction::Tier tier) {
   SCOPE_profile_cpu_f("cpu");
 
+  bool optimize = tier == GuestFunction::Tier::kOptimized;
+  auto& pipeline = optimize ? optimized_pipeline_ : baseline_pipeline_;
+
   // Reset() all caching when we leave.
   xe::make_reset_scope(builder_);
-  xe::make_reset_scope(compiler_);
+  xe::make_reset_scope(pipeline.compiler);
   xe::make_reset_scope(assembler_);
   xe::make_reset_scope(&string_buffer_);
 
@@ -121,8 +155,19 @@ bool PPCTranslator::Translate(GuestFunction* function,
   if (cvars::trace_function_data) {
     debug_info_flags |= DebugInfoFlags::kDebugInfoTraceFunctionData;
   }
+  // Code the debugger or the trace file refer to has to stay put. Whether
+  // code counts down to its recompilation is only up to the tier, even when
+  // the caller asks for all debug info.
+  debug_info_flags &= ~DebugInfoFlags::kDebugInfoTierUpCounter;
+  if (!optimize && cvars::tiered_compilation && !cvars::debug &&
+      !(debug_info_flags & DebugInfoFlags::kDebugInfoTraceFunctions)) {
+    debug_info_flags |= DebugInfoFlags::kDebugInfoTierUpCounter;
+    *function->tier_up_countdown() = std::max(cvars::tier_up_call_count, 1);
+  }
   std::unique_ptr<FunctionDebugInfo> debug_info;
-  if (debug_info_flags) {
+  // Profiling and tiering only need counters outside of the debug info.
+  if (debug_info_flags & ~(DebugInfoFlags::kDebugInfoProfileFunctions |
+                           DebugInfoFlags::kDebugInfoTierUpCounter)) {
     debug_info.reset(new FunctionDebugInfo());
   }
 
@@ -164,7 +209,7 @@ bool PPCTranslator::Translate(GuestFunction* function,
   if (debug_info) {
     emit_flags |= PPCHIRBuilder::EMIT_DEBUG_COMMENTS;
   }
-  if (!builder_->Emit(function, emit_flags)) {
+  if (!builder_->Emit(function, emit_flags, &scanner_->jump_tables())) {
     return false;
   }
 
@@ -176,9 +221,15 @@ bool PPCTranslator::Translate(GuestFunction* function,
   }
 
   // Compile/optimize/etc.
-  if (!compiler_->Compile(builder_.get())) {
+  if (!pipeline.compiler->Compile(builder_.get())) {
     return false;
   }
+  if (cvars::log_register_allocation_stats) {
+    auto& stats = pipeline.register_allocation_pass->stats();
+    XELOGCPU("%.8X: %u spills, %u reloads, %u rematerializations, %u slots",
+             function->address(), stats.spill_count, stats.reload_count,
+             stats.remat_count, stats.spill_slot_count);
+  }
 
   // Stash optimized HIR.
   if (debug_info_flags & DebugInfoFlags::kDebugInfoDisasmHir) {
@@ -192,6 +243,11 @@ bool PPCTranslator::Translate(GuestFunction* function,
                             std::move(debug_info))) {
     return false;
   }
+  if (optimize) {
+    function->set_tier(GuestFunction::Tier::kOptimized);
+  } else if (debug_info_flags & DebugInfoFlags::kDebugInfoTierUpCounter) {
+    function->set_tier(GuestFunction::Tier::kWarmingUp);
+  }
 
   return true;
 }
@@ -19,6 +19,11 @@
 
 namespace xe {
 namespace cpu {
+namespace compiler {
+namespace passes {
+class RegisterAllocationPass;
+}  // namespace passes
+}  // namespace compiler
 namespace ppc {
 
 class PPCFrontend;
@@ -30,15 +35,27 @@ class PPCTranslator {
   explicit PPCTranslator(PPCFrontend* frontend);
   ~PPCTranslator();
 
-  bool Translate(GuestFunction* function, uint32_t debug_info_flags);
+  // Translates at the given tier, either kBaseline or kOptimized. Functions
+  // already translated are replaced in place.
+  bool Translate(GuestFunction* function, uint32_t debug_info_flags,
+                 GuestFunction::Tier tier = GuestFunction::Tier::kBaseline);
 
  private:
+  struct Pipeline {
+    std::unique_ptr<compiler::Compiler> compiler;
+    // Owned by compiler; kept for its per-function stats.
+    compiler::passes::RegisterAllocationPass* register_allocation_pass =
+        nullptr;
+  };
+
+  void InitializePipeline(Pipeline* pipeline, bool optimize);
   void DumpSource(GuestFunction* function, StringBuffer* string_buffer);
 
   PPCFrontend* frontend_;
   std::unique_ptr<PPCScanner> scanner_;
   std::unique_ptr<PPCHIRBuilder> builder_;
-  std::unique_ptr<compiler::Compiler> compiler_;
+  Pipeline baseline_pipeline_;
+  Pipeline optimized_pipeline_;
   std::unique_ptr<backend::Assembler> assembler_;
 
   StringBuffer string_buffer_;
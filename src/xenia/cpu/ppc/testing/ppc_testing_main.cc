@@ -7,12 +7,23 @@
  ******************************************************************************
  */
 
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+
 #include "xenia/base/filesystem.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/main.h"
 #include "xenia/base/math.h"
 #include "xenia/base/platform.h"
 #include "xenia/cpu/backend/x64/x64_backend.h"
+#include "xenia/cpu/backend/x64/x64_code_cache.h"
+#include "xenia/cpu/backend/x64/x64_code_storage.h"
 #include "xenia/cpu/cpu_flags.h"
 #include "xenia/cpu/ppc/ppc_context.h"
 #include "xenia/cpu/ppc/ppc_frontend.h"
@@ -28,6 +39,54 @@ DEFINE_string(test_path, "src/xenia/cpu/ppc/testing/",
 DEFINE_string(test_bin_path, "src/xenia/cpu/ppc/testing/bin/",
               "Directory with binary outputs of the test files.", "Other");
 DEFINE_transient_string(test_name, "", "Specifies test name.", "General");
+DEFINE_int32(compile_benchmark_iterations, 0,
+             "If nonzero, translates every test function this many times and "
+             "reports compilation throughput instead of running the tests.",
+             "Other");
+DEFINE_bool(test_optimized_tier, false,
+            "Runs each test twice: at the baseline tier, then again after "
+            "recompiling every function it reached at the optimized tier and "
+            "swapping the new code in through the indirection table.",
+            "Other");
+DEFINE_bool(test_stored_code, false,
+            "Runs each test twice: once storing the generated code, then "
+            "again in a fresh processor restoring all of it from storage.",
+            "Other");
+
+DECLARE_bool(debug);
+
+// Counts heap allocations made through operator new while the compile
+// benchmark is measuring, and only then. Otherwise this allocates exactly like
+// the default operator new. Allocations made directly with malloc aren't seen.
+static std::atomic<bool> heap_allocation_counting(false);
+static std::atomic<uint64_t> heap_allocation_count(0);
+static std::atomic<uint64_t> heap_allocation_bytes(0);
+
+void* operator new(size_t size) {
+  if (heap_allocation_counting.load(std::memory_order_relaxed)) {
+    heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    heap_allocation_bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+  if (!size) {
+    size = 1;
+  }
+  while (true) {
+    void* p = std::malloc(size);
+    if (p) {
+      return p;
+    }
+    auto new_handler = std::get_new_handler();
+    if (!new_handler) {
+      throw std::bad_alloc();
+    }
+    new_handler();
+  }
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t size) noexcept { std::free(p); }
+void operator delete[](void* p, size_t size) noexcept { std::free(p); }
 
 namespace xe {
 namespace cpu {
@@ -74,6 +133,8 @@ class TestSuite {
   std::wstring map_file_path;
   std::wstring bin_file_path;
   std::vector<TestCase> test_cases;
+  // All local labels in the binary, for annotations that name functions.
+  std::map<std::string, uint32_t> symbols;
 
  private:
   std::wstring ReplaceExtension(const std::wstring& path,
@@ -108,13 +169,18 @@ class TestSuite {
       if (newline) {
         *newline = 0;
       }
-      char* t_test_ = strstr(line_buffer, " t test_");
-      if (!t_test_) {
+      char* t_ = strstr(line_buffer, " t ");
+      if (!t_) {
         continue;
       }
-      std::string address(line_buffer, t_test_ - line_buffer);
-      std::string name(t_test_ + strlen(" t test_"));
-      test_cases.emplace_back(START_ADDRESS + std::stoul(address, 0, 16), name);
+      std::string address_str(line_buffer, t_ - line_buffer);
+      uint32_t address = START_ADDRESS + std::stoul(address_str, 0, 16);
+      std::string label(t_ + strlen(" t "));
+      symbols[label] = address;
+      if (strncmp(label.c_str(), "test_", strlen("test_")) == 0) {
+        std::string name(label.substr(strlen("test_")));
+        test_cases.emplace_back(address, name);
+      }
     }
     fclose(f);
     return true;
@@ -207,7 +273,13 @@ class TestRunner {
     // Setup a fresh processor.
     processor.reset(new Processor(memory.get(), nullptr));
     processor->Setup(std::move(backend));
-    processor->set_debug_info_flags(DebugInfoFlags::kDebugInfoAll);
+    if (cvars::test_optimized_tier || cvars::test_stored_code) {
+      // Traced code can't be replaced or stored, so only keep the disassembly
+      // for dumps.
+      processor->set_debug_info_flags(DebugInfoFlags::kDebugInfoAllDisasm);
+    } else {
+      processor->set_debug_info_flags(DebugInfoFlags::kDebugInfoAll);
+    }
 
     // Load the binary module.
     auto module = std::make_unique<xe::cpu::RawModule>(processor.get());
@@ -215,8 +287,21 @@ class TestRunner {
       XELOGE("Unable to load test binary %ls", suite.bin_file_path.c_str());
       return false;
     }
+    uint32_t image_size = module->image_size();
     processor->AddModule(std::move(module));
 
+    if (cvars::test_stored_code) {
+      // All tests share one title, kept next to the executable. Code stored
+      // for another binary is out of date and gets replaced.
+      if (!processor->backend()->InitializeCodeStorage(
+              xe::filesystem::GetExecutableFolder(), 0xFFFE0000,
+              START_ADDRESS, image_size) ||
+          !code_storage()) {
+        XELOGE("Unable to initialize generated code storage");
+        return false;
+      }
+    }
+
     processor->backend()->CommitExecutableRange(START_ADDRESS,
                                                 START_ADDRESS + 1024 * 1024);
 
@@ -226,17 +311,23 @@ class TestRunner {
         kMemoryAllocationReserve | kMemoryAllocationCommit,
         kMemoryProtectRead | kMemoryProtectWrite);
 
-    // Simulate a thread.
+    ResetThreadState();
+
+    return true;
+  }
+
+  // Simulates a fresh thread, with cleared registers and dummy memory.
+  void ResetThreadState() {
+    thread_state.reset();
+    std::memset(memory->TranslateVirtual(0x10001000), 0, 0xEFFF);
     uint32_t stack_size = 64 * 1024;
     uint32_t stack_address = START_ADDRESS - stack_size;
     uint32_t pcr_address = stack_address - 0x1000;
     thread_state.reset(
         new ThreadState(processor.get(), 0x100, stack_address, pcr_address));
-
-    return true;
   }
 
-  bool Run(TestCase& test_case) {
+  bool Run(TestSuite& suite, TestCase& test_case) {
     // Setup test state from annotations.
     if (!SetupTestState(test_case)) {
       XELOGE("Test setup failed");
@@ -251,21 +342,107 @@ class TestRunner {
     }
 
     auto ctx = thread_state->context();
+    if (cvars::test_optimized_tier) {
+      // The baseline run defines everything the test reaches. Only the
+      // results of the optimized run are checked.
+      ctx->lr = 0xBCBCBCBC;
+      fn->Call(thread_state.get(), uint32_t(ctx->lr));
+      if (!OptimizeFunctions()) {
+        return false;
+      }
+      ResetThreadState();
+      SetupTestState(test_case);
+      ctx = thread_state->context();
+    }
+    size_t stored_function_count = 0;
+    if (cvars::test_stored_code) {
+      // The first run stores everything it defines, which is written out when
+      // its processor shuts down. Only the run in a fresh processor restoring
+      // that code is checked.
+      ctx->lr = 0xBCBCBCBC;
+      fn->Call(thread_state.get(), uint32_t(ctx->lr));
+      stored_function_count = code_storage()->restored_function_count() +
+                              code_storage()->pending_function_count();
+      thread_state.reset();
+      if (!Setup(suite) || !SetupTestState(test_case)) {
+        XELOGE("Test setup failed");
+        return false;
+      }
+      fn = processor->ResolveFunction(test_case.address);
+      if (!fn) {
+        XELOGE("Entry function not found");
+        return false;
+      }
+      ctx = thread_state->context();
+    }
     ctx->lr = 0xBCBCBCBC;
     fn->Call(thread_state.get(), uint32_t(ctx->lr));
 
     // Assert test state expectations.
-    bool result = CheckTestResults(test_case);
+    bool result = CheckTestResults(suite, test_case);
+    if (cvars::test_stored_code &&
+        code_storage()->restored_function_count() != stored_function_count) {
+      XELOGE("Only %zu of %zu stored functions were restored",
+             code_storage()->restored_function_count(), stored_function_count);
+      result = false;
+    }
     if (!result) {
-      // Also dump all disasm/etc.
-      if (fn->is_guest()) {
-        static_cast<xe::cpu::GuestFunction*>(fn)->debug_info()->Dump();
+      // Also dump all disasm/etc. Restored code has none.
+      auto guest_function = fn->is_guest()
+                                ? static_cast<xe::cpu::GuestFunction*>(fn)
+                                : nullptr;
+      if (guest_function && guest_function->debug_info()) {
+        guest_function->debug_info()->Dump();
       }
     }
 
     return result;
   }
 
+  // Recompiles every defined guest function at the optimized tier, the way the
+  // background compiler does for hot functions, and checks that calls are now
+  // dispatched to the new code.
+  bool OptimizeFunctions() {
+    std::vector<GuestFunction*> functions;
+    for (auto module : processor->GetModules()) {
+      module->ForEachFunction([&](Function* function) {
+        if (function->is_guest() &&
+            function->status() == Symbol::Status::kDefined) {
+          functions.push_back(static_cast<GuestFunction*>(function));
+        }
+      });
+    }
+    bool any_failed = false;
+    for (auto function : functions) {
+      if (!processor->OptimizeFunction(function)) {
+        any_failed = true;
+        XELOGE("Function %.8X failed to optimize", function->address());
+        continue;
+      }
+#if defined(XENIA_HAS_X64_BACKEND) && XENIA_HAS_X64_BACKEND
+      auto code_cache = static_cast<xe::cpu::backend::x64::X64CodeCache*>(
+          processor->backend()->code_cache());
+      auto machine_code = function->installed_function()->machine_code();
+      if (code_cache->LookupIndirection(function->address()) !=
+          uint32_t(reinterpret_cast<uintptr_t>(machine_code))) {
+        any_failed = true;
+        XELOGE("Function %.8X is still dispatched to its baseline code",
+               function->address());
+      }
+#endif  // XENIA_HAS_X64_BACKEND
+    }
+    return !any_failed;
+  }
+
+  xe::cpu::backend::x64::X64CodeStorage* code_storage() {
+#if defined(XENIA_HAS_X64_BACKEND) && XENIA_HAS_X64_BACKEND
+    return static_cast<xe::cpu::backend::x64::X64Backend*>(processor->backend())
+        ->code_storage();
+#else
+    return nullptr;
+#endif  // XENIA_HAS_X64_BACKEND
+  }
+
   bool SetupTestState(TestCase& test_case) {
     auto ppc_context = thread_state->context();
     for (auto& it : test_case.annotations) {
@@ -297,7 +474,7 @@ class TestRunner {
     return true;
   }
 
-  bool CheckTestResults(TestCase& test_case) {
+  bool CheckTestResults(TestSuite& suite, TestCase& test_case) {
     auto ppc_context = thread_state->context();
 
     char actual_value[2048];
@@ -343,6 +520,59 @@ class TestRunner {
           }
           ++p;
         }
+      } else if (it.first == "INLINED" || it.first == "BRANCH_TARGET") {
+        // Neither inlined calls nor branches within a function resolve a
+        // function at the target.
+        auto symbol = suite.symbols.find(it.second);
+        if (symbol == suite.symbols.end()) {
+          any_failed = true;
+          XELOGE("Label %s not found\n", it.second.c_str());
+        } else if (processor->QueryFunction(symbol->second)) {
+          any_failed = true;
+          XELOGE("Function %s assert failed:\n", it.second.c_str());
+          if (it.first == "INLINED") {
+            XELOGE("  Expected: inlined into every caller\n");
+          } else {
+            XELOGE("  Expected: only branched to within its function\n");
+          }
+          XELOGE("    Actual: resolved at %.8X\n", symbol->second);
+        }
+      } else if (it.first == "CALL_COUNT") {
+        // Counters are only kept by profiled code.
+        if (!(processor->debug_info_flags() &
+              DebugInfoFlags::kDebugInfoProfileFunctions)) {
+          continue;
+        }
+        size_t space_pos = it.second.find(" ");
+        auto label = it.second.substr(0, space_pos);
+        uint64_t expected_count =
+            std::strtoull(it.second.c_str() + space_pos + 1, nullptr, 0);
+        auto symbol = suite.symbols.find(label);
+        if (symbol == suite.symbols.end()) {
+          any_failed = true;
+          XELOGE("Label %s not found\n", label.c_str());
+          continue;
+        }
+        auto function = processor->QueryFunction(symbol->second);
+        FunctionTraceData::ProfileCounters counters = {};
+        if (function && function->is_guest()) {
+          counters = *static_cast<GuestFunction*>(function)
+                          ->trace_data()
+                          .profile_counters();
+        }
+        if (counters.call_count != expected_count) {
+          any_failed = true;
+          XELOGE("Function %s assert failed:\n", label.c_str());
+          XELOGE("  Expected: %" PRIu64 " calls\n", expected_count);
+          XELOGE("    Actual: %" PRIu64 " calls\n", counters.call_count);
+        }
+        if (counters.exclusive_cycles > counters.inclusive_cycles) {
+          any_failed = true;
+          XELOGE("Function %s assert failed:\n", label.c_str());
+          XELOGE("  Expected: exclusive time <= inclusive time\n");
+          XELOGE("    Actual: %" PRIu64 " > %" PRIu64 " cycles\n",
+                 counters.exclusive_cycles, counters.inclusive_cycles);
+        }
       }
     }
     return !any_failed;
@@ -386,7 +616,7 @@ void ProtectedRunTest(TestSuite& test_suite, TestRunner& runner,
       XELOGE("    TEST FAILED SETUP");
       ++failed_count;
     }
-    if (runner.Run(test_case)) {
+    if (runner.Run(test_suite, test_case)) {
       ++passed_count;
     } else {
       XELOGE("    TEST FAILED");
@@ -401,6 +631,84 @@ void ProtectedRunTest(TestSuite& test_suite, TestRunner& runner,
 #endif  // XE_COMPILER_MSVC
 }
 
+// Repeatedly translates each test function through the full frontend and
+// backend pipeline, the same way the processor does on first call.
+bool RunCompileBenchmark(std::vector<TestSuite>& test_suites) {
+  uint32_t iteration_count = uint32_t(cvars::compile_benchmark_iterations);
+  uint64_t function_count = 0;
+  uint64_t allocation_count = 0;
+  uint64_t allocation_bytes = 0;
+  bool stopped_early = false;
+  std::chrono::steady_clock::duration duration(0);
+
+  TestRunner runner;
+  for (auto& test_suite : test_suites) {
+    if (!runner.Setup(test_suite)) {
+      XELOGE("%ls.s: setup failed", test_suite.name.c_str());
+      return false;
+    }
+    auto processor = runner.processor.get();
+    // Code from earlier iterations is never reclaimed, and each suite gets a
+    // fresh processor. Half of the cache leaves room for the data and padding
+    // placed alongside the code.
+    size_t code_budget = processor->backend()->code_cache()->total_size() / 2;
+    size_t code_size = 0;
+    for (auto& test_case : test_suite.test_cases) {
+      auto function = processor->LookupFunction(test_case.address);
+      if (!function || !function->is_guest()) {
+        XELOGE("%s: function not found", test_case.name.c_str());
+        return false;
+      }
+      auto guest_function = static_cast<GuestFunction*>(function);
+
+      // Warm up the translator pool and its scratch memory.
+      if (!processor->frontend()->DefineFunction(guest_function, 0)) {
+        XELOGE("%s: translation failed", test_case.name.c_str());
+        return false;
+      }
+      code_size += guest_function->machine_code_length();
+
+      uint64_t start_allocation_count = heap_allocation_count;
+      uint64_t start_allocation_bytes = heap_allocation_bytes;
+      heap_allocation_counting = true;
+      auto start_time = std::chrono::steady_clock::now();
+      uint32_t i = 0;
+      for (; i < iteration_count; ++i) {
+        size_t machine_code_length = guest_function->machine_code_length();
+        if (code_size + machine_code_length > code_budget) {
+          stopped_early = true;
+          break;
+        }
+        processor->frontend()->DefineFunction(guest_function, 0);
+        code_size += machine_code_length;
+      }
+      duration += std::chrono::steady_clock::now() - start_time;
+      heap_allocation_counting = false;
+      allocation_count += heap_allocation_count - start_allocation_count;
+      allocation_bytes += heap_allocation_bytes - start_allocation_bytes;
+      function_count += i;
+    }
+  }
+  if (stopped_early) {
+    XELOGW("Stopped translating early to stay within the code cache; use "
+           "fewer iterations to cover every function");
+  }
+  if (!function_count) {
+    XELOGE("No functions translated");
+    return false;
+  }
+
+  double seconds = std::chrono::duration<double>(duration).count();
+  XELOGI("Translated %" PRIu64 " functions in %.3fs", function_count, seconds);
+  XELOGI("  %.0f functions/second",
+         seconds > 0 ? function_count / seconds : 0.0);
+  XELOGI("  %.2f heap allocations/function",
+         double(allocation_count) / function_count);
+  XELOGI("  %.0f heap bytes allocated/function",
+         double(allocation_bytes) / function_count);
+  return true;
+}
+
 bool RunTests(const std::wstring& test_name) {
   int result_code = 1;
   int failed_count = 0;
@@ -438,6 +746,17 @@ bool RunTests(const std::wstring& test_name) {
   }
 
   XELOGI("%d tests loaded.", (int)test_suites.size());
+  if (cvars::compile_benchmark_iterations > 0) {
+    return RunCompileBenchmark(test_suites);
+  }
+  if (cvars::test_optimized_tier) {
+    // Baseline code counts down to its recompilation, but the runner does it
+    // itself after the first run instead of leaving it to call counts.
+    cvars::debug = false;
+    cvars::tiered_compilation = true;
+    cvars::tier_up_call_count = INT_MAX;
+  }
+
   TestRunner runner;
   for (auto& test_suite : test_suites) {
     XELOGI("%ls.s:", test_suite.name.c_str());
@@ -13,6 +13,7 @@ project("xenia-cpu-ppc-tests")
     "xenia-base",
     "capstone", -- cpu-backend-x64
     "mspack",
+    "xxhash", -- cpu-backend-x64
   })
   files({
     "ppc_testing_main.cc",
@@ -0,0 +1,33 @@
+leaf_add:
+  add r3, r3, r4
+  addi r3, r3, 1
+  blr
+
+leaf_mflr:
+  mfspr r8, lr
+  blr
+
+leaf_set:
+  li r5, 7
+  blr
+
+test_inline_leaf:
+  mfspr r12, lr
+  li r3, 2
+  li r4, 3
+  bl leaf_add
+  mr r6, r3
+  bl leaf_mflr
+.after_mflr:
+  lis r9, .after_mflr@ha
+  addi r9, r9, .after_mflr@l
+  subf r7, r9, r8
+  rlwinm r7, r7, 0, 0, 31
+  mtspr lr, r12
+  b leaf_set
+  #_ REGISTER_OUT r5 7
+  #_ REGISTER_OUT r6 6
+  #_ REGISTER_OUT r7 0
+  #_ INLINED leaf_add
+  #_ INLINED leaf_mflr
+  #_ INLINED leaf_set
@@ -0,0 +1,50 @@
+the_switch:
+  cmplwi cr6, r3, 3
+  bgt cr6, .switch_default
+  lis r11, .switch_table@ha
+  slwi r0, r3, 2
+  addi r11, r11, .switch_table@l
+  lwzx r0, r11, r0
+  mtspr ctr, r0
+  bctr
+.switch_case_0:
+  li r4, 10
+  blr
+.switch_case_1:
+  li r4, 11
+  blr
+.switch_case_2_3:
+  li r4, 12
+  blr
+.switch_default:
+  li r4, 13
+  blr
+.switch_table:
+  .long .switch_case_0
+  .long .switch_case_1
+  .long .switch_case_2_3
+  .long .switch_case_2_3
+
+test_jumptable_dispatch:
+  mfspr r12, lr
+  li r3, 0
+  bl the_switch
+  mr r5, r4
+  li r3, 1
+  bl the_switch
+  mr r6, r4
+  li r3, 3
+  bl the_switch
+  mr r7, r4
+  li r3, 4
+  bl the_switch
+  mr r8, r4
+  mtspr lr, r12
+  blr
+  #_ REGISTER_OUT r5 10
+  #_ REGISTER_OUT r6 11
+  #_ REGISTER_OUT r7 12
+  #_ REGISTER_OUT r8 13
+  #_ BRANCH_TARGET .switch_case_0
+  #_ BRANCH_TARGET .switch_case_1
+  #_ BRANCH_TARGET .switch_case_2_3
@@ -0,0 +1,31 @@
+# Loops, so calls to it are never inlined.
+nested_leaf:
+  mtspr ctr, r4
+.nested_leaf_loop:
+  addi r3, r3, 1
+  bdnz .nested_leaf_loop
+  blr
+
+# Calls, so calls to it are never inlined either.
+nested_middle:
+  mfspr r12, lr
+  bl nested_leaf
+  bl nested_leaf
+  mtspr lr, r12
+  blr
+
+# Time spent in the callees counts towards the caller's inclusive time only.
+test_profile_nested_calls:
+  mfspr r11, lr
+  li r3, 0
+  li r4, 10
+  bl nested_middle
+  bl nested_middle
+  bl nested_middle
+  bl nested_leaf
+  mtspr lr, r11
+  blr
+  #_ REGISTER_OUT r3 70
+  #_ CALL_COUNT test_profile_nested_calls 1
+  #_ CALL_COUNT nested_middle 3
+  #_ CALL_COUNT nested_leaf 7
@@ -0,0 +1,282 @@
+# More values live at once than the x64 backend has registers for (7 GPRs
+# and 12 XMMs), combined in an order where swapping any two would change the
+# result.
+test_reg_pressure_spill:
+  #_ REGISTER_IN r3 0x1000
+  addi r14, r3, 1
+  mulli r15, r3, 2
+  xori r16, r3, 34
+  addi r17, r3, 4
+  mulli r18, r3, 5
+  xori r19, r3, 85
+  addi r20, r3, 7
+  mulli r21, r3, 8
+  xori r22, r3, 136
+  addi r23, r3, 10
+  mulli r24, r3, 11
+  xori r25, r3, 187
+  addi r26, r3, 13
+  mulli r27, r3, 14
+  xori r28, r3, 238
+  addi r29, r3, 16
+  mr r30, r14
+  add r30, r30, r30
+  add r30, r30, r15
+  add r30, r30, r30
+  add r30, r30, r16
+  add r30, r30, r30
+  add r30, r30, r17
+  add r30, r30, r30
+  add r30, r30, r18
+  add r30, r30, r30
+  add r30, r30, r19
+  add r30, r30, r30
+  add r30, r30, r20
+  add r30, r30, r30
+  add r30, r30, r21
+  add r30, r30, r30
+  add r30, r30, r22
+  add r30, r30, r30
+  add r30, r30, r23
+  add r30, r30, r30
+  add r30, r30, r24
+  add r30, r30, r30
+  add r30, r30, r25
+  add r30, r30, r30
+  add r30, r30, r26
+  add r30, r30, r30
+  add r30, r30, r27
+  add r30, r30, r30
+  add r30, r30, r28
+  add r30, r30, r30
+  add r30, r30, r29
+  blr
+  #_ REGISTER_OUT r14 0x1001
+  #_ REGISTER_OUT r29 0x1010
+  #_ REGISTER_OUT r30 0x168de684
+
+# Values retire while others are still spilled, so their spill slots are
+# reused within the block and again in the next one.
+test_reg_pressure_slot_reuse:
+  #_ REGISTER_IN r3 0x100
+  #_ REGISTER_IN r4 0x7
+  addi r14, r3, 1
+  addi r15, r3, 4
+  addi r16, r3, 7
+  addi r17, r3, 10
+  addi r18, r3, 13
+  addi r19, r3, 16
+  addi r20, r3, 19
+  addi r21, r3, 22
+  addi r22, r3, 25
+  addi r23, r3, 28
+  mr r30, r14
+  add r30, r30, r30
+  add r30, r30, r15
+  add r30, r30, r30
+  add r30, r30, r16
+  add r30, r30, r30
+  add r30, r30, r17
+  add r30, r30, r30
+  add r30, r30, r18
+  mulli r24, r4, 2
+  mulli r25, r4, 3
+  mulli r26, r4, 4
+  mulli r27, r4, 5
+  mulli r28, r4, 6
+  mulli r29, r4, 7
+  mr r31, r19
+  add r31, r31, r31
+  add r31, r31, r20
+  add r31, r31, r31
+  add r31, r31, r21
+  add r31, r31, r31
+  add r31, r31, r22
+  add r31, r31, r31
+  add r31, r31, r23
+  add r31, r31, r31
+  add r31, r31, r24
+  add r31, r31, r31
+  add r31, r31, r25
+  add r31, r31, r31
+  add r31, r31, r26
+  add r31, r31, r31
+  add r31, r31, r27
+  add r31, r31, r31
+  add r31, r31, r28
+  add r31, r31, r31
+  add r31, r31, r29
+  cmplwi cr6, r4, 0
+  beq cr6, .slot_reuse_done
+  addi r14, r30, 0
+  addi r15, r31, -1
+  addi r16, r30, -2
+  addi r17, r31, -3
+  addi r18, r30, -4
+  addi r19, r31, -5
+  addi r20, r30, -6
+  addi r21, r31, -7
+  addi r22, r30, -8
+  addi r23, r31, -9
+  addi r24, r30, -10
+  addi r25, r31, -11
+  mr r12, r14
+  add r12, r12, r12
+  add r12, r12, r15
+  add r12, r12, r12
+  add r12, r12, r16
+  add r12, r12, r12
+  add r12, r12, r17
+  add r12, r12, r12
+  add r12, r12, r18
+  add r12, r12, r12
+  add r12, r12, r19
+  add r12, r12, r12
+  add r12, r12, r20
+  add r12, r12, r12
+  add r12, r12, r21
+  add r12, r12, r12
+  add r12, r12, r22
+  add r12, r12, r12
+  add r12, r12, r23
+  add r12, r12, r12
+  add r12, r12, r24
+  add r12, r12, r12
+  add r12, r12, r25
+.slot_reuse_done:
+  blr
+  #_ REGISTER_OUT r30 0x1f6d
+  #_ REGISTER_OUT r31 0x85481
+  #_ REGISTER_OUT r12 0x2db9a444
+
+# Rotates of a constant aren't folded, so they're recomputed instead of
+# being spilled. They're used last so they're the ones picked.
+test_reg_pressure_remat:
+  #_ REGISTER_IN r4 0x1111
+  lis r3, 0x1234
+  ori r3, r3, 0x5678
+  rldicl r14, r3, 4, 0
+  rldicl r15, r3, 8, 0
+  rldicl r16, r3, 12, 0
+  rldicl r17, r3, 16, 0
+  rldicl r18, r3, 20, 0
+  rldicl r19, r3, 24, 0
+  rldicl r20, r3, 28, 0
+  rldicl r21, r3, 32, 0
+  addi r22, r4, 1
+  addi r23, r4, 2
+  addi r24, r4, 3
+  addi r25, r4, 4
+  addi r26, r4, 5
+  addi r27, r4, 6
+  mr r30, r22
+  add r30, r30, r30
+  add r30, r30, r23
+  add r30, r30, r30
+  add r30, r30, r24
+  add r30, r30, r30
+  add r30, r30, r25
+  add r30, r30, r30
+  add r30, r30, r26
+  add r30, r30, r30
+  add r30, r30, r27
+  add r30, r30, r30
+  add r30, r30, r21
+  add r30, r30, r30
+  add r30, r30, r20
+  add r30, r30, r30
+  add r30, r30, r19
+  add r30, r30, r30
+  add r30, r30, r18
+  add r30, r30, r30
+  add r30, r30, r17
+  add r30, r30, r30
+  add r30, r30, r16
+  add r30, r30, r30
+  add r30, r30, r15
+  add r30, r30, r30
+  add r30, r30, r14
+  blr
+  #_ REGISTER_OUT r14 0x123456780
+  #_ REGISTER_OUT r21 0x1234567800000000
+  #_ REGISTER_OUT r30 0x6555eb5ad183fe80
+
+# Float and integer values spilled at the same time need separate slots.
+test_reg_pressure_float:
+  #_ REGISTER_IN r3 0x40
+  #_ REGISTER_IN f1 1.0
+  #_ REGISTER_IN f2 2.0
+  fadd f14, f1, f2
+  fadd f15, f14, f2
+  fadd f16, f15, f2
+  fadd f17, f16, f2
+  fadd f18, f17, f2
+  fadd f19, f18, f2
+  fadd f20, f19, f2
+  fadd f21, f20, f2
+  fadd f22, f21, f2
+  fadd f23, f22, f2
+  fadd f24, f23, f2
+  fadd f25, f24, f2
+  fadd f26, f25, f2
+  fadd f27, f26, f2
+  addi r14, r3, 0
+  addi r15, r3, 5
+  addi r16, r3, 10
+  addi r17, r3, 15
+  addi r18, r3, 20
+  addi r19, r3, 25
+  addi r20, r3, 30
+  addi r21, r3, 35
+  addi r22, r3, 40
+  addi r23, r3, 45
+  fmr f30, f27
+  fadd f30, f30, f30
+  fsub f30, f30, f26
+  fadd f30, f30, f30
+  fsub f30, f30, f25
+  fadd f30, f30, f30
+  fsub f30, f30, f24
+  fadd f30, f30, f30
+  fsub f30, f30, f23
+  fadd f30, f30, f30
+  fsub f30, f30, f22
+  fadd f30, f30, f30
+  fsub f30, f30, f21
+  fadd f30, f30, f30
+  fsub f30, f30, f20
+  fadd f30, f30, f30
+  fsub f30, f30, f19
+  fadd f30, f30, f30
+  fsub f30, f30, f18
+  fadd f30, f30, f30
+  fsub f30, f30, f17
+  fadd f30, f30, f30
+  fsub f30, f30, f16
+  fadd f30, f30, f30
+  fsub f30, f30, f15
+  fadd f30, f30, f30
+  fsub f30, f30, f14
+  mr r30, r23
+  add r30, r30, r30
+  add r30, r30, r22
+  add r30, r30, r30
+  add r30, r30, r21
+  add r30, r30, r30
+  add r30, r30, r20
+  add r30, r30, r30
+  add r30, r30, r19
+  add r30, r30, r30
+  add r30, r30, r18
+  add r30, r30, r30
+  add r30, r30, r17
+  add r30, r30, r30
+  add r30, r30, r16
+  add r30, r30, r30
+  add r30, r30, r15
+  add r30, r30, r30
+  add r30, r30, r14
+  blr
+  #_ REGISTER_OUT f27 29.0
+  #_ REGISTER_OUT f30 32767.0
+  #_ REGISTER_OUT r30 0x19fca
@@ -9,6 +9,9 @@
 
 #include "xenia/cpu/processor.h"
 
+#include <algorithm>
+#include <cinttypes>
+
 #include "xenia/base/assert.h"
 #include "xenia/base/atomic.h"
 #include "xenia/base/byte_order.h"
@@ -20,9 +23,11 @@
 #include "xenia/base/memory.h"
 #include "xenia/base/profiling.h"
 #include "xenia/base/threading.h"
+#include "xenia/cpu/background_compiler.h"
 #include "xenia/cpu/breakpoint.h"
 #include "xenia/cpu/cpu_flags.h"
 #include "xenia/cpu/export_resolver.h"
+#include "xenia/cpu/function_profiler.h"
 #include "xenia/cpu/module.h"
 #include "xenia/cpu/ppc/ppc_decode_data.h"
 #include "xenia/cpu/ppc/ppc_frontend.h"
@@ -82,12 +87,31 @@ Processor::Processor(xe::Memory* memory, ExportResolver* export_resolver)
     : memory_(memory), export_resolver_(export_resolver) {}
 
 Processor::~Processor() {
+  // Workers resolve through modules and the backend, so stop them first.
+  background_compiler_.reset();
+
+  // Report while the modules holding the counters are still around.
+  if (function_profiler_) {
+    function_profiler_->Report();
+    function_profiler_.reset();
+  }
+
   {
     auto global_lock = global_critical_region_.Acquire();
+    for (const auto& module : modules_) {
+      auto& symbol_lock = module->symbol_lock();
+      XELOGCPU("Module %s symbol lock: %" PRIu64 " acquisitions, %" PRIu64
+               " contended",
+               module->name().c_str(), symbol_lock.acquire_count(),
+               symbol_lock.contended_count());
+    }
     modules_.clear();
   }
 
   frontend_.reset();
+  if (backend_) {
+    backend_->ShutdownCodeStorage();
+  }
   backend_.reset();
 
   if (functions_trace_file_) {
@@ -146,6 +170,19 @@ bool Processor::Setup(std::unique_ptr<backend::Backend> backend) {
         functions_trace_path_, 32 * 1024 * 1024, true);
   }
 
+  if (cvars::tiered_compilation) {
+    CreateBackgroundCompiler();
+  }
+
+  if (cvars::profile_functions) {
+    debug_info_flags_ |= DebugInfoFlags::kDebugInfoProfileFunctions;
+    function_profiler_ = std::make_unique<FunctionProfiler>(this);
+    if (cvars::profile_functions_report_interval > 0) {
+      function_profiler_->StartPeriodicReports(std::chrono::seconds(
+          cvars::profile_functions_report_interval));
+    }
+  }
+
   return true;
 }
 
@@ -161,6 +198,101 @@ void Processor::PreLaunch() {
   }
 }
 
+void Processor::InitializeCodeStorage(const std::wstring& storage_root,
+                                      uint32_t title_id, XexModule* module) {
+  if (!cvars::store_generated_code || storage_root.empty()) {
+    return;
+  }
+  // Stored code carries none of the debug/tracing instrumentation.
+  if (debug_info_flags_ || cvars::disassemble_functions ||
+      cvars::trace_functions || cvars::trace_function_coverage ||
+      cvars::trace_function_references || cvars::trace_function_data) {
+    XELOGW("Not storing generated code as debug info or tracing is enabled");
+    return;
+  }
+  if (!backend_->InitializeCodeStorage(storage_root, title_id,
+                                       module->base_address(),
+                                       module->image_size())) {
+    XELOGW("Unable to initialize generated code storage");
+  }
+}
+
+void Processor::StartBackgroundCompilation(Module* module,
+                                           uint32_t entry_point) {
+  if (!cvars::background_compile_threads) {
+    return;
+  }
+  if (!background_compiler_) {
+    CreateBackgroundCompiler();
+  }
+
+  // The entry point is needed first; everything else it calls is discovered
+  // by the scanner as functions are translated.
+  if (entry_point) {
+    background_compiler_->Enqueue(entry_point);
+  }
+  module->ForEachFunction([this](Function* function) {
+    if (function->is_guest()) {
+      background_compiler_->Enqueue(function->address());
+    }
+  });
+}
+
+void Processor::PrecompileFunction(uint32_t address) {
+  if (background_compiler_) {
+    background_compiler_->Enqueue(address);
+  }
+}
+
+void Processor::RequestOptimization(GuestFunction* function) {
+  if (background_compiler_) {
+    background_compiler_->EnqueueOptimization(function);
+  }
+}
+
+bool Processor::OptimizeFunction(GuestFunction* function) {
+  if (function->status() != Symbol::Status::kDefined ||
+      function->tier() != GuestFunction::Tier::kWarmingUp) {
+    return false;
+  }
+  // The optimized code goes into a code object of its own, with its own
+  // source map and debug info. The baseline code object is left untouched and
+  // never freed, so threads still running it, stack walks and the debugger
+  // keep resolving its host PCs. New calls pick up the optimized code through
+  // the indirection table. If this fails the baseline code simply keeps
+  // being used.
+  auto optimized_function =
+      backend_->CreateGuestFunction(function->module(), function->address());
+  optimized_function->set_name(function->name());
+  optimized_function->set_end_address(function->end_address());
+  optimized_function->set_behavior(function->behavior());
+  if (!frontend_->DefineFunction(optimized_function.get(), debug_info_flags_,
+                                 GuestFunction::Tier::kOptimized)) {
+    XELOGW("Unable to optimize function %.8X", function->address());
+    return false;
+  }
+  optimized_function->set_status(Symbol::Status::kDefined);
+  function->set_optimized_function(std::move(optimized_function));
+  function->set_tier(GuestFunction::Tier::kOptimized);
+  return true;
+}
+
+void Processor::CreateBackgroundCompiler() {
+  uint32_t logical_processor_count = xe::threading::logical_processor_count();
+  uint32_t thread_count;
+  if (cvars::background_compile_threads < 0) {
+    thread_count = std::max(logical_processor_count / 2, uint32_t(1));
+  } else {
+    // Tiered compilation needs a thread even without ahead of time work.
+    thread_count = std::max(
+        std::min(uint32_t(cvars::background_compile_threads),
+                 logical_processor_count),
+        uint32_t(1));
+  }
+  background_compiler_ =
+      std::make_unique<BackgroundCompiler>(this, thread_count);
+}
+
 bool Processor::AddModule(std::unique_ptr<Module> module) {
   auto global_lock = global_critical_region_.Acquire();
   modules_.push_back(std::move(module));
@@ -217,6 +349,11 @@ std::vector<Function*> Processor::FindFunctionsWithAddress(uint32_t address) {
 }
 
 Function* Processor::ResolveFunction(uint32_t address) {
+  if (background_compiler_) {
+    // If a worker is translating this we may be about to wait on it.
+    background_compiler_->Boost(address);
+  }
+
   Entry* entry;
   Entry::Status status = entry_table_.GetOrCreate(address, &entry);
   if (status == Entry::STATUS_NEW) {
@@ -225,17 +362,18 @@ Function* Processor::ResolveFunction(uint32_t address) {
     // Grab symbol declaration.
     auto function = LookupFunction(address);
     if (!function) {
-      entry->status = Entry::STATUS_FAILED;
+      entry_table_.Complete(entry, Entry::STATUS_FAILED);
       return nullptr;
     }
 
     if (!DemandFunction(function)) {
-      entry->status = Entry::STATUS_FAILED;
+      entry_table_.Complete(entry, Entry::STATUS_FAILED);
       return nullptr;
     }
     entry->function = function;
     entry->end_address = function->end_address();
-    status = entry->status = Entry::STATUS_READY;
+    status = Entry::STATUS_READY;
+    entry_table_.Complete(entry, status);
   }
   if (status == Entry::STATUS_READY) {
     // Ready to use.
@@ -293,10 +431,12 @@ bool Processor::DemandFunction(Function* function) {
   auto module = function->module();
   auto symbol_status = module->DefineFunction(function);
   if (symbol_status == Symbol::Status::kNew) {
-    // Symbol is undefined, so define now.
+    // Symbol is undefined, so define now. Code stored by a previous run
+    // skips the frontend entirely.
     assert_true(function->is_guest());
-    if (!frontend_->DefineFunction(static_cast<GuestFunction*>(function),
-                                   debug_info_flags_)) {
+    auto guest_function = static_cast<GuestFunction*>(function);
+    if (!backend_->RestoreFunction(guest_function) &&
+        !frontend_->DefineFunction(guest_function, debug_info_flags_)) {
       function->set_status(Symbol::Status::kFailed);
       return false;
     }
@@ -393,10 +533,11 @@ uint64_t Processor::ExecuteInterrupt(ThreadState* thread_state,
                                      size_t arg_count) {
   SCOPE_profile_cpu_f("cpu");
 
-  // Hold the global lock during interrupt dispatch.
+  // Hold the guest global lock during interrupt dispatch.
   // This will block if any code is in a critical region (has interrupts
   // disabled) or if any other interrupt is executing.
-  auto global_lock = global_critical_region_.Acquire();
+  std::lock_guard<xe::fast_recursive_mutex> guest_lock(
+      frontend_->builtins()->global_lock);
 
   auto context = thread_state->context();
   assert_true(arg_count <= 5);
@@ -610,7 +751,7 @@ void Processor::DemandDebugListener() {
 }
 
 bool Processor::OnThreadBreakpointHit(Exception* ex) {
-  auto global_lock = global_critical_region_.Acquire();
+  auto suspend_lock = AcquireSuspendLock();
 
   // Suspend all threads (but ourselves).
   SuspendAllThreads();
@@ -663,7 +804,7 @@ bool Processor::OnThreadBreakpointHit(Exception* ex) {
   thread_info->suspended = true;
 
   // Must unlock, or we will deadlock.
-  global_lock.unlock();
+  suspend_lock.unlock();
 
   if (debug_listener_) {
     debug_listener_->OnExecutionPaused();
@@ -701,7 +842,7 @@ bool Processor::OnUnhandledException(Exception* ex) {
     return false;
   }
 
-  auto global_lock = global_critical_region_.Acquire();
+  auto suspend_lock = AcquireSuspendLock();
 
   // Suspend all guest threads (but this one).
   SuspendAllThreads();
@@ -718,7 +859,8 @@ bool Processor::OnUnhandledException(Exception* ex) {
   // debug_listener_->OnException(info);
   debug_listener_->OnExecutionPaused();
 
-  // Suspend self.
+  // Suspend self. Must unlock, or we will deadlock.
+  suspend_lock.unlock();
   Thread::GetCurrentThread()->thread()->Suspend();
 
   return true;
@@ -733,7 +875,7 @@ void Processor::ShowDebugger() {
 }
 
 bool Processor::SuspendAllThreads() {
-  auto global_lock = global_critical_region_.Acquire();
+  auto suspend_lock = AcquireSuspendLock();
   for (auto& it : thread_debug_infos_) {
     auto thread_info = it.second.get();
     if (thread_info->suspended) {
@@ -873,9 +1015,17 @@ void Processor::ResumeAllBreakpoints() {
   }
 }
 
+Processor::SuspendLock Processor::AcquireSuspendLock() {
+  SuspendLock suspend_lock;
+  suspend_lock.guest_lock = std::unique_lock<xe::fast_recursive_mutex>(
+      frontend_->builtins()->global_lock);
+  suspend_lock.global_lock = global_critical_region_.Acquire();
+  return suspend_lock;
+}
+
 void Processor::Pause() {
   {
-    auto global_lock = global_critical_region_.Acquire();
+    auto suspend_lock = AcquireSuspendLock();
     assert_true(execution_state_ == ExecutionState::kRunning);
     SuspendAllThreads();
     SuspendAllBreakpoints();
@@ -34,7 +34,9 @@ DECLARE_bool(debug);
 namespace xe {
 namespace cpu {
 
+class BackgroundCompiler;
 class Breakpoint;
+class FunctionProfiler;
 class StackWalker;
 class XexModule;
 
@@ -94,10 +96,29 @@ class Processor {
     debug_listener_handler_ = std::move(handler);
   }
 
+  uint32_t debug_info_flags() const { return debug_info_flags_; }
   void set_debug_info_flags(uint32_t debug_info_flags) {
     debug_info_flags_ = debug_info_flags;
   }
 
+  // Sets up persistent storage of generated code for the given title module,
+  // if enabled with --store_generated_code.
+  void InitializeCodeStorage(const std::wstring& storage_root,
+                             uint32_t title_id, XexModule* module);
+  // Starts translating the functions the module is known to contain on
+  // background threads, if enabled with --background_compile_threads.
+  void StartBackgroundCompilation(Module* module, uint32_t entry_point);
+  // Hints that the function at the given address will likely be called soon.
+  // Queues it for background translation if that is active.
+  void PrecompileFunction(uint32_t address);
+  // Called by baseline code that has become hot to have it recompiled at
+  // GuestFunction::Tier::kOptimized in the background.
+  void RequestOptimization(GuestFunction* function);
+  // Recompiles a defined function at GuestFunction::Tier::kOptimized into a
+  // separate code object and swaps the new code in. Threads already in the old
+  // code finish running it.
+  bool OptimizeFunction(GuestFunction* function);
+
   bool AddModule(std::unique_ptr<Module> module);
   Module* GetModule(const char* name);
   Module* GetModule(const std::string& name) { return GetModule(name.c_str()); }
@@ -153,6 +174,27 @@ class Processor {
   // Shows the debug listener, focusing it if it already exists.
   void ShowDebugger();
 
+  // Locks held while suspending guest threads: the guest interrupt lock (see
+  // PPCBuiltins::global_lock), then the global critical region. A thread
+  // holding the guest lock has interrupts disabled and must not be suspended,
+  // so acquiring this waits for any such section to end.
+  struct SuspendLock {
+    std::unique_lock<xe::fast_recursive_mutex> guest_lock;
+    std::unique_lock<std::recursive_mutex> global_lock;
+
+    void lock() {
+      guest_lock.lock();
+      global_lock.lock();
+    }
+    void unlock() {
+      global_lock.unlock();
+      guest_lock.unlock();
+    }
+  };
+  // Every path that suspends guest threads other than the caller takes this
+  // first, in place of the global critical region alone.
+  SuspendLock AcquireSuspendLock();
+
   // Pauses target execution by suspending all threads.
   // The debug listener will be requested if it has not been attached.
   void Pause();
@@ -235,6 +277,7 @@ class Processor {
                                          uint32_t current_pc);
 
   bool DemandFunction(Function* function);
+  void CreateBackgroundCompiler();
 
   Memory* memory_ = nullptr;
   std::unique_ptr<StackWalker> stack_walker_;
@@ -247,12 +290,15 @@ class Processor {
   // If specified, the file trace data gets written to when running.
   std::wstring functions_trace_path_;
   std::unique_ptr<ChunkedMappedMemoryWriter> functions_trace_file_;
+  // Set when guest functions are compiled with profiling counters.
+  std::unique_ptr<FunctionProfiler> function_profiler_;
 
   std::unique_ptr<ppc::PPCFrontend> frontend_;
   std::unique_ptr<backend::Backend> backend_;
   ExportResolver* export_resolver_ = nullptr;
 
   EntryTable entry_table_;
+  std::unique_ptr<BackgroundCompiler> background_compiler_;
   xe::global_critical_region global_critical_region_;
   ExecutionState execution_state_ = ExecutionState::kPaused;
   std::vector<std::unique_ptr<Module>> modules_;
@@ -24,6 +24,8 @@ class RawModule : public Module {
 
   bool LoadFile(uint32_t base_address, const std::wstring& path);
 
+  uint32_t image_size() const { return high_address_ - low_address_; }
+
   // Set address range if you've already allocated memory and placed code
   // in it.
   void SetAddressRange(uint32_t base_address, uint32_t size);
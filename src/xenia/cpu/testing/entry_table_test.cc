@@ -0,0 +1,150 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/entry_table.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "third_party/catch/include/catch.hpp"
+
+using namespace xe::cpu;
+
+namespace {
+
+// Enough entries to grow the table from its initial capacity several times.
+const uint32_t kEntryCount = 64 * 1024;
+
+uint32_t EntryAddress(uint32_t index) { return 0x82000000 + index * 4; }
+
+// Never dereferenced; only checks that what the compiling thread published
+// is what everyone else sees.
+Function* FakeFunction(uint32_t address) {
+  return reinterpret_cast<Function*>(uintptr_t(address) << 4);
+}
+
+}  // namespace
+
+TEST_CASE("ENTRY_TABLE_CONCURRENT_GET_OR_CREATE", "[entry_table]") {
+  EntryTable entry_table;
+  const uint32_t thread_count = 8;
+  std::unique_ptr<std::atomic<uint32_t>[]> create_counts(
+      new std::atomic<uint32_t>[kEntryCount]);
+  for (uint32_t i = 0; i < kEntryCount; ++i) {
+    create_counts[i] = 0;
+  }
+  std::atomic<bool> any_failed(false);
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&, t]() {
+      auto get_or_create = [&](uint32_t index, bool is_private) {
+        uint32_t address = EntryAddress(index);
+        Entry* entry = nullptr;
+        auto status = entry_table.GetOrCreate(address, &entry);
+        if (!entry || entry->address != address) {
+          any_failed = true;
+          return;
+        }
+        if (status == Entry::STATUS_NEW) {
+          ++create_counts[index];
+          entry->function = FakeFunction(address);
+          entry->end_address = address + 4;
+          entry_table.Complete(entry, Entry::STATUS_READY);
+        } else if (is_private || status != Entry::STATUS_READY ||
+                   entry->function != FakeFunction(address) ||
+                   entry->end_address != address + 4) {
+          any_failed = true;
+        }
+      };
+      // Every thread walks the same addresses from a different starting
+      // point, so some are contended and some aren't. In between it creates
+      // addresses only it uses.
+      const uint32_t shared_count = kEntryCount / 2;
+      for (uint32_t n = 0; n < shared_count; ++n) {
+        get_or_create((n + t * (shared_count / thread_count)) % shared_count,
+                      false);
+        if (n % thread_count == t) {
+          get_or_create(shared_count + n, true);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(!any_failed);
+
+  // Everything was created exactly once and survived the growth.
+  for (uint32_t i = 0; i < kEntryCount; ++i) {
+    REQUIRE(create_counts[i] == 1);
+    auto entry = entry_table.Get(EntryAddress(i));
+    REQUIRE(entry);
+    REQUIRE(entry->function == FakeFunction(EntryAddress(i)));
+  }
+  REQUIRE(!entry_table.Get(EntryAddress(kEntryCount)));
+}
+
+TEST_CASE("ENTRY_TABLE_WAITERS_WAKE", "[entry_table]") {
+  for (auto complete_status : {Entry::STATUS_READY, Entry::STATUS_FAILED}) {
+    EntryTable entry_table;
+    const uint32_t address = EntryAddress(0);
+    Entry* entry = nullptr;
+    REQUIRE(entry_table.GetOrCreate(address, &entry) == Entry::STATUS_NEW);
+
+    const uint32_t waiter_count = 4;
+    std::vector<Entry::Status> waiter_statuses(waiter_count, Entry::STATUS_NEW);
+    std::vector<Entry*> waiter_entries(waiter_count, nullptr);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < waiter_count; ++i) {
+      threads.emplace_back([&, i]() {
+        waiter_statuses[i] =
+            entry_table.GetOrCreate(address, &waiter_entries[i]);
+      });
+    }
+    while (entry->waiter_count != waiter_count) {
+      std::this_thread::yield();
+    }
+
+    // Grow the table while they wait.
+    for (uint32_t i = 1; i < kEntryCount; ++i) {
+      Entry* other_entry = nullptr;
+      REQUIRE(entry_table.GetOrCreate(EntryAddress(i), &other_entry) ==
+              Entry::STATUS_NEW);
+      entry_table.Complete(other_entry, Entry::STATUS_READY);
+    }
+    REQUIRE(entry->waiter_count == waiter_count);
+    REQUIRE(!entry_table.Get(address));
+
+    if (complete_status == Entry::STATUS_READY) {
+      entry->function = FakeFunction(address);
+    }
+    entry_table.Complete(entry, complete_status);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (uint32_t i = 0; i < waiter_count; ++i) {
+      REQUIRE(waiter_statuses[i] == complete_status);
+      REQUIRE(waiter_entries[i] == entry);
+    }
+    REQUIRE(entry->waiter_count == 0);
+    if (complete_status == Entry::STATUS_READY) {
+      REQUIRE(entry_table.Get(address) == entry);
+      REQUIRE(entry->function == FakeFunction(address));
+    } else {
+      REQUIRE(!entry_table.Get(address));
+    }
+
+    // Later lookups don't wait.
+    Entry* later_entry = nullptr;
+    REQUIRE(entry_table.GetOrCreate(address, &later_entry) == complete_status);
+    REQUIRE(later_entry == entry);
+  }
+}
@@ -8,6 +8,7 @@ test_suite("xenia-cpu-tests", project_root, ".", {
     "xenia-core",
     "xenia-cpu",
     "xenia-cpu-backend-x64",
+    "xxhash", -- cpu-backend-x64
 
     -- TODO(benvanik): cut these dependencies?
     "xenia-kernel",
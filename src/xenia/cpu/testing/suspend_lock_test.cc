@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/cpu/testing/util.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace xe::cpu;
+
+TEST_CASE("SUSPEND_LOCK_WAITS_FOR_GUEST_CRITICAL_SECTION", "[processor]") {
+  xe::Memory memory;
+  memory.Initialize();
+  Processor processor(&memory, nullptr);
+  processor.Setup(std::make_unique<backend::x64::X64Backend>());
+  auto& guest_lock = processor.frontend()->builtins()->global_lock;
+
+  // Stands in for a guest thread going in and out of interrupts-disabled
+  // sections (mtmsrd r13), which hold the guest lock through the builtins.
+  std::atomic<bool> entered(false);
+  std::atomic<bool> in_section(false);
+  std::atomic<bool> done(false);
+  std::thread guest_thread([&]() {
+    guest_lock.lock();
+    in_section = true;
+    entered = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    in_section = false;
+    guest_lock.unlock();
+    while (!done) {
+      std::lock_guard<xe::fast_recursive_mutex> lock(guest_lock);
+      in_section = true;
+      std::this_thread::yield();
+      in_section = false;
+    }
+  });
+  while (!entered) {
+    std::this_thread::yield();
+  }
+
+  // Pausing starts while the thread is inside the section. Anything suspended
+  // under the lock must be outside of it.
+  bool ever_in_section = false;
+  for (int i = 0; i < 1000; ++i) {
+    auto suspend_lock = processor.AcquireSuspendLock();
+    ever_in_section = ever_in_section || in_section;
+    std::this_thread::yield();
+    ever_in_section = ever_in_section || in_section;
+  }
+  done = true;
+  guest_thread.join();
+  REQUIRE(!ever_in_section);
+
+  // Suspending from inside a section (on the thread holding the lock) must
+  // not deadlock.
+  guest_lock.lock();
+  {
+    auto suspend_lock = processor.AcquireSuspendLock();
+    REQUIRE(guest_lock.is_locked_by_current_thread());
+  }
+  guest_lock.unlock();
+  REQUIRE(!guest_lock.is_locked_by_current_thread());
+}
@@ -10,6 +10,7 @@
 #include "xenia/emulator.h"
 
 #include <cinttypes>
+#include <random>
 
 #include "config.h"
 #include "xenia/apu/audio_system.h"
@@ -361,7 +362,7 @@ void Emulator::Pause() {
   graphics_system_->Pause();
   audio_system_->Pause();
 
-  auto lock = global_critical_region::AcquireDirect();
+  auto suspend_lock = processor()->AcquireSuspendLock();
   auto threads =
       kernel_state()->object_table()->GetObjectsByType<kernel::XThread>(
           kernel::XObject::kTypeThread);
@@ -407,20 +408,50 @@ void Emulator::Resume() {
   }
 }
 
-bool Emulator::SaveToFile(const std::wstring& path) {
+namespace {
+// Bumped whenever the layout of save states changes, so older ones are
+// rejected instead of misparsed.
+const uint32_t kSaveVersion = 1;
+// Save state header flags.
+const uint32_t kSaveIncremental = 1 << 0;
+}  // namespace
+
+bool Emulator::SaveToFile(const std::wstring& path, bool incremental) {
+  if (incremental && last_full_save_path_.empty()) {
+    XELOGE("Incremental save requested without a full save to base it on");
+    return false;
+  }
+
   Pause();
 
   filesystem::CreateFile(path);
   auto map = MappedMemory::Open(path, MappedMemory::Mode::kReadWrite, 0,
                                 1024ull * 1024ull * 1024ull * 2ull);
   if (!map) {
+    Resume();
     return false;
   }
 
   // Save the emulator state to a file
   ByteStream stream(map->data(), map->size());
   stream.Write('XSAV');
+  stream.Write(kSaveVersion);
   stream.Write(title_id_);
+  stream.Write(incremental ? kSaveIncremental : 0u);
+  // Offset of the memory state, so an incremental save can find it in its
+  // base file.
+  size_t memory_offset_offset = stream.offset();
+  stream.Write(uint64_t(0));
+  uint64_t save_id = last_full_save_id_;
+  if (!incremental) {
+    std::random_device random;
+    save_id = (uint64_t(random()) << 32) | random();
+  }
+  stream.Write(save_id);
+  if (incremental) {
+    // The ID above is the base's, to check against it on restore.
+    stream.Write(last_full_save_path_);
+  }
 
   // It's important we don't hold the global lock here! XThreads need to step
   // forward (possibly through guarded regions) without worry!
@@ -428,8 +459,17 @@ bool Emulator::SaveToFile(const std::wstring& path) {
   graphics_system_->Save(&stream);
   audio_system_->Save(&stream);
   kernel_state_->Save(&stream);
-  memory_->Save(&stream);
-  map->Close(stream.offset());
+  size_t memory_offset = stream.offset();
+  memory_->Save(&stream, incremental);
+  size_t end_offset = stream.offset();
+  stream.set_offset(memory_offset_offset);
+  stream.Write(uint64_t(memory_offset));
+  map->Close(end_offset);
+
+  if (!incremental) {
+    last_full_save_path_ = path;
+    last_full_save_id_ = save_id;
+  }
 
   Resume();
   return true;
@@ -453,6 +493,12 @@ bool Emulator::RestoreFromFile(const std::wstring& path) {
   if (stream.Read<uint32_t>() != 'XSAV') {
     return false;
   }
+  uint32_t version = stream.Read<uint32_t>();
+  if (version != kSaveVersion) {
+    XELOGE("Save state version %u is not supported (expected %u)", version,
+           kSaveVersion);
+    return false;
+  }
 
   auto title_id = stream.Read<uint32_t>();
   if (title_id != title_id_) {
@@ -461,6 +507,35 @@ bool Emulator::RestoreFromFile(const std::wstring& path) {
     return false;
   }
 
+  uint32_t flags = stream.Read<uint32_t>();
+  stream.Read<uint64_t>();
+  uint64_t save_id = stream.Read<uint64_t>();
+  std::unique_ptr<MappedMemory> base_map;
+  size_t base_memory_offset = 0;
+  if (flags & kSaveIncremental) {
+    auto base_path = stream.Read<std::wstring>();
+    base_map = MappedMemory::Open(base_path, MappedMemory::Mode::kRead);
+    if (!base_map) {
+      XELOGE("Could not open base save state %S", base_path.c_str());
+      return false;
+    }
+    // Check the base before anything is restored from either file.
+    ByteStream base_stream(base_map->data(), base_map->size());
+    if (base_stream.Read<uint32_t>() != 'XSAV' ||
+        base_stream.Read<uint32_t>() != kSaveVersion ||
+        base_stream.Read<uint32_t>() != title_id_ ||
+        (base_stream.Read<uint32_t>() & kSaveIncremental)) {
+      XELOGE("Base save state is not a full save of this title!");
+      return false;
+    }
+    base_memory_offset = size_t(base_stream.Read<uint64_t>());
+    if (base_stream.Read<uint64_t>() != save_id) {
+      XELOGE("Base save state %S has been overwritten since this save!",
+             base_path.c_str());
+      return false;
+    }
+  }
+
   if (!processor_->Restore(&stream)) {
     XELOGE("Could not restore processor!");
     return false;
@@ -477,6 +552,15 @@ bool Emulator::RestoreFromFile(const std::wstring& path) {
     XELOGE("Could not restore kernel state!");
     return false;
   }
+  if (base_map) {
+    // Restore everything from the base, then the pages that changed since.
+    ByteStream base_stream(base_map->data(), base_map->size());
+    base_stream.set_offset(base_memory_offset);
+    if (!memory_->Restore(&base_stream)) {
+      XELOGE("Could not restore memory from base save state!");
+      return false;
+    }
+  }
   if (!memory_->Restore(&stream)) {
     XELOGE("Could not restore memory!");
     return false;
@@ -695,6 +779,11 @@ X_STATUS Emulator::CompleteLaunch(const std::wstring& path,
   graphics_system_->InitializeShaderStorage(storage_root_, title_id_, true);
   on_shader_storage_initialization(false);
 
+  processor_->InitializeCodeStorage(storage_root_, title_id_,
+                                    module->xex_module());
+  processor_->StartBackgroundCompilation(module->xex_module(),
+                                         module->entry_point());
+
   auto main_thread = kernel_state_->LaunchModule(module);
   if (!main_thread) {
     return X_STATUS_UNSUCCESSFUL;
@@ -139,7 +139,9 @@ class Emulator {
   void Resume();
   bool is_paused() const { return paused_; }
 
-  bool SaveToFile(const std::wstring& path);
+  // An incremental save only holds the guest memory pages that changed since
+  // the last full save, and needs that file to be restored.
+  bool SaveToFile(const std::wstring& path, bool incremental = false);
   bool RestoreFromFile(const std::wstring& path);
 
   // The game can request another title to be loaded.
@@ -187,6 +189,10 @@ class Emulator {
 
   bool paused_;
   bool restoring_;
+  // Base for incremental saves, and the ID written into it so a delta can
+  // tell if the base has since been overwritten.
+  std::wstring last_full_save_path_;
+  uint64_t last_full_save_id_ = 0;
   threading::Fence restore_fence_;  // Fired on restore finish.
 };
 
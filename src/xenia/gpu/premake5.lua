@@ -55,3 +55,5 @@ project("xenia-gpu-shader-compiler")
         "1>scratch/stdout-shader-compiler.txt",
       })
     end
+
+include("testing")
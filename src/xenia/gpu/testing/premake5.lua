@@ -0,0 +1,18 @@
+project_root = "../../../.."
+include(project_root.."/tools/build")
+
+test_suite("xenia-gpu-tests", project_root, ".", {
+  links = {
+    "xenia-base",
+    "xenia-gpu",
+
+    -- TODO(benvanik): cut these dependencies?
+    "dxbc",
+    "glslang-spirv",
+    "snappy",
+    "spirv-tools",
+    "xenia-ui", -- needed by xenia-base
+    "xenia-ui-spirv",
+    "xxhash",
+  },
+})
@@ -0,0 +1,106 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/gpu/texture_conversion_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "xenia/base/threading.h"
+#include "xenia/gpu/testing/texture_conversion_test_util.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace gpu {
+namespace test {
+
+using texture_conversion::Untile;
+
+TEST_CASE("texture_conversion_pool_jobs", "TextureConversionPool") {
+  for (uint32_t thread_count : {0u, 1u, 4u}) {
+    TextureConversionPool pool(thread_count);
+    std::atomic<uint32_t> job_count(0);
+    for (int i = 0; i < 1000; ++i) {
+      pool.Queue([&]() { ++job_count; });
+    }
+    pool.WaitIdle();
+    REQUIRE(job_count == 1000);
+  }
+}
+
+TEST_CASE("texture_conversion_pool_untile", "TextureConversionPool") {
+  std::mt19937 random(1234);
+  TextureConversionPool pool(4);
+  for (auto format : {TextureFormat::k_8_8_8_8, TextureFormat::k_DXT1}) {
+    // Tall enough to be split into bands.
+    auto untile_info =
+        MakeUntileInfo(format, Endian::k8in32, 0, 0, 256, 1024, 256);
+    uint32_t bytes_per_block = untile_info.input_format_info->bytes_per_block();
+    std::vector<uint8_t> input(256 * 1024 * bytes_per_block);
+    for (auto& value : input) {
+      value = uint8_t(random());
+    }
+    untile_info.offset_y = 7;
+    untile_info.height -= 7;
+    std::vector<uint8_t> expected(input.size());
+    Untile(expected.data(), input.data(), &untile_info);
+    std::vector<uint8_t> output(input.size());
+    pool.QueueUntile(output.data(), input.data(), untile_info);
+    pool.WaitIdle();
+    REQUIRE(output == expected);
+  }
+}
+
+// Untiles 2048x2048 textures on one thread and on the pool.
+TEST_CASE("texture_conversion_pool_benchmark", "[.benchmark]") {
+  const int iteration_count = 10;
+  uint32_t thread_count =
+      std::max(xe::threading::logical_processor_count(), uint32_t(1));
+  TextureConversionPool pool(thread_count);
+  for (auto format : {TextureFormat::k_8_8_8_8, TextureFormat::k_DXT1}) {
+    auto format_info = FormatInfo::Get(format);
+    uint32_t width = 2048 / format_info->block_width;
+    uint32_t height = 2048 / format_info->block_height;
+    auto untile_info =
+        MakeUntileInfo(format, Endian::k8in32, 0, 0, width, height, width);
+    std::vector<uint8_t> input(width * height *
+                               format_info->bytes_per_block());
+    std::vector<uint8_t> output(input.size());
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iteration_count; ++i) {
+      Untile(output.data(), input.data(), &untile_info);
+    }
+    auto serial_elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iteration_count; ++i) {
+      pool.QueueUntile(output.data(), input.data(), untile_info);
+      pool.WaitIdle();
+    }
+    auto pool_elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    std::printf("%s, serial: %.1fus per texture\n", format_info->name,
+                double(serial_elapsed.count()) / iteration_count);
+    std::printf("%s, %u threads: %.1fus per texture\n", format_info->name,
+                thread_count, double(pool_elapsed.count()) / iteration_count);
+  }
+}
+
+}  // namespace test
+}  // namespace gpu
+}  // namespace xe
@@ -0,0 +1,125 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/gpu/texture_conversion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "xenia/gpu/testing/texture_conversion_test_util.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace gpu {
+namespace test {
+
+using texture_conversion::CopySwapBlock;
+using texture_conversion::Untile;
+
+// One format for each block size.
+const TextureFormat kFormats[] = {
+    TextureFormat::k_8,
+    TextureFormat::k_8_8,
+    TextureFormat::k_8_8_8_8,
+    TextureFormat::k_16_16_16_16,
+    TextureFormat::k_32_32_32_32_FLOAT,
+};
+
+const Endian kEndians[] = {
+    Endian::kNone,
+    Endian::k8in16,
+    Endian::k8in32,
+    Endian::k16in32,
+};
+
+TEST_CASE("untile_matches_callback", "Untile") {
+  std::mt19937 random(1234);
+  // Tiled textures are padded to 32x32 blocks.
+  const uint32_t pitch = 128;
+  for (auto format : kFormats) {
+    uint32_t bytes_per_block = FormatInfo::Get(format)->bytes_per_block();
+    std::vector<uint8_t> input(pitch * pitch * bytes_per_block);
+    for (auto& value : input) {
+      value = uint8_t(random());
+    }
+    for (auto endian : kEndians) {
+      for (int i = 0; i < 20; ++i) {
+        uint32_t offset_x = random() % 40;
+        uint32_t offset_y = random() % 40;
+        uint32_t width = 1 + random() % (pitch - offset_x);
+        uint32_t height = 1 + random() % (pitch - offset_y);
+        auto untile_info = MakeUntileInfo(format, endian, offset_x, offset_y,
+                                          width, height, pitch);
+        std::vector<uint8_t> output(width * height * bytes_per_block, 0xCD);
+        Untile(output.data(), input.data(), &untile_info);
+
+        // A block at a time through the callback, as before runs.
+        untile_info.copy_callback = [endian](void* o, const void* i,
+                                             size_t l) {
+          CopySwapBlock(endian, o, i, l);
+        };
+        std::vector<uint8_t> expected(output.size(), 0xCD);
+        Untile(expected.data(), input.data(), &untile_info);
+
+        REQUIRE(output == expected);
+      }
+    }
+  }
+}
+
+TEST_CASE("copy_swap_block_16_in_32", "Untile") {
+  const uint8_t input[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+  uint8_t output[8] = {};
+  CopySwapBlock(Endian::k16in32, output, input, 8);
+  const uint8_t expected[8] = {2, 3, 0, 1, 6, 7, 4, 5};
+  REQUIRE(std::memcmp(output, expected, sizeof(output)) == 0);
+}
+
+// Untiles a 1024x1024 texture a run at a time and a block at a time.
+TEST_CASE("untile_benchmark", "[.benchmark]") {
+  const uint32_t size = 1024;
+  const int iteration_count = 20;
+  for (auto format : kFormats) {
+    uint32_t bytes_per_block = FormatInfo::Get(format)->bytes_per_block();
+    std::vector<uint8_t> input(size * size * bytes_per_block);
+    std::vector<uint8_t> output(input.size());
+    for (auto endian : kEndians) {
+      auto untile_info =
+          MakeUntileInfo(format, endian, 0, 0, size, size, size);
+      auto run = [&](const char* name) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iteration_count; ++i) {
+          Untile(output.data(), input.data(), &untile_info);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+        double time_us =
+            std::max(double(elapsed.count()), 1.0) / iteration_count;
+        std::printf("%u bytes per block, endian %u, %s: %.1fus per texture "
+                    "(%.2f GB/s)\n",
+                    bytes_per_block, uint32_t(endian), name, time_us,
+                    input.size() / time_us / 1e3);
+      };
+      run("runs");
+      untile_info.copy_callback = [endian](void* o, const void* i, size_t l) {
+        CopySwapBlock(endian, o, i, l);
+      };
+      run("blocks");
+    }
+  }
+}
+
+}  // namespace test
+}  // namespace gpu
+}  // namespace xe
@@ -0,0 +1,41 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_GPU_TESTING_TEXTURE_CONVERSION_TEST_UTIL_H_
+#define XENIA_GPU_TESTING_TEXTURE_CONVERSION_TEST_UTIL_H_
+
+#include "xenia/gpu/texture_conversion.h"
+
+namespace xe {
+namespace gpu {
+namespace test {
+
+// Describes untiling a tiled texture of the given pitch into a linear one
+// exactly as wide as the copied region, without a format conversion.
+inline texture_conversion::UntileInfo MakeUntileInfo(
+    TextureFormat format, Endian endian, uint32_t offset_x, uint32_t offset_y,
+    uint32_t width, uint32_t height, uint32_t pitch) {
+  texture_conversion::UntileInfo untile_info = {};
+  untile_info.offset_x = offset_x;
+  untile_info.offset_y = offset_y;
+  untile_info.width = width;
+  untile_info.height = height;
+  untile_info.input_pitch = pitch;
+  untile_info.output_pitch = width;
+  untile_info.input_format_info = FormatInfo::Get(format);
+  untile_info.output_format_info = untile_info.input_format_info;
+  untile_info.endian = endian;
+  return untile_info;
+}
+
+}  // namespace test
+}  // namespace gpu
+}  // namespace xe
+
+#endif  // XENIA_GPU_TESTING_TEXTURE_CONVERSION_TEST_UTIL_H_
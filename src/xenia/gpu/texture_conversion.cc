@@ -37,7 +37,7 @@ void CopySwapBlock(Endian endian, void* output, const void* input,
       xe::copy_and_swap_32_unaligned(output, input, length / 4);
       break;
     case Endian::k16in32:  // Swap high and low 16 bits within a 32 bit word
-      xe::copy_and_swap_16_in_32_unaligned(output, input, length);
+      xe::copy_and_swap_16_in_32_unaligned(output, input, length / 4);
       break;
     default:
     case Endian::kNone:
@@ -108,6 +108,77 @@ static uint32_t TiledOffset2DColumn(uint32_t x, uint32_t y, uint32_t log2_bpp,
          ((y & 16) << 7) + (((((y & 8) >> 2) + (x >> 3)) & 3) << 6);
 }
 
+// Untiles with CopySwapBlock semantics, copying each run of blocks that is
+// contiguous in the tiled input at once. Runs never cross 16 bytes, so they're
+// swapped with a single shuffle where SSSE3 is available.
+static void UntileRuns(uint8_t* output_buffer, const uint8_t* input_buffer,
+                       const UntileInfo* untile_info, uint32_t log2_bpp) {
+  uint32_t bytes_per_block = 1 << log2_bpp;
+  uint32_t output_pitch = untile_info->output_pitch * bytes_per_block;
+  Endian endian = untile_info->endian;
+  // A micro tile row is 8 blocks, stored as 16 byte pieces interleaved with
+  // those of the next row, so runs end at 8 blocks or 16 bytes.
+  uint32_t run_blocks = std::min(8u, 16u >> log2_bpp);
+
+#if XE_ARCH_AMD64
+  __m128i swap_mask;
+  switch (endian) {
+    case Endian::k8in16:
+      swap_mask = _mm_set_epi8(0x0E, 0x0F, 0x0C, 0x0D, 0x0A, 0x0B, 0x08, 0x09,
+                               0x06, 0x07, 0x04, 0x05, 0x02, 0x03, 0x00, 0x01);
+      break;
+    case Endian::k8in32:
+      swap_mask = _mm_set_epi8(0x0C, 0x0D, 0x0E, 0x0F, 0x08, 0x09, 0x0A, 0x0B,
+                               0x04, 0x05, 0x06, 0x07, 0x00, 0x01, 0x02, 0x03);
+      break;
+    case Endian::k16in32:
+      swap_mask = _mm_set_epi8(0x0D, 0x0C, 0x0F, 0x0E, 0x09, 0x08, 0x0B, 0x0A,
+                               0x05, 0x04, 0x07, 0x06, 0x01, 0x00, 0x03, 0x02);
+      break;
+    default:
+      swap_mask = _mm_set_epi8(0x0F, 0x0E, 0x0D, 0x0C, 0x0B, 0x0A, 0x09, 0x08,
+                               0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01, 0x00);
+      break;
+  }
+#endif  // XE_ARCH_AMD64
+
+  uint32_t output_row_offset = 0;
+  for (uint32_t y = 0; y < untile_info->height; y++) {
+    uint32_t tiled_y = untile_info->offset_y + y;
+    auto input_row_offset =
+        TiledOffset2DRow(tiled_y, untile_info->input_pitch, log2_bpp);
+    uint8_t* output = &output_buffer[output_row_offset];
+
+    for (uint32_t x = 0; x < untile_info->width;) {
+      uint32_t tiled_x = untile_info->offset_x + x;
+      uint32_t run_length = std::min(run_blocks - (tiled_x & (run_blocks - 1)),
+                                     untile_info->width - x);
+      auto input_offset =
+          TiledOffset2DColumn(tiled_x, tiled_y, log2_bpp, input_row_offset);
+      input_offset = (input_offset >> log2_bpp) << log2_bpp;
+      const uint8_t* input = &input_buffer[input_offset];
+      uint32_t length = run_length << log2_bpp;
+
+#if XE_ARCH_AMD64
+      if (length == 16) {
+        __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+        data = _mm_shuffle_epi8(data, swap_mask);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), data);
+      } else {
+        CopySwapBlock(endian, output, input, length);
+      }
+#else
+      CopySwapBlock(endian, output, input, length);
+#endif  // XE_ARCH_AMD64
+
+      output += length;
+      x += run_length;
+    }
+
+    output_row_offset += output_pitch;
+  }
+}
+
 void Untile(uint8_t* output_buffer, const uint8_t* input_buffer,
             const UntileInfo* untile_info) {
   SCOPE_profile_cpu_f("gpu");
@@ -125,6 +196,29 @@ void Untile(uint8_t* output_buffer, const uint8_t* input_buffer,
   auto log2_bpp = (input_bytes_per_block / 4) +
                   ((input_bytes_per_block / 2) >> (input_bytes_per_block / 4));
 
+  if (!untile_info->copy_callback) {
+    // Blocks smaller than the swap unit are left to CopySwapBlock one by one,
+    // as swapping a whole run would mix them.
+    uint32_t swap_bytes = 1;
+    switch (untile_info->endian) {
+      case Endian::k8in16:
+        swap_bytes = 2;
+        break;
+      case Endian::k8in32:
+      case Endian::k16in32:
+        swap_bytes = 4;
+        break;
+      default:
+        break;
+    }
+    if (input_bytes_per_block == output_bytes_per_block &&
+        input_bytes_per_block == 1u << log2_bpp && log2_bpp <= 4 &&
+        input_bytes_per_block >= swap_bytes) {
+      UntileRuns(output_buffer, input_buffer, untile_info, log2_bpp);
+      return;
+    }
+  }
+
   // Offset to the current row, in bytes.
   uint32_t output_row_offset = 0;
   for (uint32_t y = 0; y < untile_info->height; y++) {
@@ -140,10 +234,16 @@ void Untile(uint8_t* output_buffer, const uint8_t* input_buffer,
                                               log2_bpp, input_row_offset);
       input_offset >>= log2_bpp;
 
-      untile_info->copy_callback(
-          &output_buffer[output_offset],
-          &input_buffer[input_offset * input_bytes_per_block],
-          output_bytes_per_block);
+      if (untile_info->copy_callback) {
+        untile_info->copy_callback(
+            &output_buffer[output_offset],
+            &input_buffer[input_offset * input_bytes_per_block],
+            output_bytes_per_block);
+      } else {
+        CopySwapBlock(untile_info->endian, &output_buffer[output_offset],
+                      &input_buffer[input_offset * input_bytes_per_block],
+                      output_bytes_per_block);
+      }
 
       output_offset += output_bytes_per_block;
     }
@@ -43,7 +43,10 @@ typedef struct UntileInfo {
   uint32_t output_pitch;
   const FormatInfo* input_format_info;
   const FormatInfo* output_format_info;
+  // Converts each block. If empty, blocks are copied as CopySwapBlock would
+  // with endian, a run of adjacent blocks at a time.
   UntileCopyBlockCallback copy_callback;
+  Endian endian;
 } UntileInfo;
 
 void Untile(uint8_t* output_buffer, const uint8_t* input_buffer,
@@ -0,0 +1,123 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/gpu/texture_conversion_pool.h"
+
+#include <algorithm>
+
+#include "xenia/base/logging.h"
+#include "xenia/base/math.h"
+
+namespace xe {
+namespace gpu {
+
+TextureConversionPool::TextureConversionPool(uint32_t thread_count) {
+  for (uint32_t i = 0; i < thread_count; ++i) {
+    xe::threading::Thread::CreationParameters params;
+    auto thread = xe::threading::Thread::Create(
+        params, [this]() { WorkerThread(); });
+    if (!thread) {
+      XELOGE("Unable to create texture conversion thread");
+      break;
+    }
+    thread->set_name("Texture Conversion");
+    threads_.push_back(std::move(thread));
+  }
+}
+
+TextureConversionPool::~TextureConversionPool() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    shutting_down_ = true;
+  }
+  queue_cond_.notify_all();
+  // Waiting on the threads themselves isn't supported everywhere, so they
+  // check out as they exit instead.
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  idle_cond_.wait(lock,
+                  [this]() { return exited_count_ == threads_.size(); });
+}
+
+void TextureConversionPool::Queue(std::function<void()> job) {
+  if (threads_.empty()) {
+    job();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queue_.push_back(std::move(job));
+  }
+  queue_cond_.notify_one();
+}
+
+void TextureConversionPool::QueueUntile(
+    uint8_t* output_buffer, const uint8_t* input_buffer,
+    const texture_conversion::UntileInfo& untile_info) {
+  uint32_t output_pitch = untile_info.output_pitch *
+                          untile_info.output_format_info->bytes_per_block();
+  uint32_t band_height = xe::round_up(
+      std::max(kBandSize / std::max(output_pitch, 1u), 1u), 32u);
+  if (threads_.empty() || band_height >= untile_info.height) {
+    Queue([=]() {
+      texture_conversion::Untile(output_buffer, input_buffer, &untile_info);
+    });
+    return;
+  }
+  for (uint32_t y = 0; y < untile_info.height; y += band_height) {
+    auto band_info = untile_info;
+    band_info.offset_y += y;
+    band_info.height = std::min(band_height, untile_info.height - y);
+    uint8_t* band_output = output_buffer + size_t(y) * output_pitch;
+    Queue([=]() {
+      texture_conversion::Untile(band_output, input_buffer, &band_info);
+    });
+  }
+}
+
+void TextureConversionPool::WaitIdle() {
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  while (!queue_.empty()) {
+    auto job = std::move(queue_.front());
+    queue_.pop_front();
+    ++running_count_;
+    lock.unlock();
+    job();
+    lock.lock();
+    --running_count_;
+  }
+  idle_cond_.wait(lock,
+                  [this]() { return queue_.empty() && !running_count_; });
+}
+
+void TextureConversionPool::WorkerThread() {
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  while (true) {
+    queue_cond_.wait(lock,
+                     [this]() { return shutting_down_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      // Shutting down with nothing left to do.
+      ++exited_count_;
+      idle_cond_.notify_all();
+      break;
+    }
+    auto job = std::move(queue_.front());
+    queue_.pop_front();
+    ++running_count_;
+    lock.unlock();
+    job();
+    lock.lock();
+    --running_count_;
+    if (queue_.empty() && !running_count_) {
+      idle_cond_.notify_all();
+    }
+  }
+}
+
+}  // namespace gpu
+}  // namespace xe
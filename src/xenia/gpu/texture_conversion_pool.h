@@ -0,0 +1,71 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_GPU_TEXTURE_CONVERSION_POOL_H_
+#define XENIA_GPU_TEXTURE_CONVERSION_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "xenia/base/threading.h"
+#include "xenia/gpu/texture_conversion.h"
+
+namespace xe {
+namespace gpu {
+
+// Host threads that untile and convert textures into staging memory, so the
+// GPU thread only waits for them once the staging memory is about to be read.
+//
+// Jobs may run in any order, and must not touch the same output.
+class TextureConversionPool {
+ public:
+  // Untile jobs cover about this much output, rounded up to whole 32 block
+  // row tiles.
+  static const uint32_t kBandSize = 256 * 1024;
+
+  // With no threads, jobs run on the caller as they're queued.
+  explicit TextureConversionPool(uint32_t thread_count);
+  // Runs everything still queued before returning.
+  ~TextureConversionPool();
+
+  uint32_t thread_count() const { return uint32_t(threads_.size()); }
+
+  void Queue(std::function<void()> job);
+
+  // Splits the untile into bands of rows and queues one job for each.
+  // The buffers must stay valid until WaitIdle returns.
+  void QueueUntile(uint8_t* output_buffer, const uint8_t* input_buffer,
+                   const texture_conversion::UntileInfo& untile_info);
+
+  // Blocks until no jobs are queued or running, running queued ones on the
+  // calling thread meanwhile.
+  void WaitIdle();
+
+ private:
+  void WorkerThread();
+
+  std::vector<std::unique_ptr<xe::threading::Thread>> threads_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cond_;
+  std::condition_variable idle_cond_;
+  std::deque<std::function<void()>> queue_;
+  uint32_t running_count_ = 0;
+  size_t exited_count_ = 0;
+  bool shutting_down_ = false;
+};
+
+}  // namespace gpu
+}  // namespace xe
+
+#endif  // XENIA_GPU_TEXTURE_CONVERSION_POOL_H_
@@ -36,6 +36,9 @@ using xe::ui::vulkan::CheckResult;
 
 constexpr uint32_t kMaxTextureSamplers = 32;
 constexpr VkDeviceSize kStagingBufferSize = 64 * 1024 * 1024;
+// Smaller textures are converted right away, as handing them to another
+// thread would take about as long.
+constexpr size_t kAsyncUploadMinSize = 64 * 1024;
 
 const char* get_dimension_name(Dimension dimension) {
   static const char* names[] = {
@@ -150,6 +153,23 @@ VkResult TextureCache::Initialize() {
 
   device_queue_ = device_->AcquireQueue(device_->queue_family_index());
 
+  if (cvars::vulkan_texture_upload_threads != 0) {
+    uint32_t logical_processor_count =
+        xe::threading::logical_processor_count();
+    if (!logical_processor_count) {
+      // Pick some reasonable amount if couldn't determine the number of cores.
+      logical_processor_count = 6;
+    }
+    uint32_t thread_count;
+    if (cvars::vulkan_texture_upload_threads < 0) {
+      thread_count = std::max(logical_processor_count / 2, uint32_t(1));
+    } else {
+      thread_count = std::min(uint32_t(cvars::vulkan_texture_upload_threads),
+                              logical_processor_count);
+    }
+    conversion_pool_ = std::make_unique<TextureConversionPool>(thread_count);
+  }
+
   memory_invalidation_callback_handle_ =
       memory_->RegisterPhysicalMemoryInvalidationCallback(
           MemoryInvalidationCallbackThunk, this);
@@ -158,6 +178,9 @@ VkResult TextureCache::Initialize() {
 }
 
 void TextureCache::Shutdown() {
+  // Conversions may still be writing into the staging buffer.
+  conversion_pool_.reset();
+
   if (memory_invalidation_callback_handle_ != nullptr) {
     memory_->UnregisterPhysicalMemoryInvalidationCallback(
         memory_invalidation_callback_handle_);
@@ -953,6 +976,8 @@ TextureCache::Texture* TextureCache::LookupAddress(uint32_t guest_address,
 
 void TextureCache::FlushPendingCommands(VkCommandBuffer command_buffer,
                                         VkFence completion_fence) {
+  WaitForPendingUploads();
+
   auto status = vkEndCommandBuffer(command_buffer);
   CheckResult(status, "vkEndCommandBuffer");
 
@@ -988,7 +1013,8 @@ void TextureCache::FlushPendingCommands(VkCommandBuffer command_buffer,
 }
 
 bool TextureCache::ConvertTexture(uint8_t* dest, VkBufferImageCopy* copy_region,
-                                  uint32_t mip, const TextureInfo& src) {
+                                  uint32_t mip, const TextureInfo& src,
+                                  bool async) {
 #if FINE_GRAINED_DRAW_SCOPES
   SCOPE_profile_cpu_f("gpu");
 #endif  // FINE_GRAINED_DRAW_SCOPES
@@ -1017,9 +1043,16 @@ bool TextureCache::ConvertTexture(uint8_t* dest, VkBufferImageCopy* copy_region,
     for (uint32_t face = 0; face < dst_extent.depth; face++) {
       src_mem += offset_y * src_pitch;
       src_mem += offset_x * src.format_info()->bytes_per_block();
-      for (uint32_t y = 0; y < dst_extent.block_height; y++) {
-        copy_block(src.endianness, dest + y * dst_pitch,
-                   src_mem + y * src_pitch, dst_pitch);
+      auto copy_face = [=]() {
+        for (uint32_t y = 0; y < dst_extent.block_height; y++) {
+          copy_block(src.endianness, dest + y * dst_pitch,
+                     src_mem + y * src_pitch, dst_pitch);
+        }
+      };
+      if (async) {
+        conversion_pool_->Queue(copy_face);
+      } else {
+        copy_face();
       }
       src_mem += src_pitch * src_extent.block_pitch_v;
       dest += dst_pitch * dst_extent.block_pitch_v;
@@ -1028,8 +1061,7 @@ bool TextureCache::ConvertTexture(uint8_t* dest, VkBufferImageCopy* copy_region,
     // Untile image.
     // We could do this in a shader to speed things up, as this is pretty slow.
     for (uint32_t face = 0; face < dst_extent.depth; face++) {
-      texture_conversion::UntileInfo untile_info;
-      std::memset(&untile_info, 0, sizeof(untile_info));
+      texture_conversion::UntileInfo untile_info = {};
       untile_info.offset_x = offset_x;
       untile_info.offset_y = offset_y;
       untile_info.width = src_extent.block_width;
@@ -1038,10 +1070,22 @@ bool TextureCache::ConvertTexture(uint8_t* dest, VkBufferImageCopy* copy_region,
       untile_info.output_pitch = dst_extent.block_pitch_h;
       untile_info.input_format_info = src.format_info();
       untile_info.output_format_info = GetFormatInfo(src.format);
-      untile_info.copy_callback = [=](auto o, auto i, auto l) {
-        copy_block(src.endianness, o, i, l);
-      };
-      texture_conversion::Untile(dest, src_mem, &untile_info);
+      auto copy_swap_block =
+          copy_block.target<decltype(&texture_conversion::CopySwapBlock)>();
+      if (copy_swap_block &&
+          *copy_swap_block == texture_conversion::CopySwapBlock) {
+        // Let Untile swap whole runs of blocks itself.
+        untile_info.endian = src.endianness;
+      } else {
+        untile_info.copy_callback = [=](auto o, auto i, auto l) {
+          copy_block(src.endianness, o, i, l);
+        };
+      }
+      if (async) {
+        conversion_pool_->QueueUntile(dest, src_mem, untile_info);
+      } else {
+        texture_conversion::Untile(dest, src_mem, &untile_info);
+      }
       src_mem += src_pitch * src_extent.block_pitch_v;
       dest += dst_pitch * dst_extent.block_pitch_v;
     }
@@ -1134,13 +1178,16 @@ bool TextureCache::UploadTexture(VkCommandBuffer command_buffer,
   uint32_t copy_region_count = src.mip_levels();
   std::vector<VkBufferImageCopy> copy_regions(copy_region_count);
 
-  // Upload all mips.
+  // Upload all mips. Large textures are converted on the conversion threads
+  // while we go on recording, and are waited for before the command buffer is
+  // submitted.
+  bool async = conversion_pool_ && unpack_length >= kAsyncUploadMinSize;
   auto unpack_buffer = reinterpret_cast<uint8_t*>(alloc->host_ptr);
   VkDeviceSize unpack_offset = 0;
   for (uint32_t mip = src.mip_min_level, region = 0; mip <= src.mip_max_level;
        mip++, region++) {
     if (!ConvertTexture(&unpack_buffer[unpack_offset], &copy_regions[region],
-                        mip, src)) {
+                        mip, src, async)) {
       XELOGW("Failed to convert texture mip %u!", mip);
       return false;
     }
@@ -1158,6 +1205,7 @@ bool TextureCache::UploadTexture(VkCommandBuffer command_buffer,
   }
 
   if (cvars::texture_dump) {
+    WaitForPendingUploads();
     TextureDump(src, unpack_buffer, unpack_length);
   }
 
@@ -1606,6 +1654,13 @@ void TextureCache::RemoveInvalidatedTextures() {
   }
 }
 
+void TextureCache::WaitForPendingUploads() {
+  if (conversion_pool_) {
+    SCOPE_profile_cpu_f("gpu");
+    conversion_pool_->WaitIdle();
+  }
+}
+
 void TextureCache::ClearCache() {
   RemoveInvalidatedTextures();
   for (auto it = textures_.begin(); it != textures_.end(); ++it) {
@@ -20,6 +20,7 @@
 #include "xenia/gpu/sampler_info.h"
 #include "xenia/gpu/shader.h"
 #include "xenia/gpu/texture_conversion.h"
+#include "xenia/gpu/texture_conversion_pool.h"
 #include "xenia/gpu/texture_info.h"
 #include "xenia/gpu/trace_writer.h"
 #include "xenia/gpu/vulkan/vulkan_command_processor.h"
@@ -119,6 +120,11 @@ class TextureCache {
   // creates a new texture or returns a previously created texture.
   Texture* DemandResolveTexture(const TextureInfo& texture_info);
 
+  // Blocks until textures queued for upload have been converted into staging
+  // memory. Must be called before submitting the command buffers they were
+  // uploaded with.
+  void WaitForPendingUploads();
+
   // Clears all cached content.
   void ClearCache();
 
@@ -163,8 +169,10 @@ class TextureCache {
   void FlushPendingCommands(VkCommandBuffer command_buffer,
                             VkFence completion_fence);
 
+  // Converts a mip into dest, or queues the conversion on conversion_pool_
+  // if async is set.
   bool ConvertTexture(uint8_t* dest, VkBufferImageCopy* copy_region,
-                      uint32_t mip, const TextureInfo& src);
+                      uint32_t mip, const TextureInfo& src, bool async);
 
   static const FormatInfo* GetFormatInfo(TextureFormat format);
   static texture_conversion::CopyBlockCallback GetFormatCopyBlock(
@@ -216,6 +224,7 @@ class TextureCache {
 
   ui::vulkan::CircularBuffer staging_buffer_;
   ui::vulkan::CircularBuffer wb_staging_buffer_;
+  std::unique_ptr<TextureConversionPool> conversion_pool_;
   std::unordered_map<uint64_t, Texture*> textures_;
   std::unordered_map<uint64_t, Sampler*> samplers_;
   std::list<Texture*> pending_delete_textures_;
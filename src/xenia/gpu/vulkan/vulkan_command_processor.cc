@@ -529,6 +529,10 @@ void VulkanCommandProcessor::PerformSwap(uint32_t frontbuffer_ptr,
 
   submit_buffers.push_back(copy_commands);
   if (!submit_buffers.empty()) {
+    // Texture uploads in the setup buffer read staging memory that may still
+    // be being converted.
+    texture_cache_->WaitForPendingUploads();
+
     // TODO(benvanik): move to CP or to host (trace dump, etc).
     // This only needs to surround a vkQueueSubmit.
     if (queue_mutex_) {
@@ -14,3 +14,8 @@ DEFINE_bool(vulkan_renderdoc_capture_all, false,
 DEFINE_bool(vulkan_native_msaa, false, "Use native MSAA", "Vulkan");
 DEFINE_bool(vulkan_dump_disasm, false,
             "Dump shader disassembly. NVIDIA only supported.", "Vulkan");
+DEFINE_int32(vulkan_texture_upload_threads, -1,
+             "Number of threads untiling and converting textures for upload. "
+             "-1 to pick from the number of host cores, 0 to convert them on "
+             "the GPU thread.",
+             "Vulkan");
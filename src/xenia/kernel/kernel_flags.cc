@@ -14,3 +14,11 @@ DEFINE_bool(headless, false,
             "UI");
 DEFINE_bool(log_high_frequency_kernel_calls, false,
             "Log kernel calls with the kHighFrequency tag.", "Kernel");
+DEFINE_int32(io_thread_count, 2,
+             "Host threads completing reads and writes of asynchronous files. "
+             "0 completes them on the calling guest thread.",
+             "Kernel");
+DEFINE_bool(kernel_spin_lock_stats, false,
+            "Count contended acquires of each guest spin lock and log the most "
+            "contended ones on exit.",
+            "Kernel");
@@ -13,5 +13,7 @@
 
 DECLARE_bool(headless);
 DECLARE_bool(log_high_frequency_kernel_calls);
+DECLARE_int32(io_thread_count);
+DECLARE_bool(kernel_spin_lock_stats);
 
 #endif  // XENIA_KERNEL_KERNEL_FLAGS_H_
@@ -17,6 +17,7 @@
 #include "xenia/base/string.h"
 #include "xenia/cpu/processor.h"
 #include "xenia/emulator.h"
+#include "xenia/kernel/kernel_flags.h"
 #include "xenia/kernel/user_module.h"
 #include "xenia/kernel/util/shim_utils.h"
 #include "xenia/kernel/xam/xam_module.h"
@@ -60,10 +61,18 @@ KernelState::KernelState(Emulator* emulator)
   // Hardcoded maximum of 2048 TLS slots.
   tls_bitmap_.Resize(2048);
 
+  if (cvars::io_thread_count > 0) {
+    io_worker_pool_ =
+        std::make_unique<util::IOWorkerPool>(cvars::io_thread_count);
+  }
+
   xam::AppManager::RegisterApps(this, app_manager_.get());
 }
 
 KernelState::~KernelState() {
+  // Requests in flight hold references to the files and threads involved.
+  io_worker_pool_.reset();
+
   SetExecutableModule(nullptr);
 
   if (dispatch_thread_running_) {
@@ -440,7 +449,7 @@ void KernelState::UnloadUserModule(const object_ref<UserModule>& module,
 
 void KernelState::TerminateTitle() {
   XELOGD("KernelState::TerminateTitle");
-  auto global_lock = global_critical_region_.Acquire();
+  auto suspend_lock = processor_->AcquireSuspendLock();
 
   // Call terminate routines.
   // TODO(benvanik): these might take arguments.
@@ -469,10 +478,10 @@ void KernelState::TerminateTitle() {
           thread->thread()->Suspend();
         }
 
-        global_lock.unlock();
+        suspend_lock.unlock();
         processor_->StepToGuestSafePoint(thread->thread_id());
         thread->Terminate(0);
-        global_lock.lock();
+        suspend_lock.lock();
       }
 
       // Erase it from the thread list.
@@ -513,7 +522,7 @@ void KernelState::TerminateTitle() {
 
     // Now commit suicide (using Terminate, because we can't call into guest
     // code anymore).
-    global_lock.unlock();
+    suspend_lock.unlock();
     XThread::GetCurrentThread()->Terminate(0);
   }
 }
@@ -717,6 +726,11 @@ bool KernelState::Save(ByteStream* stream) {
   XELOGD("Serializing the kernel...");
   stream->Write('KRNL');
 
+  // Let file requests in flight finish writing to guest memory first.
+  if (io_worker_pool_) {
+    io_worker_pool_->WaitIdle();
+  }
+
   // Save the object table
   object_table_.Save(stream);
 
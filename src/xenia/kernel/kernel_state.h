@@ -21,6 +21,7 @@
 #include "xenia/base/cvar.h"
 #include "xenia/base/mutex.h"
 #include "xenia/cpu/export_resolver.h"
+#include "xenia/kernel/util/io_worker_pool.h"
 #include "xenia/kernel/util/native_list.h"
 #include "xenia/kernel/util/object_table.h"
 #include "xenia/kernel/xam/app_manager.h"
@@ -163,6 +164,9 @@ class KernelState {
 
   util::NativeList* dpc_list() { return &dpc_list_; }
 
+  // Null if asynchronous file requests complete on the calling thread.
+  util::IOWorkerPool* io_worker_pool() const { return io_worker_pool_.get(); }
+
   void CompleteOverlapped(uint32_t overlapped_ptr, X_RESULT result);
   void CompleteOverlappedEx(uint32_t overlapped_ptr, X_RESULT result,
                             uint32_t extended_error, uint32_t length);
@@ -213,6 +217,8 @@ class KernelState {
   std::condition_variable_any dispatch_cond_;
   std::list<std::function<void()>> dispatch_queue_;
 
+  std::unique_ptr<util::IOWorkerPool> io_worker_pool_;
+
   BitMap tls_bitmap_;
 
   friend class XObject;
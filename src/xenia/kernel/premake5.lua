@@ -20,3 +20,5 @@ project("xenia-kernel")
   files({
     "debug_visualizers.natvis",
   })
+
+include("testing")
@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/io_worker_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace kernel {
+namespace test {
+
+using util::IOWorkerPool;
+
+TEST_CASE("io_worker_pool_requests", "IOWorkerPool") {
+  for (uint32_t thread_count : {0u, 1u, 2u}) {
+    IOWorkerPool pool(thread_count);
+    std::atomic<uint32_t> request_count(0);
+    for (int i = 0; i < 1000; ++i) {
+      pool.Queue([&]() { ++request_count; });
+    }
+    pool.WaitIdle();
+    REQUIRE(request_count == 1000);
+  }
+}
+
+TEST_CASE("io_worker_pool_wait_idle", "IOWorkerPool") {
+  IOWorkerPool pool(2);
+  // Idle from the start.
+  pool.WaitIdle();
+
+  // Waits for requests that are already running, not only queued ones.
+  std::atomic<bool> started(false);
+  std::atomic<bool> finished(false);
+  pool.Queue([&]() {
+    started = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    finished = true;
+  });
+  while (!started) {
+    std::this_thread::yield();
+  }
+  pool.WaitIdle();
+  REQUIRE(finished);
+
+  // Requests queued by running ones are waited for too.
+  std::atomic<uint32_t> request_count(0);
+  for (int i = 0; i < 10; ++i) {
+    pool.Queue([&]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      pool.Queue([&]() { ++request_count; });
+      ++request_count;
+    });
+  }
+  pool.WaitIdle();
+  REQUIRE(request_count == 20);
+}
+
+TEST_CASE("io_worker_pool_shutdown", "IOWorkerPool") {
+  for (uint32_t thread_count : {1u, 2u}) {
+    std::atomic<uint32_t> request_count(0);
+    auto pool = std::make_unique<IOWorkerPool>(thread_count);
+    for (int i = 0; i < 100; ++i) {
+      pool->Queue([&]() {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        ++request_count;
+      });
+    }
+    // Still has work queued, which must all complete before this returns.
+    pool.reset();
+    REQUIRE(request_count == 100);
+  }
+
+  // Shutting down a pool that never got any work.
+  IOWorkerPool idle_pool(2);
+}
+
+}  // namespace test
+}  // namespace kernel
+}  // namespace xe
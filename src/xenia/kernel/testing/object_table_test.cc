@@ -0,0 +1,162 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/object_table.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "xenia/kernel/xevent.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace kernel {
+namespace test {
+
+using util::ObjectTable;
+
+object_ref<XEvent> MakeTestEvent() {
+  // Without a kernel state, so there's no guest object or automatic handle.
+  auto event = object_ref<XEvent>(new XEvent(nullptr));
+  X_DISPATCH_HEADER header = {};
+  header.type = 1;  // Auto reset.
+  event->InitializeNative(nullptr, &header);
+  return event;
+}
+
+TEST_CASE("object_table_handles", "ObjectTable") {
+  ObjectTable table;
+  auto event = MakeTestEvent();
+  X_HANDLE handle = 0;
+  REQUIRE(table.AddHandle(event.get(), &handle) == X_STATUS_SUCCESS);
+  REQUIRE(handle);
+  REQUIRE(table.LookupObject<XEvent>(handle).get() == event.get());
+
+  X_HANDLE duplicate_handle = 0;
+  REQUIRE(table.DuplicateHandle(handle, &duplicate_handle) == X_STATUS_SUCCESS);
+  REQUIRE(duplicate_handle != handle);
+  REQUIRE(table.LookupObject<XEvent>(duplicate_handle).get() == event.get());
+
+  REQUIRE(table.RetainHandle(handle) == X_STATUS_SUCCESS);
+  REQUIRE(table.ReleaseHandle(handle) == X_STATUS_SUCCESS);
+  REQUIRE(table.LookupObject<XEvent>(handle).get() == event.get());
+  REQUIRE(table.ReleaseHandle(handle) == X_STATUS_SUCCESS);
+  REQUIRE(!table.LookupObject<XEvent>(handle));
+  REQUIRE(table.ReleaseHandle(duplicate_handle) == X_STATUS_SUCCESS);
+  REQUIRE(event->handles().empty());
+
+  REQUIRE(!table.LookupObject<XEvent>(0x12345678));
+}
+
+TEST_CASE("object_table_grow", "ObjectTable") {
+  ObjectTable table;
+  auto event = MakeTestEvent();
+  // Enough handles to need more than the initial entries.
+  std::vector<X_HANDLE> handles(40000);
+  for (auto& handle : handles) {
+    REQUIRE(table.AddHandle(event.get(), &handle) == X_STATUS_SUCCESS);
+  }
+  for (auto handle : handles) {
+    REQUIRE(table.LookupObject<XEvent>(handle).get() == event.get());
+  }
+  for (auto handle : handles) {
+    REQUIRE(table.ReleaseHandle(handle) == X_STATUS_SUCCESS);
+  }
+  REQUIRE(event->handles().empty());
+}
+
+TEST_CASE("object_table_concurrent_lookup", "ObjectTable") {
+  ObjectTable table;
+  auto event = MakeTestEvent();
+  X_HANDLE handle = 0;
+  REQUIRE(table.AddHandle(event.get(), &handle) == X_STATUS_SUCCESS);
+
+  // Lookups racing with another object being added and removed must see it or
+  // nothing, and never one that's been freed.
+  std::atomic<bool> done(false);
+  std::atomic<X_HANDLE> churn_handle(0);
+  std::atomic<uint64_t> bad_lookups(0);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+      while (!done) {
+        if (table.LookupObject<XEvent>(handle).get() != event.get()) {
+          ++bad_lookups;
+        }
+        auto churn_event = table.LookupObject<XEvent>(churn_handle);
+        if (churn_event && churn_event->type() != XObject::kTypeEvent) {
+          ++bad_lookups;
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 10000; ++i) {
+    auto churn_event = MakeTestEvent();
+    X_HANDLE new_handle = 0;
+    table.AddHandle(churn_event.get(), &new_handle);
+    churn_handle = new_handle;
+    churn_event.reset();
+    table.ReleaseHandle(new_handle);
+  }
+  done = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(bad_lookups == 0);
+  REQUIRE(table.ReleaseHandle(handle) == X_STATUS_SUCCESS);
+}
+
+// Eight threads looking up events and signaling them, as a job system waking
+// workers would.
+TEST_CASE("object_table_benchmark", "[.benchmark]") {
+  const int thread_count = 8;
+  const int iteration_count = 1000000;
+  ObjectTable table;
+  std::vector<object_ref<XEvent>> events;
+  std::vector<X_HANDLE> handles;
+  for (int i = 0; i < thread_count; ++i) {
+    events.push_back(MakeTestEvent());
+    X_HANDLE handle = 0;
+    table.AddHandle(events.back().get(), &handle);
+    handles.push_back(handle);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&, i]() {
+      for (int j = 0; j < iteration_count; ++j) {
+        // Look up our own event, as a wait would, and signal the next one.
+        auto own = table.LookupObject<XEvent>(handles[i]);
+        auto next = table.LookupObject<XEvent>(handles[(i + 1) % thread_count]);
+        next->Set(0, false);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  double lookup_count = 2.0 * thread_count * iteration_count;
+  std::printf("%d threads: %.1fns per lookup\n", thread_count,
+              elapsed.count() * 1000.0 / lookup_count);
+
+  for (auto handle : handles) {
+    table.ReleaseHandle(handle);
+  }
+}
+
+}  // namespace test
+}  // namespace kernel
+}  // namespace xe
@@ -0,0 +1,21 @@
+project_root = "../../../.."
+include(project_root.."/tools/build")
+
+test_suite("xenia-kernel-tests", project_root, ".", {
+  links = {
+    "xenia-base",
+    "xenia-core",
+    "xenia-kernel",
+
+    -- TODO(benvanik): cut these dependencies?
+    "aes_128",
+    "capstone",
+    "xenia-apu",
+    "xenia-cpu",
+    "xenia-cpu-backend-x64",
+    "xenia-hid",
+    "xenia-ui", -- needed by xenia-base
+    "xenia-vfs",
+    "xxhash",
+  },
+})
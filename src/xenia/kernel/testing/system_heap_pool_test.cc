@@ -0,0 +1,150 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/memory.h"
+
+#include <set>
+#include <vector>
+
+#include "xenia/base/byte_stream.h"
+
+#include "third_party/catch/include/catch.hpp"
+
+namespace xe {
+namespace kernel {
+namespace test {
+
+TEST_CASE("system_heap_pool_alloc_free", "SystemHeapPool") {
+  Memory memory;
+  REQUIRE(memory.Initialize());
+  SystemHeapPool pool;
+  pool.Initialize(memory.LookupHeapByType(false, 4096));
+
+  std::set<uint32_t> addresses;
+  for (uint32_t size = 1; size <= SystemHeapPool::kMaxBlockSize; size += 7) {
+    uint32_t address = pool.Alloc(size, 4);
+    REQUIRE(address);
+    REQUIRE(pool.Contains(address));
+    REQUIRE(addresses.insert(address).second);
+    // Blocks are aligned to their size.
+    uint32_t block_size = SystemHeapPool::kMinBlockSize;
+    while (block_size < size) {
+      block_size <<= 1;
+    }
+    REQUIRE(!(address & (block_size - 1)));
+  }
+  uint32_t aligned_address = pool.Alloc(32, 1024);
+  REQUIRE(aligned_address);
+  REQUIRE(!(aligned_address & 1023));
+  addresses.insert(aligned_address);
+
+  // Left for the heap itself.
+  REQUIRE(!pool.Alloc(SystemHeapPool::kMaxBlockSize + 1, 4));
+  REQUIRE(!pool.Alloc(32, SystemHeapPool::kMaxBlockSize * 2));
+  REQUIRE(!pool.Alloc(32, 24));
+
+  for (uint32_t address : addresses) {
+    REQUIRE(pool.Free(address));
+  }
+}
+
+TEST_CASE("system_heap_pool_double_free", "SystemHeapPool") {
+  Memory memory;
+  REQUIRE(memory.Initialize());
+  SystemHeapPool pool;
+  pool.Initialize(memory.LookupHeapByType(false, 4096));
+
+  uint32_t address = pool.Alloc(64, 4);
+  uint32_t other_address = pool.Alloc(64, 4);
+  REQUIRE(address);
+  REQUIRE(other_address);
+  REQUIRE(pool.Free(address));
+  REQUIRE(!pool.Free(address));
+  // Not the start of a block.
+  REQUIRE(!pool.Free(other_address + 8));
+  REQUIRE(pool.Free(other_address));
+  REQUIRE(!pool.Free(other_address));
+
+  // Freed blocks are handed out again.
+  REQUIRE(pool.Alloc(64, 4) == address);
+}
+
+TEST_CASE("system_heap_pool_slab_release", "SystemHeapPool") {
+  Memory memory;
+  REQUIRE(memory.Initialize());
+  SystemHeapPool pool;
+  pool.Initialize(memory.LookupHeapByType(false, 4096));
+
+  // Three slabs' worth of blocks.
+  const uint32_t block_size = 256;
+  const uint32_t blocks_per_slab = SystemHeapPool::kSlabSize / block_size;
+  std::vector<uint32_t> addresses;
+  std::set<uint32_t> slab_addresses;
+  for (uint32_t i = 0; i < blocks_per_slab * 3; ++i) {
+    uint32_t address = pool.Alloc(block_size, 4);
+    REQUIRE(address);
+    addresses.push_back(address);
+    slab_addresses.insert(address & ~(SystemHeapPool::kSlabSize - 1));
+  }
+  REQUIRE(slab_addresses.size() == 3);
+
+  for (uint32_t address : addresses) {
+    REQUIRE(pool.Free(address));
+  }
+  // Empty slabs go back to the heap, except one kept for the next allocation.
+  uint32_t kept_count = 0;
+  for (uint32_t slab_address : slab_addresses) {
+    if (pool.Contains(slab_address)) {
+      ++kept_count;
+    }
+  }
+  REQUIRE(kept_count == 1);
+  uint32_t address = pool.Alloc(block_size, 4);
+  REQUIRE(address);
+  REQUIRE(pool.Contains(address));
+  REQUIRE(pool.Free(address));
+  REQUIRE(pool.Contains(address));
+}
+
+TEST_CASE("system_heap_pool_save_restore", "SystemHeapPool") {
+  Memory memory;
+  REQUIRE(memory.Initialize());
+  SystemHeapPool pool;
+  pool.Initialize(memory.LookupHeapByType(false, 4096));
+
+  uint32_t address = pool.Alloc(32, 4);
+  uint32_t freed_address = pool.Alloc(32, 4);
+  uint32_t large_address = pool.Alloc(2048, 4);
+  REQUIRE(pool.Free(freed_address));
+
+  std::vector<uint8_t> buffer(64 * 1024);
+  ByteStream save_stream(buffer.data(), buffer.size());
+  REQUIRE(pool.Save(&save_stream));
+  size_t save_length = save_stream.offset();
+
+  ByteStream restore_stream(buffer.data(), save_length);
+  REQUIRE(pool.Restore(&restore_stream));
+  REQUIRE(pool.Contains(address));
+  REQUIRE(pool.Contains(large_address));
+  REQUIRE(!pool.Free(freed_address));
+  REQUIRE(pool.Alloc(32, 4) == freed_address);
+  REQUIRE(pool.Free(address));
+  REQUIRE(pool.Free(large_address));
+
+  // A block size that isn't a power of two. Nothing is left half restored.
+  buffer[sizeof(uint32_t) * 2] = 48;
+  ByteStream corrupt_stream(buffer.data(), save_length);
+  REQUIRE(!pool.Restore(&corrupt_stream));
+  REQUIRE(!pool.Contains(address));
+  REQUIRE(!pool.Contains(large_address));
+}
+
+}  // namespace test
+}  // namespace kernel
+}  // namespace xe
@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include "xenia/kernel/util/io_worker_pool.h"
+
+#include "xenia/base/logging.h"
+
+namespace xe {
+namespace kernel {
+namespace util {
+
+IOWorkerPool::IOWorkerPool(uint32_t thread_count) {
+  for (uint32_t i = 0; i < thread_count; ++i) {
+    xe::threading::Thread::CreationParameters params;
+    auto thread = xe::threading::Thread::Create(
+        params, [this]() { WorkerThread(); });
+    if (!thread) {
+      XELOGE("Unable to create I/O worker thread");
+      break;
+    }
+    thread->set_name("I/O Worker");
+    threads_.push_back(std::move(thread));
+  }
+}
+
+IOWorkerPool::~IOWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    shutting_down_ = true;
+  }
+  queue_cond_.notify_all();
+  // Waiting on the threads themselves isn't supported everywhere, so they
+  // check out as they exit instead.
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  idle_cond_.wait(lock,
+                  [this]() { return exited_count_ == threads_.size(); });
+}
+
+void IOWorkerPool::Queue(std::function<void()> request) {
+  // Without threads, degrade to completing on the caller.
+  if (threads_.empty()) {
+    request();
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queue_.push_back(std::move(request));
+  }
+  queue_cond_.notify_one();
+}
+
+void IOWorkerPool::WaitIdle() {
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  idle_cond_.wait(lock,
+                  [this]() { return queue_.empty() && !running_count_; });
+}
+
+void IOWorkerPool::WorkerThread() {
+  std::unique_lock<std::mutex> lock(queue_mutex_);
+  while (true) {
+    queue_cond_.wait(lock,
+                     [this]() { return shutting_down_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      // Shutting down with nothing left to do.
+      ++exited_count_;
+      idle_cond_.notify_all();
+      break;
+    }
+    auto request = std::move(queue_.front());
+    queue_.pop_front();
+    ++running_count_;
+    lock.unlock();
+    request();
+    lock.lock();
+    --running_count_;
+    if (queue_.empty() && !running_count_) {
+      idle_cond_.notify_all();
+    }
+  }
+}
+
+}  // namespace util
+}  // namespace kernel
+}  // namespace xe
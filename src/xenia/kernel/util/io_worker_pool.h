@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#ifndef XENIA_KERNEL_UTIL_IO_WORKER_POOL_H_
+#define XENIA_KERNEL_UTIL_IO_WORKER_POOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "xenia/base/threading.h"
+
+namespace xe {
+namespace kernel {
+namespace util {
+
+// Host threads that run asynchronous file requests, so the guest thread that
+// issued them can keep going while the host blocks on the file.
+//
+// Requests run in the order they were queued, but with more than one thread
+// they may complete in any order.
+class IOWorkerPool {
+ public:
+  explicit IOWorkerPool(uint32_t thread_count);
+  // Runs everything still queued before returning.
+  ~IOWorkerPool();
+
+  void Queue(std::function<void()> request);
+
+  // Blocks until no requests are queued or running.
+  void WaitIdle();
+
+ private:
+  void WorkerThread();
+
+  std::vector<std::unique_ptr<xe::threading::Thread>> threads_;
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cond_;
+  std::condition_variable idle_cond_;
+  std::deque<std::function<void()>> queue_;
+  uint32_t running_count_ = 0;
+  size_t exited_count_ = 0;
+  bool shutting_down_ = false;
+};
+
+}  // namespace util
+}  // namespace kernel
+}  // namespace xe
+
+#endif  // XENIA_KERNEL_UTIL_IO_WORKER_POOL_H_
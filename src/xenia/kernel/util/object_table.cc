@@ -14,6 +14,7 @@
 
 #include "xenia/base/byte_stream.h"
 #include "xenia/base/logging.h"
+#include "xenia/base/threading.h"
 #include "xenia/kernel/xobject.h"
 #include "xenia/kernel/xthread.h"
 
@@ -29,17 +30,31 @@ void ObjectTable::Reset() {
   auto global_lock = global_critical_region_.Acquire();
 
   // Release all objects.
-  for (uint32_t n = 0; n < table_capacity_; n++) {
-    ObjectTableEntry& entry = table_[n];
-    if (entry.object) {
-      entry.object->Release();
+  uint32_t table_capacity = table_capacity_;
+  for (uint32_t n = 0; n < table_capacity; n++) {
+    auto object = DetachObject(entry_at(n));
+    if (object) {
+      object->Release();
     }
   }
 
   table_capacity_ = 0;
   last_free_entry_ = 0;
-  free(table_);
-  table_ = nullptr;
+  for (auto& block : blocks_) {
+    delete[] block.exchange(nullptr);
+  }
+}
+
+XObject* ObjectTable::DetachObject(ObjectTableEntry& entry) {
+  auto object = entry.object.exchange(nullptr);
+  if (object) {
+    // A lookup that read the pointer before it was cleared is about to retain
+    // it, and the reference we drop may be the last one.
+    while (entry.reader_count.load()) {
+      xe::threading::MaybeYield();
+    }
+  }
+  return object;
 }
 
 X_STATUS ObjectTable::FindFreeSlot(uint32_t* out_slot) {
@@ -47,7 +62,7 @@ X_STATUS ObjectTable::FindFreeSlot(uint32_t* out_slot) {
   uint32_t slot = last_free_entry_;
   uint32_t scan_count = 0;
   while (scan_count < table_capacity_) {
-    ObjectTableEntry& entry = table_[slot];
+    ObjectTableEntry& entry = entry_at(slot);
     if (!entry.object) {
       *out_slot = slot;
       return X_STATUS_SUCCESS;
@@ -75,23 +90,23 @@ X_STATUS ObjectTable::FindFreeSlot(uint32_t* out_slot) {
 }
 
 bool ObjectTable::Resize(uint32_t new_capacity) {
-  uint32_t new_size = new_capacity * sizeof(ObjectTableEntry);
-  uint32_t old_size = table_capacity_ * sizeof(ObjectTableEntry);
-  auto new_table =
-      reinterpret_cast<ObjectTableEntry*>(realloc(table_, new_size));
-  if (!new_table) {
+  // Only ever grows, as lookups may be using any existing entry.
+  uint32_t old_capacity = table_capacity_;
+  new_capacity = std::max(new_capacity, old_capacity);
+  uint32_t block_count =
+      (new_capacity + kEntriesPerBlock - 1) / kEntriesPerBlock;
+  if (block_count > kMaxBlockCount) {
     return false;
   }
-
-  // Zero out new entries.
-  if (new_size > old_size) {
-    std::memset(reinterpret_cast<uint8_t*>(new_table) + old_size, 0,
-                new_size - old_size);
+  for (uint32_t i = 0; i < block_count; ++i) {
+    if (!blocks_[i].load(std::memory_order_relaxed)) {
+      blocks_[i].store(new ObjectTableEntry[kEntriesPerBlock],
+                       std::memory_order_relaxed);
+    }
   }
 
-  last_free_entry_ = table_capacity_;
-  table_capacity_ = new_capacity;
-  table_ = new_table;
+  last_free_entry_ = old_capacity;
+  table_capacity_.store(new_capacity, std::memory_order_release);
 
   return true;
 }
@@ -109,8 +124,7 @@ X_STATUS ObjectTable::AddHandle(XObject* object, X_HANDLE* out_handle) {
 
     // Stash.
     if (XSUCCEEDED(result)) {
-      ObjectTableEntry& entry = table_[slot];
-      entry.object = object;
+      ObjectTableEntry& entry = entry_at(slot);
       entry.handle_ref_count = 1;
 
       handle = slot << 2;
@@ -118,6 +132,7 @@ X_STATUS ObjectTable::AddHandle(XObject* object, X_HANDLE* out_handle) {
 
       // Retain so long as the object is in the table.
       object->Retain();
+      entry.object = object;
 
       XELOGI("Added handle:%08X for %s", handle, typeid(*object).name());
     }
@@ -136,10 +151,10 @@ X_STATUS ObjectTable::DuplicateHandle(X_HANDLE handle, X_HANDLE* out_handle) {
   X_STATUS result = X_STATUS_SUCCESS;
   handle = TranslateHandle(handle);
 
-  XObject* object = LookupObject(handle, false);
+  XObject* object = RetainObject(handle);
   if (object) {
     result = AddHandle(object, out_handle);
-    object->Release();  // Release the ref that LookupObject took
+    object->Release();  // Release the ref that RetainObject took
   } else {
     result = X_STATUS_INVALID_HANDLE;
   }
@@ -191,9 +206,8 @@ X_STATUS ObjectTable::RemoveHandle(X_HANDLE handle) {
   }
 
   auto global_lock = global_critical_region_.Acquire();
-  if (entry->object) {
-    auto object = entry->object;
-    entry->object = nullptr;
+  auto object = DetachObject(*entry);
+  if (object) {
     assert_zero(entry->handle_ref_count);
     entry->handle_ref_count = 0;
 
@@ -218,11 +232,11 @@ std::vector<object_ref<XObject>> ObjectTable::GetAllObjects() {
   std::vector<object_ref<XObject>> results;
 
   for (uint32_t slot = 0; slot < table_capacity_; slot++) {
-    auto& entry = table_[slot];
-    if (entry.object && std::find(results.begin(), results.end(),
-                                  entry.object) == results.end()) {
-      entry.object->Retain();
-      results.push_back(object_ref<XObject>(entry.object));
+    auto object = entry_at(slot).object.load();
+    if (object &&
+        std::find(results.begin(), results.end(), object) == results.end()) {
+      object->Retain();
+      results.push_back(object_ref<XObject>(object));
     }
   }
 
@@ -232,12 +246,11 @@ std::vector<object_ref<XObject>> ObjectTable::GetAllObjects() {
 void ObjectTable::PurgeAllObjects() {
   auto lock = global_critical_region_.Acquire();
   for (uint32_t slot = 0; slot < table_capacity_; slot++) {
-    auto& entry = table_[slot];
-    if (entry.object && !entry.object->is_host_object()) {
+    auto& entry = entry_at(slot);
+    auto object = entry.object.load();
+    if (object && !object->is_host_object()) {
       entry.handle_ref_count = 0;
-      entry.object->Release();
-
-      entry.object = nullptr;
+      DetachObject(entry)->Release();
     }
   }
 }
@@ -248,12 +261,10 @@ ObjectTable::ObjectTableEntry* ObjectTable::LookupTable(X_HANDLE handle) {
     return nullptr;
   }
 
-  auto global_lock = global_critical_region_.Acquire();
-
   // Lower 2 bits are ignored.
   uint32_t slot = handle >> 2;
-  if (slot <= table_capacity_) {
-    return &table_[slot];
+  if (slot < table_capacity_.load(std::memory_order_acquire)) {
+    return &entry_at(slot);
   }
 
   return nullptr;
@@ -262,41 +273,25 @@ ObjectTable::ObjectTableEntry* ObjectTable::LookupTable(X_HANDLE handle) {
 // Generic lookup
 template <>
 object_ref<XObject> ObjectTable::LookupObject<XObject>(X_HANDLE handle) {
-  auto object = ObjectTable::LookupObject(handle, false);
+  auto object = ObjectTable::RetainObject(handle);
   auto result = object_ref<XObject>(reinterpret_cast<XObject*>(object));
   return result;
 }
 
-XObject* ObjectTable::LookupObject(X_HANDLE handle, bool already_locked) {
-  handle = TranslateHandle(handle);
-  if (!handle) {
+XObject* ObjectTable::RetainObject(X_HANDLE handle) {
+  ObjectTableEntry* entry = LookupTable(handle);
+  if (!entry) {
     return nullptr;
   }
 
-  XObject* object = nullptr;
-  if (!already_locked) {
-    global_critical_region_.mutex().lock();
-  }
-
-  // Lower 2 bits are ignored.
-  uint32_t slot = handle >> 2;
-
-  // Verify slot.
-  if (slot < table_capacity_) {
-    ObjectTableEntry& entry = table_[slot];
-    if (entry.object) {
-      object = entry.object;
-    }
-  }
-
-  // Retain the object pointer.
+  // Pin the entry so the object can't be released from under us before we
+  // retain it.
+  entry->reader_count.fetch_add(1);
+  XObject* object = entry->object.load();
   if (object) {
     object->Retain();
   }
-
-  if (!already_locked) {
-    global_critical_region_.mutex().unlock();
-  }
+  entry->reader_count.fetch_sub(1);
 
   return object;
 }
@@ -305,11 +300,11 @@ void ObjectTable::GetObjectsByType(XObject::Type type,
                                    std::vector<object_ref<XObject>>* results) {
   auto global_lock = global_critical_region_.Acquire();
   for (uint32_t slot = 0; slot < table_capacity_; ++slot) {
-    auto& entry = table_[slot];
-    if (entry.object) {
-      if (entry.object->type() == type) {
-        entry.object->Retain();
-        results->push_back(object_ref<XObject>(entry.object));
+    auto object = entry_at(slot).object.load();
+    if (object) {
+      if (object->type() == type) {
+        object->Retain();
+        results->push_back(object_ref<XObject>(object));
       }
     }
   }
@@ -371,7 +366,7 @@ X_STATUS ObjectTable::GetObjectByName(const std::string& name,
   *out_handle = it->second;
 
   // We need to ref the handle. I think.
-  auto obj = LookupObject(it->second, true);
+  auto obj = RetainObject(it->second);
   if (obj) {
     obj->RetainHandle();
     obj->Release();
@@ -381,9 +376,10 @@ X_STATUS ObjectTable::GetObjectByName(const std::string& name,
 }
 
 bool ObjectTable::Save(ByteStream* stream) {
+  auto global_lock = global_critical_region_.Acquire();
   stream->Write<uint32_t>(table_capacity_);
   for (uint32_t i = 0; i < table_capacity_; i++) {
-    auto& entry = table_[i];
+    auto& entry = entry_at(i);
     stream->Write<int32_t>(entry.handle_ref_count);
   }
 
@@ -391,9 +387,13 @@ bool ObjectTable::Save(ByteStream* stream) {
 }
 
 bool ObjectTable::Restore(ByteStream* stream) {
-  Resize(stream->Read<uint32_t>());
-  for (uint32_t i = 0; i < table_capacity_; i++) {
-    auto& entry = table_[i];
+  auto global_lock = global_critical_region_.Acquire();
+  uint32_t table_capacity = stream->Read<uint32_t>();
+  if (!Resize(table_capacity)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < table_capacity; i++) {
+    auto& entry = entry_at(i);
     // entry.object = nullptr;
     entry.handle_ref_count = stream->Read<int32_t>();
   }
@@ -402,13 +402,14 @@ bool ObjectTable::Restore(ByteStream* stream) {
 }
 
 X_STATUS ObjectTable::RestoreHandle(X_HANDLE handle, XObject* object) {
+  auto global_lock = global_critical_region_.Acquire();
   uint32_t slot = handle >> 2;
-  assert_true(table_capacity_ >= slot);
+  assert_true(table_capacity_ > slot);
 
-  if (table_capacity_ >= slot) {
-    auto& entry = table_[slot];
-    entry.object = object;
+  if (table_capacity_ > slot) {
+    auto& entry = entry_at(slot);
     object->Retain();
+    entry.object = object;
   }
 
   return X_STATUS_SUCCESS;
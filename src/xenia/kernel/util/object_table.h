@@ -10,6 +10,7 @@
 #ifndef XENIA_KERNEL_UTIL_OBJECT_TABLE_H_
 #define XENIA_KERNEL_UTIL_OBJECT_TABLE_H_
 
+#include <atomic>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -26,6 +27,13 @@ namespace xe {
 namespace kernel {
 namespace util {
 
+// Maps guest handles to objects.
+//
+// Lookups don't take any locks, as every wait and event call does one; only
+// adding and removing handles takes the global lock. Entries live in blocks
+// that are never moved or freed while the table is in use, so lookups can
+// index them while the table grows, and an entry being looked up is pinned
+// so removing its object waits for the lookup to retain it first.
 class ObjectTable {
  public:
   ObjectTable();
@@ -48,7 +56,7 @@ class ObjectTable {
 
   template <typename T>
   object_ref<T> LookupObject(X_HANDLE handle) {
-    auto object = LookupObject(handle, false);
+    auto object = RetainObject(handle);
     if (object) {
       assert_true(object->type() == T::kType);
     }
@@ -81,13 +89,26 @@ class ObjectTable {
   void PurgeAllObjects();  // Purges the object table of all guest objects
 
  private:
-  typedef struct {
+  struct ObjectTableEntry {
+    // Only changed under the lock.
+    std::atomic<XObject*> object = {nullptr};
+    // Lookups in progress that may have read object but not retained it yet.
+    std::atomic<uint32_t> reader_count = {0};
     int handle_ref_count = 0;
-    XObject* object = nullptr;
-  } ObjectTableEntry;
+  };
+  static const uint32_t kEntriesPerBlock = 4096;
+  static const uint32_t kMaxBlockCount = 1024;
 
+  ObjectTableEntry& entry_at(uint32_t slot) {
+    return blocks_[slot / kEntriesPerBlock].load(
+        std::memory_order_relaxed)[slot % kEntriesPerBlock];
+  }
   ObjectTableEntry* LookupTable(X_HANDLE handle);
-  XObject* LookupObject(X_HANDLE handle, bool already_locked);
+  // Returns the object with a reference added, or nullptr. Lock free.
+  XObject* RetainObject(X_HANDLE handle);
+  // Clears the entry, returning the reference it held once no lookups can
+  // still be about to retain it. Must be called with the lock held.
+  XObject* DetachObject(ObjectTableEntry& entry);
   void GetObjectsByType(XObject::Type type,
                         std::vector<object_ref<XObject>>* results);
 
@@ -96,8 +117,9 @@ class ObjectTable {
   bool Resize(uint32_t new_capacity);
 
   xe::global_critical_region global_critical_region_;
-  uint32_t table_capacity_ = 0;
-  ObjectTableEntry* table_ = nullptr;
+  // Published after the blocks backing it, so lookups can trust it.
+  std::atomic<uint32_t> table_capacity_ = {0};
+  std::atomic<ObjectTableEntry*> blocks_[kMaxBlockCount] = {};
   uint32_t last_free_entry_ = 0;
   std::unordered_map<std::string, X_HANDLE> name_table_;
 };
@@ -150,6 +150,52 @@ dword_result_t NtOpenFile(lpdword_t handle_out, dword_t desired_access,
 }
 DECLARE_XBOXKRNL_EXPORT1(NtOpenFile, kFileSystem, kImplemented);
 
+// Runs a read or write of an asynchronous file on an I/O worker, completing
+// the status block, APC and event from there the way the synchronous path does
+// before returning. Requests without an offset aren't queued, as they must see
+// the file position left by the ones before them.
+X_STATUS QueueAsyncFileRequest(object_ref<XFile> file, object_ref<XEvent> ev,
+                               uint32_t apc_routine, uint32_t apc_context,
+                               uint32_t io_status_block_ptr, bool is_write,
+                               uint32_t buffer_ptr, uint32_t buffer_length,
+                               uint64_t byte_offset) {
+  auto memory = kernel_memory();
+  if (io_status_block_ptr) {
+    auto io_status_block =
+        memory->TranslateVirtual<X_IO_STATUS_BLOCK*>(io_status_block_ptr);
+    io_status_block->status = X_STATUS_PENDING;
+    io_status_block->information = 0;
+  }
+  if (ev) {
+    ev->Reset();
+  }
+
+  auto thread = retain_object(XThread::GetCurrentThread());
+  kernel_state()->io_worker_pool()->Queue([=]() {
+    uint32_t bytes_transferred = 0;
+    X_STATUS result =
+        is_write ? file->Write(buffer_ptr, buffer_length, byte_offset,
+                               &bytes_transferred, apc_context)
+                 : file->Read(buffer_ptr, buffer_length, byte_offset,
+                              &bytes_transferred, apc_context);
+    if (io_status_block_ptr) {
+      auto io_status_block =
+          memory->TranslateVirtual<X_IO_STATUS_BLOCK*>(io_status_block_ptr);
+      io_status_block->status = result;
+      io_status_block->information = XSUCCEEDED(result) ? bytes_transferred : 0;
+    }
+    // Low bit probably means do not queue to IO ports.
+    if ((apc_routine & ~1u) && apc_context) {
+      thread->EnqueueApc(apc_routine & ~1u, apc_context, io_status_block_ptr,
+                         0);
+    }
+    if (ev) {
+      ev->Set(0, false);
+    }
+  });
+  return X_STATUS_PENDING;
+}
+
 dword_result_t NtReadFile(dword_t file_handle, dword_t event_handle,
                           lpvoid_t apc_routine_ptr, lpvoid_t apc_context,
                           pointer_t<X_IO_STATUS_BLOCK> io_status_block,
@@ -168,57 +214,45 @@ dword_result_t NtReadFile(dword_t file_handle, dword_t event_handle,
     result = X_STATUS_INVALID_HANDLE;
   }
 
-  if (XSUCCEEDED(result)) {
-    if (true || file->is_synchronous()) {
-      // Synchronous.
-      uint32_t bytes_read = 0;
-      result = file->Read(
-          buffer.guest_address(), buffer_length,
-          byte_offset_ptr ? static_cast<uint64_t>(*byte_offset_ptr) : -1,
-          &bytes_read, apc_context);
-      if (io_status_block) {
-        io_status_block->status = result;
-        io_status_block->information = bytes_read;
-      }
-
-      // Queue the APC callback. It must be delivered via the APC mechanism even
-      // though were are completing immediately.
-      // Low bit probably means do not queue to IO ports.
-      if ((uint32_t)apc_routine_ptr & ~1) {
-        if (apc_context) {
-          auto thread = XThread::GetCurrentThread();
-          thread->EnqueueApc(static_cast<uint32_t>(apc_routine_ptr) & ~1u,
-                             apc_context, io_status_block, 0);
-        }
-      }
+  if (XSUCCEEDED(result) && !file->is_synchronous() && byte_offset_ptr &&
+      kernel_state()->io_worker_pool()) {
+    return QueueAsyncFileRequest(file, ev, apc_routine_ptr.guest_address(),
+                                 apc_context.guest_address(),
+                                 io_status_block.guest_address(), false,
+                                 buffer.guest_address(), buffer_length,
+                                 *byte_offset_ptr);
+  }
 
-      if (!file->is_synchronous()) {
-        result = X_STATUS_PENDING;
-      }
+  if (XSUCCEEDED(result)) {
+    // Synchronous, or completed before returning.
+    uint32_t bytes_read = 0;
+    result = file->Read(
+        buffer.guest_address(), buffer_length,
+        byte_offset_ptr ? static_cast<uint64_t>(*byte_offset_ptr) : -1,
+        &bytes_read, apc_context);
+    if (io_status_block) {
+      io_status_block->status = result;
+      io_status_block->information = bytes_read;
+    }
 
-      // Mark that we should signal the event now. We do this after
-      // we have written the info out.
-      signal_event = true;
-    } else {
-      // TODO(benvanik): async.
-
-      // X_STATUS_PENDING if not returning immediately.
-      // XFile is waitable and signalled after each async req completes.
-      // reset the input event (->Reset())
-      /*xeNtReadFileState* call_state = new xeNtReadFileState();
-      XAsyncRequest* request = new XAsyncRequest(
-      state, file,
-      (XAsyncRequest::CompletionCallback)xeNtReadFileCompleted,
-      call_state);*/
-      // result = file->Read(buffer.guest_address(), buffer_length, byte_offset,
-      //                     request);
-      if (io_status_block) {
-        io_status_block->status = X_STATUS_PENDING;
-        io_status_block->information = 0;
+    // Queue the APC callback. It must be delivered via the APC mechanism even
+    // though were are completing immediately.
+    // Low bit probably means do not queue to IO ports.
+    if ((uint32_t)apc_routine_ptr & ~1) {
+      if (apc_context) {
+        auto thread = XThread::GetCurrentThread();
+        thread->EnqueueApc(static_cast<uint32_t>(apc_routine_ptr) & ~1u,
+                           apc_context, io_status_block, 0);
       }
+    }
 
+    if (!file->is_synchronous()) {
       result = X_STATUS_PENDING;
     }
+
+    // Mark that we should signal the event now. We do this after
+    // we have written the info out.
+    signal_event = true;
   }
 
   if (XFAILED(result) && io_status_block) {
@@ -239,9 +273,6 @@ dword_result_t NtWriteFile(dword_t file_handle, dword_t event_handle,
                            pointer_t<X_IO_STATUS_BLOCK> io_status_block,
                            lpvoid_t buffer, dword_t buffer_length,
                            lpqword_t byte_offset_ptr) {
-  // Async not supported yet.
-  assert_zero(apc_routine);
-
   X_STATUS result = X_STATUS_SUCCESS;
   uint32_t info = 0;
 
@@ -258,42 +289,48 @@ dword_result_t NtWriteFile(dword_t file_handle, dword_t event_handle,
     result = X_STATUS_INVALID_HANDLE;
   }
 
+  if (XSUCCEEDED(result) && !file->is_synchronous() && byte_offset_ptr &&
+      kernel_state()->io_worker_pool()) {
+    return QueueAsyncFileRequest(file, ev, static_cast<uint32_t>(apc_routine),
+                                 apc_context.guest_address(),
+                                 io_status_block.guest_address(), true,
+                                 buffer.guest_address(), buffer_length,
+                                 *byte_offset_ptr);
+  }
+
   // Execute write.
   if (XSUCCEEDED(result)) {
-    // TODO(benvanik): async path.
-    if (true || file->is_synchronous()) {
-      // Synchronous request.
-      uint32_t bytes_written = 0;
-      result = file->Write(
-          buffer.guest_address(), buffer_length,
-          byte_offset_ptr ? static_cast<uint64_t>(*byte_offset_ptr) : -1,
-          &bytes_written, apc_context);
-      if (XSUCCEEDED(result)) {
-        info = bytes_written;
-      }
+    // Synchronous, or completed before returning.
+    uint32_t bytes_written = 0;
+    result = file->Write(
+        buffer.guest_address(), buffer_length,
+        byte_offset_ptr ? static_cast<uint64_t>(*byte_offset_ptr) : -1,
+        &bytes_written, apc_context);
+    if (XSUCCEEDED(result)) {
+      info = bytes_written;
+    }
 
-      if (!file->is_synchronous()) {
-        result = X_STATUS_PENDING;
-      }
+    if (io_status_block) {
+      io_status_block->status = X_STATUS_SUCCESS;
+      io_status_block->information = info;
+    }
 
-      if (io_status_block) {
-        io_status_block->status = X_STATUS_SUCCESS;
-        io_status_block->information = info;
+    // Queue the APC callback, as NtReadFile does.
+    if (static_cast<uint32_t>(apc_routine) & ~1u) {
+      if (apc_context) {
+        auto thread = XThread::GetCurrentThread();
+        thread->EnqueueApc(static_cast<uint32_t>(apc_routine) & ~1u,
+                           apc_context, io_status_block, 0);
       }
+    }
 
-      // Mark that we should signal the event now. We do this after
-      // we have written the info out.
-      signal_event = true;
-    } else {
-      // X_STATUS_PENDING if not returning immediately.
+    if (!file->is_synchronous()) {
       result = X_STATUS_PENDING;
-      info = 0;
-
-      if (io_status_block) {
-        io_status_block->status = X_STATUS_SUCCESS;
-        io_status_block->information = info;
-      }
     }
+
+    // Mark that we should signal the event now. We do this after
+    // we have written the info out.
+    signal_event = true;
   }
 
   if (XFAILED(result) && io_status_block) {
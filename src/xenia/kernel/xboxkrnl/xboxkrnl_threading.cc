@@ -8,13 +8,18 @@
  */
 
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "xenia/base/atomic.h"
 #include "xenia/base/clock.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/mutex.h"
+#include "xenia/base/platform.h"
 #include "xenia/cpu/processor.h"
+#include "xenia/kernel/kernel_flags.h"
 #include "xenia/kernel/kernel_state.h"
 #include "xenia/kernel/user_module.h"
 #include "xenia/kernel/util/shim_utils.h"
@@ -870,16 +875,105 @@ dword_result_t NtSignalAndWaitForSingleObjectEx(dword_t signal_handle,
 DECLARE_XBOXKRNL_EXPORT3(NtSignalAndWaitForSingleObjectEx, kThreading,
                          kImplemented, kBlocking, kHighFrequency);
 
+namespace {
+
+// Contended spin lock acquires spin for a while, as the holder is usually
+// about to release, and then park the host thread on the lock until it's
+// released instead of burning a host core while the holder is descheduled.
+const uint32_t kSpinLockSpinCount = 4000;
+// Guest code may release a lock by storing to it without calling into the
+// kernel, so parked threads check the lock again at least this often.
+const std::chrono::microseconds kSpinLockParkTimeout(1000);
+
+// Threads parked on any spin lock, so uncontended releases skip the wake.
+std::atomic<uint32_t> spin_lock_parked_count_(0);
+
+struct SpinLockContention {
+  uint64_t contended_count;
+  uint64_t park_count;
+};
+std::mutex spin_lock_contention_mutex_;
+std::unordered_map<uint32_t, SpinLockContention> spin_lock_contention_;
+
+// Only with --kernel_spin_lock_stats, as the map and its lock would add
+// contention of their own to the path being measured.
+void RecordSpinLockContention(uint32_t* lock, uint64_t park_count) {
+  if (!cvars::kernel_spin_lock_stats) {
+    return;
+  }
+  uint32_t guest_address = kernel_state()->memory()->HostToGuestVirtual(lock);
+  std::lock_guard<std::mutex> lock_guard(spin_lock_contention_mutex_);
+  auto& contention = spin_lock_contention_[guest_address];
+  ++contention.contended_count;
+  contention.park_count += park_count;
+}
+
+void AcquireSpinLockContended(uint32_t* lock) {
+  volatile uint32_t* lock_value = lock;
+  uint64_t park_count = 0;
+  uint32_t spin_count = 0;
+  while (*lock_value || !xe::atomic_cas(0, 1, lock)) {
+    if (spin_count < kSpinLockSpinCount) {
+      ++spin_count;
+#if XE_ARCH_AMD64
+      _mm_pause();
+#endif  // XE_ARCH_AMD64
+      continue;
+    }
+    spin_count = 0;
+    ++park_count;
+    spin_lock_parked_count_.fetch_add(1);
+    uint32_t value = *lock_value;
+    if (value) {
+      xe::threading::WaitForAddressChange(lock_value, value,
+                                          kSpinLockParkTimeout);
+    }
+    spin_lock_parked_count_.fetch_sub(1);
+  }
+  RecordSpinLockContention(lock, park_count);
+}
+
+void ReleaseSpinLock(uint32_t* lock) {
+  xe::atomic_dec(lock);
+  if (spin_lock_parked_count_.load()) {
+    xe::threading::WakeAddressWaiters(lock);
+  }
+}
+
+}  // namespace
+
+void LogSpinLockContention() {
+  std::vector<std::pair<uint32_t, SpinLockContention>> locks;
+  {
+    std::lock_guard<std::mutex> lock_guard(spin_lock_contention_mutex_);
+    locks.assign(spin_lock_contention_.begin(), spin_lock_contention_.end());
+  }
+  if (locks.empty()) {
+    return;
+  }
+  size_t count = std::min(locks.size(), size_t(10));
+  std::partial_sort(locks.begin(), locks.begin() + count, locks.end(),
+                    [](const auto& a, const auto& b) {
+                      return a.second.contended_count >
+                             b.second.contended_count;
+                    });
+  XELOGI("Most contended spin locks:");
+  for (size_t i = 0; i < count; ++i) {
+    XELOGI("  %.8X: %llu contended acquires, %llu parks", locks[i].first,
+           static_cast<unsigned long long>(locks[i].second.contended_count),
+           static_cast<unsigned long long>(locks[i].second.park_count));
+  }
+}
+
 uint32_t xeKeKfAcquireSpinLock(uint32_t* lock) {
   // XELOGD(
   //     "KfAcquireSpinLock(%.8X)",
   //     lock_ptr);
 
   // Lock.
-  while (!xe::atomic_cas(0, 1, lock)) {
-    // Spin!
+  if (!xe::atomic_cas(0, 1, lock)) {
     // TODO(benvanik): error on deadlock?
-    xe::threading::MaybeYield();
+    AcquireSpinLockContended(lock);
   }
 
   // Raise IRQL to DISPATCH.
@@ -902,7 +996,7 @@ void xeKeKfReleaseSpinLock(uint32_t* lock, dword_t old_irql) {
   thread->LowerIrql(old_irql);
 
   // Unlock.
-  xe::atomic_dec(lock);
+  ReleaseSpinLock(lock);
 }
 
 void KfReleaseSpinLock(lpdword_t lock_ptr, dword_t old_irql) {
@@ -915,9 +1009,9 @@ DECLARE_XBOXKRNL_EXPORT2(KfReleaseSpinLock, kThreading, kImplemented,
 void KeAcquireSpinLockAtRaisedIrql(lpdword_t lock_ptr) {
   // Lock.
   auto lock = reinterpret_cast<uint32_t*>(lock_ptr.host_address());
-  while (!xe::atomic_cas(0, 1, lock)) {
-    // Spin!
+  if (!xe::atomic_cas(0, 1, lock)) {
     // TODO(benvanik): error on deadlock?
+    AcquireSpinLockContended(lock);
   }
 }
 DECLARE_XBOXKRNL_EXPORT3(KeAcquireSpinLockAtRaisedIrql, kThreading,
@@ -927,6 +1021,7 @@ dword_result_t KeTryToAcquireSpinLockAtRaisedIrql(lpdword_t lock_ptr) {
   // Lock.
   auto lock = reinterpret_cast<uint32_t*>(lock_ptr.host_address());
   if (!xe::atomic_cas(0, 1, lock)) {
+    RecordSpinLockContention(lock, 0);
     return 0;
   }
   return 1;
@@ -937,7 +1032,7 @@ DECLARE_XBOXKRNL_EXPORT4(KeTryToAcquireSpinLockAtRaisedIrql, kThreading,
 void KeReleaseSpinLockFromRaisedIrql(lpdword_t lock_ptr) {
   // Unlock.
   auto lock = reinterpret_cast<uint32_t*>(lock_ptr.host_address());
-  xe::atomic_dec(lock);
+  ReleaseSpinLock(lock);
 }
 DECLARE_XBOXKRNL_EXPORT2(KeReleaseSpinLockFromRaisedIrql, kThreading,
                          kImplemented, kHighFrequency);
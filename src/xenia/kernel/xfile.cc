@@ -92,6 +92,9 @@ X_STATUS XFile::QueryDirectory(X_FILE_DIRECTORY_INFORMATION* out_info,
 X_STATUS XFile::Read(uint32_t buffer_guest_address, uint32_t buffer_length,
                      uint64_t byte_offset, uint32_t* out_bytes_read,
                      uint32_t apc_context) {
+  // Requests with an offset to an asynchronous file complete on I/O workers
+  // in any order, so only the others move the file position.
+  bool update_position = is_synchronous_ || byte_offset == uint64_t(-1);
   if (byte_offset == uint64_t(-1)) {
     // Read from current position.
     byte_offset = position_;
@@ -151,7 +154,9 @@ X_STATUS XFile::Read(uint32_t buffer_guest_address, uint32_t buffer_length,
                   xe::global_critical_region::AcquireDirect(),
                   buffer_guest_address, buffer_length, true, true);
             }
-            position_ += bytes_read;
+            if (update_position) {
+              position_ = byte_offset + bytes_read;
+            }
           }
         }
       }
@@ -176,6 +181,8 @@ X_STATUS XFile::Read(uint32_t buffer_guest_address, uint32_t buffer_length,
 X_STATUS XFile::Write(uint32_t buffer_guest_address, uint32_t buffer_length,
                       uint64_t byte_offset, uint32_t* out_bytes_written,
                       uint32_t apc_context) {
+  // As in Read, asynchronous requests with an offset leave the position.
+  bool update_position = is_synchronous_ || byte_offset == uint64_t(-1);
   if (byte_offset == uint64_t(-1)) {
     // Write from current position.
     byte_offset = position_;
@@ -185,8 +192,8 @@ X_STATUS XFile::Write(uint32_t buffer_guest_address, uint32_t buffer_length,
   X_STATUS result =
       file_->WriteSync(memory()->TranslateVirtual(buffer_guest_address),
                        buffer_length, size_t(byte_offset), &bytes_written);
-  if (XSUCCEEDED(result)) {
-    position_ += bytes_written;
+  if (XSUCCEEDED(result) && update_position) {
+    position_ = byte_offset + bytes_written;
   }
 
   XIOCompletion::IONotification notify;
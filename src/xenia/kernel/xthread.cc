@@ -768,13 +768,15 @@ X_STATUS XThread::Resume(uint32_t* out_suspend_count) {
 }
 
 X_STATUS XThread::Suspend(uint32_t* out_suspend_count) {
-  auto global_lock = global_critical_region_.Acquire();
+  // A thread can't be suspended while it has interrupts disabled, so wait for
+  // any guest critical section to finish first.
+  auto suspend_lock = kernel_state()->processor()->AcquireSuspendLock();
 
   ++guest_object<X_KTHREAD>()->suspend_count;
 
-  // If we are suspending ourselves, we can't hold the lock.
+  // If we are suspending ourselves, we can't hold the locks.
   if (XThread::IsInThread() && XThread::GetCurrentThread() == this) {
-    global_lock.unlock();
+    suspend_lock.unlock();
   }
 
   if (thread_->Suspend(out_suspend_count)) {
@@ -10,7 +10,9 @@
 #include "xenia/memory.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <thread>
 #include <utility>
 
 #include "xenia/base/assert.h"
@@ -25,6 +27,9 @@
 // TODO(benvanik): move xbox.h out
 #include "xenia/xbox.h"
 
+#include "third_party/snappy/snappy.h"
+#include "third_party/xxhash/xxhash.h"
+
 DEFINE_bool(protect_zero, true, "Protect the zero page from reads and writes.",
             "Memory");
 DEFINE_bool(protect_on_release, false,
@@ -177,6 +182,9 @@ bool Memory::Initialize() {
   heaps_.vE0000000.Initialize(this, virtual_membase_, 0xE0000000, 0x1FD00000,
                               4096, &heaps_.physical);
 
+  system_heap_pool_.Initialize(LookupHeapByType(false, 4096));
+  physical_system_heap_pool_.Initialize(LookupHeapByType(true, 4096));
+
   // Protect the first and last 64kb of memory.
   heaps_.v00000000.AllocFixed(
       0x00000000, 0x10000, 0x10000,
@@ -307,6 +315,8 @@ void Memory::Reset() {
   heaps_.v80000000.Reset();
   heaps_.v90000000.Reset();
   heaps_.physical.Reset();
+  system_heap_pool_.Reset();
+  physical_system_heap_pool_.Reset();
 }
 
 const BaseHeap* Memory::LookupHeap(uint32_t address) const {
@@ -526,14 +536,17 @@ void Memory::EnablePhysicalMemoryAccessCallbacks(
 
 uint32_t Memory::SystemHeapAlloc(uint32_t size, uint32_t alignment,
                                  uint32_t system_heap_flags) {
-  // TODO(benvanik): lightweight pool.
   bool is_physical = !!(system_heap_flags & kSystemHeapPhysical);
-  auto heap = LookupHeapByType(is_physical, 4096);
-  uint32_t address;
-  if (!heap->Alloc(size, alignment,
-                   kMemoryAllocationReserve | kMemoryAllocationCommit,
-                   kMemoryProtectRead | kMemoryProtectWrite, false, &address)) {
-    return 0;
+  auto& pool = is_physical ? physical_system_heap_pool_ : system_heap_pool_;
+  uint32_t address = pool.Alloc(size, alignment);
+  if (!address) {
+    auto heap = LookupHeapByType(is_physical, 4096);
+    if (!heap->Alloc(size, alignment,
+                     kMemoryAllocationReserve | kMemoryAllocationCommit,
+                     kMemoryProtectRead | kMemoryProtectWrite, false,
+                     &address)) {
+      return 0;
+    }
   }
   Zero(address, size);
   return address;
@@ -543,9 +556,15 @@ void Memory::SystemHeapFree(uint32_t address) {
   if (!address) {
     return;
   }
-  // TODO(benvanik): lightweight pool.
   auto heap = LookupHeap(address);
-  heap->Release(address);
+  auto& pool = heap->IsGuestPhysicalHeap() ? physical_system_heap_pool_
+                                           : system_heap_pool_;
+  if (!pool.Contains(address)) {
+    heap->Release(address);
+  } else if (!pool.Free(address)) {
+    // Releasing it from the heap would take the whole slab with it.
+    XELOGE("SystemHeapFree(%.8X): not an allocated block", address);
+  }
 }
 
 void Memory::DumpMap() {
@@ -579,24 +598,30 @@ void Memory::DumpMap() {
   XELOGE("");
 }
 
-bool Memory::Save(ByteStream* stream) {
+bool Memory::Save(ByteStream* stream, bool incremental) {
   XELOGD("Serializing memory...");
-  heaps_.v00000000.Save(stream);
-  heaps_.v40000000.Save(stream);
-  heaps_.v80000000.Save(stream);
-  heaps_.v90000000.Save(stream);
-  heaps_.physical.Save(stream);
+  heaps_.v00000000.Save(stream, incremental);
+  heaps_.v40000000.Save(stream, incremental);
+  heaps_.v80000000.Save(stream, incremental);
+  heaps_.v90000000.Save(stream, incremental);
+  heaps_.physical.Save(stream, incremental);
+  system_heap_pool_.Save(stream);
+  physical_system_heap_pool_.Save(stream);
 
   return true;
 }
 
 bool Memory::Restore(ByteStream* stream) {
   XELOGD("Restoring memory...");
-  heaps_.v00000000.Restore(stream);
-  heaps_.v40000000.Restore(stream);
-  heaps_.v80000000.Restore(stream);
-  heaps_.v90000000.Restore(stream);
-  heaps_.physical.Restore(stream);
+  if (!heaps_.v00000000.Restore(stream) || !heaps_.v40000000.Restore(stream) ||
+      !heaps_.v80000000.Restore(stream) || !heaps_.v90000000.Restore(stream) ||
+      !heaps_.physical.Restore(stream)) {
+    return false;
+  }
+  if (!system_heap_pool_.Restore(stream) ||
+      !physical_system_heap_pool_.Restore(stream)) {
+    return false;
+  }
 
   return true;
 }
@@ -644,6 +669,7 @@ void BaseHeap::Initialize(Memory* memory, uint8_t* membase, uint32_t heap_base,
   page_size_ = page_size;
   host_address_offset_ = host_address_offset;
   page_table_.resize(heap_size / page_size);
+  free_pages_.Reset(heap_size / page_size);
 }
 
 void BaseHeap::Dispose() {
@@ -714,54 +740,137 @@ uint32_t BaseHeap::GetTotalPageCount() { return uint32_t(page_table_.size()); }
 
 uint32_t BaseHeap::GetUnreservedPageCount() {
   auto global_lock = global_critical_region_.Acquire();
-  uint32_t count = 0;
-  bool is_empty_span = false;
-  uint32_t empty_span_start = 0;
-  uint32_t size = uint32_t(page_table_.size());
-  for (uint32_t i = 0; i < size; ++i) {
-    auto& page = page_table_[i];
-    if (!page.state) {
-      if (!is_empty_span) {
-        is_empty_span = true;
-        empty_span_start = i;
-      }
-      continue;
-    }
-    if (is_empty_span) {
-      is_empty_span = false;
-      count += i - empty_span_start;
+  return free_pages_.free_page_count();
+}
+
+namespace {
+
+// Committed pages are saved in chunks of up to this many pages, each
+// compressed separately so that chunks can be processed in parallel.
+const uint32_t kSaveChunkPageCount = 64;
+
+struct SaveChunk {
+  std::vector<uint32_t> page_numbers;
+  // Pages that are all zeros and have no data in the chunk.
+  uint64_t zero_page_mask = 0;
+  const uint8_t* compressed_data = nullptr;
+  size_t compressed_size = 0;
+  std::vector<uint8_t> compressed_buffer;
+};
+
+// Calls fn for every index in [0, count) from one thread per logical
+// processor.
+template <typename F>
+void ParallelFor(size_t count, F fn) {
+  std::atomic<size_t> next_index(0);
+  auto worker = [&]() {
+    for (size_t i = next_index++; i < count; i = next_index++) {
+      fn(i);
     }
-    i += page.region_page_count - 1;
+  };
+  size_t thread_count =
+      std::min(size_t(xe::threading::logical_processor_count()), count);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i) {
+    threads.emplace_back(worker);
   }
-  if (is_empty_span) {
-    count += size - empty_span_start;
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
   }
-  return count;
 }
 
-bool BaseHeap::Save(ByteStream* stream) {
+bool IsZeroPage(const uint8_t* data, uint32_t size) {
+  auto words = reinterpret_cast<const uint64_t*>(data);
+  for (uint32_t i = 0; i < size / sizeof(uint64_t); ++i) {
+    if (words[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool BaseHeap::Save(ByteStream* stream, bool incremental) {
   XELOGD("Heap %.8X-%.8X", heap_base_, heap_base_ + (heap_size_ - 1));
 
+  std::vector<uint32_t> committed_page_numbers;
   for (size_t i = 0; i < page_table_.size(); i++) {
     auto& page = page_table_[i];
     stream->Write(page.qword);
-    if (!page.state) {
-      // Unallocated.
-      continue;
+    if (page.state & kMemoryAllocationCommit) {
+      committed_page_numbers.push_back(uint32_t(i));
     }
+  }
 
-    // TODO(DrChat): write compressed with snappy.
-    if (page.state & kMemoryAllocationCommit) {
-      void* addr = TranslateRelative(i * page_size_);
+  // Hashes of the pages as saved now, to compare against in later
+  // incremental saves. 0 for pages that aren't committed.
+  std::vector<uint64_t> page_hashes;
+  if (!incremental) {
+    page_hashes.resize(page_table_.size());
+  }
+  std::vector<SaveChunk> chunks(
+      (committed_page_numbers.size() + kSaveChunkPageCount - 1) /
+      kSaveChunkPageCount);
+  ParallelFor(chunks.size(), [&](size_t chunk_index) {
+    auto& chunk = chunks[chunk_index];
+    std::vector<uint8_t> data;
+    size_t first = chunk_index * kSaveChunkPageCount;
+    size_t last = std::min(first + kSaveChunkPageCount,
+                           committed_page_numbers.size());
+    for (size_t i = first; i < last; ++i) {
+      uint32_t page_number = committed_page_numbers[i];
+      auto addr = TranslateRelative<uint8_t*>(page_number * page_size_);
 
       memory::PageAccess old_access;
       memory::Protect(addr, page_size_, memory::PageAccess::kReadWrite,
                       &old_access);
 
-      stream->Write(addr, page_size_);
+      uint64_t hash = std::max(XXH64(addr, page_size_, 0), uint64_t(1));
+      if (!incremental) {
+        page_hashes[page_number] = hash;
+      }
+      if (!incremental || page_number >= saved_page_hashes_.size() ||
+          saved_page_hashes_[page_number] != hash) {
+        if (IsZeroPage(addr, page_size_)) {
+          chunk.zero_page_mask |= uint64_t(1) << chunk.page_numbers.size();
+        } else {
+          data.insert(data.end(), addr, addr + page_size_);
+        }
+        chunk.page_numbers.push_back(page_number);
+      }
 
       memory::Protect(addr, page_size_, old_access, nullptr);
     }
+
+    chunk.compressed_buffer.resize(snappy::MaxCompressedLength(data.size()));
+    snappy::RawCompress(reinterpret_cast<const char*>(data.data()),
+                        data.size(),
+                        reinterpret_cast<char*>(chunk.compressed_buffer.data()),
+                        &chunk.compressed_size);
+  });
+  if (!incremental) {
+    saved_page_hashes_ = std::move(page_hashes);
+  }
+
+  uint32_t chunk_count = 0;
+  for (auto& chunk : chunks) {
+    if (!chunk.page_numbers.empty()) {
+      ++chunk_count;
+    }
+  }
+  stream->Write(chunk_count);
+  for (auto& chunk : chunks) {
+    if (chunk.page_numbers.empty()) {
+      continue;
+    }
+    stream->Write(uint32_t(chunk.page_numbers.size()));
+    stream->Write(chunk.page_numbers.data(),
+                  chunk.page_numbers.size() * sizeof(uint32_t));
+    stream->Write(chunk.zero_page_mask);
+    stream->Write(uint32_t(chunk.compressed_size));
+    stream->Write(chunk.compressed_buffer.data(), chunk.compressed_size);
   }
 
   return true;
@@ -770,6 +879,7 @@ bool BaseHeap::Save(ByteStream* stream) {
 bool BaseHeap::Restore(ByteStream* stream) {
   XELOGD("Heap %.8X-%.8X", heap_base_, heap_base_ + (heap_size_ - 1));
 
+  free_pages_.Reset(uint32_t(page_table_.size()));
   for (size_t i = 0; i < page_table_.size(); i++) {
     auto& page = page_table_[i];
     page.qword = stream->Read<uint64_t>();
@@ -777,35 +887,90 @@ bool BaseHeap::Restore(ByteStream* stream) {
       // Unallocated.
       continue;
     }
+    free_pages_.MarkUsed(uint32_t(i), 1);
 
-    memory::PageAccess page_access = memory::PageAccess::kNoAccess;
-    if ((page.current_protect & kMemoryProtectRead) &&
-        (page.current_protect & kMemoryProtectWrite)) {
-      page_access = memory::PageAccess::kReadWrite;
-    } else if (page.current_protect & kMemoryProtectRead) {
-      page_access = memory::PageAccess::kReadOnly;
-    }
-
-    // Commit the memory if it isn't already. We do not need to reserve any
-    // memory, as the mapping has already taken care of that.
-    if (page.state & kMemoryAllocationCommit) {
-      xe::memory::AllocFixed(TranslateRelative(i * page_size_), page_size_,
-                             memory::AllocationType::kCommit,
-                             memory::PageAccess::kReadWrite);
-    }
-
-    // Now read into memory. We'll set R/W protection first, then set the
-    // protection back to its previous state.
-    // TODO(DrChat): read compressed with snappy.
+    // Commit the memory if it isn't already, writable until the pages are
+    // read. We do not need to reserve any memory, as the mapping has already
+    // taken care of that.
     if (page.state & kMemoryAllocationCommit) {
       void* addr = TranslateRelative(i * page_size_);
+      xe::memory::AllocFixed(addr, page_size_, memory::AllocationType::kCommit,
+                             memory::PageAccess::kReadWrite);
       xe::memory::Protect(addr, page_size_, memory::PageAccess::kReadWrite,
                           nullptr);
+    }
+  }
 
-      stream->Read(addr, page_size_);
+  // Pages missing from an incremental save keep what the base save restored.
+  std::vector<SaveChunk> chunks(stream->Read<uint32_t>());
+  for (auto& chunk : chunks) {
+    uint32_t page_count = stream->Read<uint32_t>();
+    if (page_count > kSaveChunkPageCount) {
+      XELOGE("Heap %.8X-%.8X has corrupt page data", heap_base_,
+             heap_base_ + (heap_size_ - 1));
+      return false;
+    }
+    chunk.page_numbers.resize(page_count);
+    stream->Read(chunk.page_numbers.data(),
+                 chunk.page_numbers.size() * sizeof(uint32_t));
+    for (uint32_t page_number : chunk.page_numbers) {
+      if (page_number >= page_table_.size()) {
+        XELOGE("Heap %.8X-%.8X has corrupt page data", heap_base_,
+               heap_base_ + (heap_size_ - 1));
+        return false;
+      }
+    }
+    chunk.zero_page_mask = stream->Read<uint64_t>();
+    chunk.compressed_size = stream->Read<uint32_t>();
+    chunk.compressed_data = stream->data() + stream->offset();
+    stream->Advance(chunk.compressed_size);
+  }
+  std::atomic<bool> any_failed(false);
+  ParallelFor(chunks.size(), [&](size_t chunk_index) {
+    auto& chunk = chunks[chunk_index];
+    std::vector<uint8_t> data(chunk.page_numbers.size() * page_size_);
+    size_t data_size;
+    if (!snappy::GetUncompressedLength(
+            reinterpret_cast<const char*>(chunk.compressed_data),
+            chunk.compressed_size, &data_size) ||
+        data_size > data.size() ||
+        !snappy::RawUncompress(
+            reinterpret_cast<const char*>(chunk.compressed_data),
+            chunk.compressed_size, reinterpret_cast<char*>(data.data()))) {
+      any_failed = true;
+      return;
+    }
+    const uint8_t* page_data = data.data();
+    for (size_t i = 0; i < chunk.page_numbers.size(); ++i) {
+      void* addr = TranslateRelative(chunk.page_numbers[i] * page_size_);
+      if (chunk.zero_page_mask & (uint64_t(1) << i)) {
+        std::memset(addr, 0, page_size_);
+      } else {
+        std::memcpy(addr, page_data, page_size_);
+        page_data += page_size_;
+      }
+    }
+  });
+  if (any_failed) {
+    XELOGE("Heap %.8X-%.8X has corrupt page data", heap_base_,
+           heap_base_ + (heap_size_ - 1));
+    return false;
+  }
 
-      xe::memory::Protect(addr, page_size_, page_access, nullptr);
+  for (size_t i = 0; i < page_table_.size(); i++) {
+    auto& page = page_table_[i];
+    if (!(page.state & kMemoryAllocationCommit)) {
+      continue;
     }
+    memory::PageAccess page_access = memory::PageAccess::kNoAccess;
+    if ((page.current_protect & kMemoryProtectRead) &&
+        (page.current_protect & kMemoryProtectWrite)) {
+      page_access = memory::PageAccess::kReadWrite;
+    } else if (page.current_protect & kMemoryProtectRead) {
+      page_access = memory::PageAccess::kReadOnly;
+    }
+    xe::memory::Protect(TranslateRelative(i * page_size_), page_size_,
+                        page_access, nullptr);
   }
 
   return true;
@@ -814,6 +979,7 @@ bool BaseHeap::Restore(ByteStream* stream) {
 void BaseHeap::Reset() {
   // TODO(DrChat): protect pages.
   std::memset(page_table_.data(), 0, sizeof(PageEntry) * page_table_.size());
+  free_pages_.Reset(uint32_t(page_table_.size()));
   // TODO(Triang3l): Remove access callbacks from pages if this is a physical
   // memory heap.
 }
@@ -904,6 +1070,7 @@ bool BaseHeap::AllocFixed(uint32_t base_address, uint32_t size,
     page_entry.current_protect = protect;
     page_entry.state = kMemoryAllocationReserve | allocation_type;
   }
+  free_pages_.MarkUsed(start_page_number, page_count);
 
   return true;
 }
@@ -932,85 +1099,27 @@ bool BaseHeap::AllocRange(uint32_t low_address, uint32_t high_address,
 
   auto global_lock = global_critical_region_.Acquire();
 
-  // Find a free page range.
-  // The base page must match the requested alignment, so we first scan for
-  // a free aligned page and only then check for continuous free pages.
-  // TODO(benvanik): optimized searching (free list buckets, bitmap, etc).
+  // Find a free page range whose base page matches the requested alignment.
+  // The bounds are the same as a linear scan in steps of the alignment would
+  // use, so allocations land where they always have.
   uint32_t start_page_number = UINT_MAX;
   uint32_t end_page_number = UINT_MAX;
   uint32_t page_scan_stride = alignment / page_size_;
   high_page_number = high_page_number - (high_page_number % page_scan_stride);
   if (top_down) {
-    for (int64_t base_page_number =
-             high_page_number - xe::round_up(page_count, page_scan_stride);
-         base_page_number >= low_page_number;
-         base_page_number -= page_scan_stride) {
-      if (page_table_[base_page_number].state != 0) {
-        // Base page not free, skip to next usable page.
-        continue;
-      }
-      // Check requested range to ensure free.
-      start_page_number = uint32_t(base_page_number);
-      end_page_number = uint32_t(base_page_number) + page_count - 1;
-      assert_true(end_page_number < page_table_.size());
-      bool any_taken = false;
-      for (uint32_t page_number = uint32_t(base_page_number);
-           !any_taken && page_number <= end_page_number; ++page_number) {
-        bool is_free = page_table_[page_number].state == 0;
-        if (!is_free) {
-          // At least one page in the range is used, skip to next.
-          // We know we'll be starting at least before this page.
-          any_taken = true;
-          if (page_count > page_number) {
-            // Not enough space left to fit entire page range. Breaks outer
-            // loop.
-            base_page_number = -1;
-          } else {
-            base_page_number = page_number - page_count;
-            base_page_number -= base_page_number % page_scan_stride;
-            base_page_number += page_scan_stride;  // cancel out loop logic
-          }
-          break;
-        }
-      }
-      if (!any_taken) {
-        // Found our place.
-        break;
-      }
-      // Retry.
-      start_page_number = end_page_number = UINT_MAX;
+    // The highest base page is a whole number of strides below the top.
+    uint32_t top_page_count = xe::round_up(page_count, page_scan_stride);
+    if (high_page_number >= top_page_count) {
+      start_page_number = free_pages_.FindLast(
+          low_page_number, high_page_number - top_page_count + page_count - 1,
+          page_count, page_scan_stride);
     }
   } else {
-    for (uint32_t base_page_number = low_page_number;
-         base_page_number <= high_page_number - page_count;
-         base_page_number += page_scan_stride) {
-      if (page_table_[base_page_number].state != 0) {
-        // Base page not free, skip to next usable page.
-        continue;
-      }
-      // Check requested range to ensure free.
-      start_page_number = base_page_number;
-      end_page_number = base_page_number + page_count - 1;
-      bool any_taken = false;
-      for (uint32_t page_number = base_page_number;
-           !any_taken && page_number <= end_page_number; ++page_number) {
-        bool is_free = page_table_[page_number].state == 0;
-        if (!is_free) {
-          // At least one page in the range is used, skip to next.
-          // We know we'll be starting at least after this page.
-          any_taken = true;
-          base_page_number = xe::round_up(page_number + 1, page_scan_stride);
-          base_page_number -= page_scan_stride;  // cancel out loop logic
-          break;
-        }
-      }
-      if (!any_taken) {
-        // Found our place.
-        break;
-      }
-      // Retry.
-      start_page_number = end_page_number = UINT_MAX;
-    }
+    start_page_number = free_pages_.FindFirst(
+        low_page_number, high_page_number - 1, page_count, page_scan_stride);
+  }
+  if (start_page_number != FreePageIndex::kNotFound) {
+    end_page_number = start_page_number + page_count - 1;
   }
   if (start_page_number == UINT_MAX || end_page_number == UINT_MAX) {
     // Out of memory.
@@ -1049,6 +1158,7 @@ bool BaseHeap::AllocRange(uint32_t low_address, uint32_t high_address,
     page_entry.current_protect = protect;
     page_entry.state = kMemoryAllocationReserve | allocation_type;
   }
+  free_pages_.MarkUsed(start_page_number, page_count);
 
   *out_address = heap_base_ + (start_page_number * page_size_);
   return true;
@@ -1139,6 +1249,7 @@ bool BaseHeap::Release(uint32_t base_address, uint32_t* out_region_size) {
     auto& page_entry = page_table_[page_number];
     page_entry.qword = 0;
   }
+  free_pages_.MarkFree(base_page_number, base_page_entry.region_page_count);
 
   return true;
 }
@@ -1822,4 +1933,157 @@ uint32_t PhysicalHeap::GetPhysicalAddress(uint32_t address) const {
   return address;
 }
 
+void SystemHeapPool::Initialize(BaseHeap* heap) { heap_ = heap; }
+
+uint32_t SystemHeapPool::Alloc(uint32_t size, uint32_t alignment) {
+  if (size > kMaxBlockSize || alignment > kMaxBlockSize ||
+      (alignment & (alignment - 1))) {
+    return 0;
+  }
+  // Blocks are aligned to their size within the slab.
+  uint32_t block_size = std::max(kMinBlockSize, alignment);
+  while (block_size < size) {
+    block_size <<= 1;
+  }
+  uint32_t block_size_index = xe::log2_floor(block_size / kMinBlockSize);
+
+  auto global_lock = global_critical_region_.Acquire();
+  auto& partial_slabs = partial_slabs_[block_size_index];
+  if (partial_slabs.empty()) {
+    uint32_t slab_address;
+    if (!heap_->Alloc(kSlabSize, kSlabSize,
+                      kMemoryAllocationReserve | kMemoryAllocationCommit,
+                      kMemoryProtectRead | kMemoryProtectWrite, false,
+                      &slab_address)) {
+      return 0;
+    }
+    auto& slab = slabs_[slab_address];
+    std::memset(&slab, 0, sizeof(slab));
+    slab.block_size = block_size;
+    partial_slabs.push_back(slab_address);
+  }
+
+  uint32_t slab_address = partial_slabs.back();
+  auto& slab = slabs_[slab_address];
+  uint32_t block_count = kSlabSize / block_size;
+  // Partial slabs have a free block, and the lowest clear bit is always one.
+  uint32_t block_index = 0;
+  for (uint32_t i = 0; i < kSlabBitmapSize; ++i) {
+    uint32_t bit_index;
+    if (xe::bit_scan_forward(~slab.allocated[i], &bit_index)) {
+      block_index = i * 64 + bit_index;
+      break;
+    }
+  }
+  assert_true(block_index < block_count);
+  slab.allocated[block_index >> 6] |= uint64_t(1) << (block_index & 63);
+  if (++slab.allocated_count == block_count) {
+    partial_slabs.pop_back();
+  }
+  return slab_address + block_index * block_size;
+}
+
+bool SystemHeapPool::Contains(uint32_t address) {
+  auto global_lock = global_critical_region_.Acquire();
+  return slabs_.count(address & ~(kSlabSize - 1)) != 0;
+}
+
+bool SystemHeapPool::Free(uint32_t address) {
+  auto global_lock = global_critical_region_.Acquire();
+  uint32_t slab_address = address & ~(kSlabSize - 1);
+  auto it = slabs_.find(slab_address);
+  if (it == slabs_.end()) {
+    return false;
+  }
+  auto& slab = it->second;
+  uint32_t offset = address - slab_address;
+  if (offset & (slab.block_size - 1)) {
+    return false;
+  }
+  uint32_t block_index = offset / slab.block_size;
+  uint64_t& allocated = slab.allocated[block_index >> 6];
+  uint64_t block_bit = uint64_t(1) << (block_index & 63);
+  if (!(allocated & block_bit)) {
+    return false;
+  }
+  allocated &= ~block_bit;
+
+  auto& partial_slabs =
+      partial_slabs_[xe::log2_floor(slab.block_size / kMinBlockSize)];
+  if (slab.allocated_count-- == kSlabSize / slab.block_size) {
+    partial_slabs.push_back(slab_address);
+  }
+  if (!slab.allocated_count && partial_slabs.size() > 1) {
+    // Keep the last one so a block allocated and freed over and over doesn't
+    // allocate and release a slab each time.
+    partial_slabs.erase(
+        std::find(partial_slabs.begin(), partial_slabs.end(), slab_address));
+    slabs_.erase(it);
+    heap_->Release(slab_address);
+  }
+  return true;
+}
+
+void SystemHeapPool::Reset() {
+  auto global_lock = global_critical_region_.Acquire();
+  slabs_.clear();
+  for (auto& partial_slabs : partial_slabs_) {
+    partial_slabs.clear();
+  }
+}
+
+bool SystemHeapPool::Save(ByteStream* stream) {
+  auto global_lock = global_critical_region_.Acquire();
+  stream->Write(uint32_t(slabs_.size()));
+  for (auto& slab : slabs_) {
+    stream->Write(slab.first);
+    stream->Write(slab.second.block_size);
+    stream->Write(slab.second.allocated, sizeof(slab.second.allocated));
+  }
+  return true;
+}
+
+bool SystemHeapPool::Restore(ByteStream* stream) {
+  auto global_lock = global_critical_region_.Acquire();
+  Reset();
+  uint32_t slab_count = stream->Read<uint32_t>();
+  for (uint32_t i = 0; i < slab_count; ++i) {
+    uint32_t slab_address = stream->Read<uint32_t>();
+    Slab slab;
+    slab.block_size = stream->Read<uint32_t>();
+    stream->Read(slab.allocated, sizeof(slab.allocated));
+    bool corrupt = (slab_address & (kSlabSize - 1)) ||
+                   slabs_.count(slab_address) ||
+                   slab.block_size < kMinBlockSize ||
+                   slab.block_size > kMaxBlockSize ||
+                   (slab.block_size & (slab.block_size - 1));
+    uint32_t block_count = corrupt ? 0 : kSlabSize / slab.block_size;
+    slab.allocated_count = 0;
+    for (uint32_t j = 0; j < kSlabBitmapSize && !corrupt; ++j) {
+      // Bits past the last block must be clear.
+      uint32_t first_block = j * 64;
+      if (first_block + 64 > block_count) {
+        uint64_t valid_mask =
+            first_block < block_count
+                ? (uint64_t(1) << (block_count - first_block)) - 1
+                : 0;
+        corrupt = (slab.allocated[j] & ~valid_mask) != 0;
+      }
+      slab.allocated_count += xe::bit_count(slab.allocated[j]);
+    }
+    if (corrupt) {
+      XELOGE("System heap pool has a corrupt slab at %.8X", slab_address);
+      // Nothing restored so far is usable.
+      Reset();
+      return false;
+    }
+    slabs_[slab_address] = slab;
+    if (slab.allocated_count < block_count) {
+      partial_slabs_[xe::log2_floor(slab.block_size / kMinBlockSize)]
+          .push_back(slab_address);
+    }
+  }
+  return true;
+}
+
 }  // namespace xe
@@ -14,9 +14,11 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "xenia/base/free_page_index.h"
 #include "xenia/base/memory.h"
 #include "xenia/base/mutex.h"
 #include "xenia/cpu/mmio_handler.h"
@@ -180,7 +182,10 @@ class BaseHeap {
   // Whether the heap is a guest virtual memory mapping of the physical memory.
   virtual bool IsGuestPhysicalHeap() const { return false; }
 
-  bool Save(ByteStream* stream);
+  // Compresses committed pages and leaves out all-zero ones. An incremental
+  // save writes only the pages that changed since the last full save, and is
+  // restored over what that one restored.
+  bool Save(ByteStream* stream, bool incremental = false);
   bool Restore(ByteStream* stream);
 
   void Reset();
@@ -200,6 +205,10 @@ class BaseHeap {
   uint32_t host_address_offset_;
   xe::global_critical_region global_critical_region_;
   std::vector<PageEntry> page_table_;
+  // Pages with no state in page_table_, for AllocRange to search.
+  FreePageIndex free_pages_;
+  // Hashes of the committed pages in the last full save, 0 for others.
+  std::vector<uint64_t> saved_page_hashes_;
 };
 
 // Normal heap allowing allocations from guest virtual address ranges.
@@ -272,6 +281,55 @@ class PhysicalHeap : public BaseHeap {
   std::vector<SystemPageFlagsBlock> system_page_flags_;
 };
 
+// Pool for small system heap allocations, so that kernel objects don't each
+// take a whole page from the heap.
+//
+// Allocations are rounded up to a power of two block size and carved out of
+// 64 KB slabs of blocks of that size. Each slab has a bitmap of its allocated
+// blocks, so freeing a block twice is caught rather than handing it out twice.
+// A slab goes back to the heap once all of its blocks are free, unless it's
+// the only one of its size with room left.
+class SystemHeapPool {
+ public:
+  static const uint32_t kSlabSize = 64 * 1024;
+  static const uint32_t kMinBlockSize = 32;
+  static const uint32_t kMaxBlockSize = 2048;
+
+  void Initialize(BaseHeap* heap);
+
+  // Returns 0 if the allocation is too large or too aligned for the pool, or
+  // if no slab could be allocated.
+  uint32_t Alloc(uint32_t size, uint32_t alignment);
+  // Whether the address is in one of the pool's slabs.
+  bool Contains(uint32_t address);
+  // Returns false if the address is not an allocated block of the pool,
+  // including one that has already been freed.
+  bool Free(uint32_t address);
+
+  // Forgets all slabs. The heap must be reset as well.
+  void Reset();
+
+  bool Save(ByteStream* stream);
+  bool Restore(ByteStream* stream);
+
+ private:
+  static const uint32_t kBlockSizeCount = 7;
+  static const uint32_t kSlabBitmapSize = kSlabSize / kMinBlockSize / 64;
+
+  struct Slab {
+    uint32_t block_size;
+    uint32_t allocated_count;
+    uint64_t allocated[kSlabBitmapSize];
+  };
+
+  BaseHeap* heap_ = nullptr;
+  xe::global_critical_region global_critical_region_;
+  // By base address.
+  std::unordered_map<uint32_t, Slab> slabs_;
+  // Slabs with free blocks for each block size, from kMinBlockSize up.
+  std::vector<uint32_t> partial_slabs_[kBlockSizeCount];
+};
+
 // Models the entire guest memory system on the console.
 // This exposes interfaces to both virtual and physical memory and a TLB and
 // page table for allocation, mapping, and protection.
@@ -468,7 +526,8 @@ class Memory {
   // Dumps a map of all allocated memory to the log.
   void DumpMap();
 
-  bool Save(ByteStream* stream);
+  // See BaseHeap::Save for incremental saves.
+  bool Save(ByteStream* stream, bool incremental = false);
   bool Restore(ByteStream* stream);
 
  private:
@@ -522,6 +581,10 @@ class Memory {
     PhysicalHeap vE0000000;
   } heaps_;
 
+  // Small system heap allocations, from the virtual and physical heaps.
+  SystemHeapPool system_heap_pool_;
+  SystemHeapPool physical_system_heap_pool_;
+
   friend class BaseHeap;
 
   friend class PhysicalHeap;
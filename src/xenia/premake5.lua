@@ -7,7 +7,9 @@ project("xenia-core")
   kind("StaticLib")
   language("C++")
   links({
+    "snappy",
     "xenia-base",
+    "xxhash",
   })
   defines({
   })
@@ -38,9 +38,15 @@ class Device {
   virtual uint32_t sectors_per_allocation_unit() const = 0;
   virtual uint32_t bytes_per_sector() const = 0;
 
+  // Changes whenever an entry is created or deleted, so cached path lookups
+  // can tell they're stale.
+  uint32_t tree_generation() const { return tree_generation_; }
+  void MarkTreeChanged() { ++tree_generation_; }
+
  protected:
   xe::global_critical_region global_critical_region_;
   std::string mount_path_;
+  uint32_t tree_generation_ = 0;
 };
 
 }  // namespace vfs
@@ -9,6 +9,9 @@
 
 #include "xenia/vfs/devices/disc_image_device.h"
 
+#include <algorithm>
+#include <cctype>
+
 #include "xenia/base/logging.h"
 #include "xenia/base/math.h"
 #include "xenia/vfs/devices/disc_image_entry.h"
@@ -18,6 +21,22 @@ namespace vfs {
 
 const size_t kXESectorSize = 2048;
 
+namespace {
+// Key for path_index_, so lookups match GetChild's case insensitivity.
+std::string MakeIndexKey(const std::string& path) {
+  std::string key;
+  for (auto& part : xe::split_path(path)) {
+    if (!key.empty()) {
+      key += '\\';
+    }
+    for (char c : part) {
+      key += char(std::tolower(static_cast<unsigned char>(c)));
+    }
+  }
+  return key;
+}
+}  // namespace
+
 DiscImageDevice::DiscImageDevice(const std::string& mount_path,
                                  const std::wstring& local_path)
     : Device(mount_path), local_path_(local_path) {}
@@ -40,11 +59,15 @@ bool DiscImageDevice::Initialize() {
     return false;
   }
 
-  result = ReadAllEntries(&state, state.ptr + state.root_offset);
-  if (result != Error::kSuccess) {
-    XELOGE("Failed to read all GDFX entries: %d", result);
-    return false;
-  }
+  // Only the root is created here; directories are read as they're used.
+  game_offset_ = state.game_offset;
+  auto root_entry = new DiscImageEntry(this, nullptr, "", mmap_.get());
+  root_entry->attributes_ = kFileAttributeDirectory;
+  root_entry->children_offset_ = state.root_offset;
+  root_entry->children_size_ = state.root_size;
+  root_entry_ = std::unique_ptr<Entry>(root_entry);
+  path_index_.clear();
+  path_index_.emplace("", root_entry);
 
   return true;
 }
@@ -61,15 +84,34 @@ Entry* DiscImageDevice::ResolvePath(const std::string& path) {
 
   XELOGFS("DiscImageDevice::ResolvePath(%s)", path.c_str());
 
-  // Walk the path, one separator at a time.
-  auto entry = root_entry_.get();
-  auto path_parts = xe::split_path(path);
-  for (auto& part : path_parts) {
-    entry = entry->GetChild(part);
-    if (!entry) {
-      // Not found.
-      return nullptr;
+  auto global_lock = global_critical_region_.Acquire();
+  auto key = MakeIndexKey(path);
+  auto it = path_index_.find(key);
+  if (it != path_index_.end()) {
+    return it->second;
+  }
+
+  // Not read yet. Walk the path one separator at a time, listing directories
+  // along the way, which adds their children to the index.
+  Entry* entry = root_entry_.get();
+  std::string prefix;
+  for (size_t offset = 0; offset <= key.size();) {
+    size_t end = std::min(key.find('\\', offset), key.size());
+    prefix = key.substr(0, end);
+    it = path_index_.find(prefix);
+    if (it == path_index_.end()) {
+      if (!(entry->attributes() & kFileAttributeDirectory)) {
+        return nullptr;
+      }
+      static_cast<DiscImageEntry*>(entry)->LoadChildren();
+      it = path_index_.find(prefix);
+      if (it == path_index_.end()) {
+        // Not found.
+        return nullptr;
+      }
     }
+    entry = it->second;
+    offset = end + 1;
   }
 
   return entry;
@@ -118,23 +160,26 @@ bool DiscImageDevice::VerifyMagic(ParseState* state, size_t offset) {
   return std::memcmp(state->ptr + offset, "MICROSOFT*XBOX*MEDIA", 20) == 0;
 }
 
-DiscImageDevice::Error DiscImageDevice::ReadAllEntries(
-    ParseState* state, const uint8_t* root_buffer) {
-  auto root_entry = new DiscImageEntry(this, nullptr, "", mmap_.get());
-  root_entry->attributes_ = kFileAttributeDirectory;
-  root_entry_ = std::unique_ptr<Entry>(root_entry);
-
-  if (!ReadEntry(state, root_buffer, 0, root_entry)) {
-    return Error::kErrorOutOfMemory;
+void DiscImageDevice::ReadChildren(DiscImageEntry* parent) {
+  auto global_lock = global_critical_region_.Acquire();
+  if (parent->children_offset_ + parent->children_size_ > mmap_->size()) {
+    XELOGE("GDFX directory %s is out of bounds", parent->path().c_str());
+    return;
+  }
+  if (!ReadEntry(mmap_->data() + parent->children_offset_,
+                 parent->children_size_, 0, parent)) {
+    XELOGE("Failed to read GDFX directory %s", parent->path().c_str());
   }
-
-  return Error::kSuccess;
 }
 
-bool DiscImageDevice::ReadEntry(ParseState* state, const uint8_t* buffer,
+bool DiscImageDevice::ReadEntry(const uint8_t* buffer, size_t buffer_size,
                                 uint16_t entry_ordinal,
                                 DiscImageEntry* parent) {
-  const uint8_t* p = buffer + (entry_ordinal * 4);
+  size_t entry_offset = size_t(entry_ordinal) * 4;
+  if (entry_offset + 14 > buffer_size) {
+    return false;
+  }
+  const uint8_t* p = buffer + entry_offset;
 
   uint16_t node_l = xe::load<uint16_t>(p + 0);
   uint16_t node_r = xe::load<uint16_t>(p + 2);
@@ -143,8 +188,11 @@ bool DiscImageDevice::ReadEntry(ParseState* state, const uint8_t* buffer,
   uint8_t attributes = xe::load<uint8_t>(p + 12);
   uint8_t name_length = xe::load<uint8_t>(p + 13);
   auto name = reinterpret_cast<const char*>(p + 14);
+  if (entry_offset + 14 + name_length > buffer_size) {
+    return false;
+  }
 
-  if (node_l && !ReadEntry(state, buffer, node_l, parent)) {
+  if (node_l && !ReadEntry(buffer, buffer_size, node_l, parent)) {
     return false;
   }
 
@@ -164,29 +212,26 @@ bool DiscImageDevice::ReadEntry(ParseState* state, const uint8_t* buffer,
     entry->data_offset_ = 0;
     entry->data_size_ = 0;
     if (length) {
-      // Not a leaf - read in children.
-      if (state->size < state->game_offset + (sector * kXESectorSize)) {
+      // Not a leaf - children are read when first needed.
+      if (mmap_->size() < game_offset_ + (sector * kXESectorSize)) {
         // Out of bounds read.
         return false;
       }
-      // Read child list.
-      uint8_t* folder_ptr =
-          state->ptr + state->game_offset + (sector * kXESectorSize);
-      if (!ReadEntry(state, folder_ptr, 0, entry.get())) {
-        return false;
-      }
+      entry->children_offset_ = game_offset_ + (sector * kXESectorSize);
+      entry->children_size_ = length;
     }
   } else {
     // File.
-    entry->data_offset_ = state->game_offset + (sector * kXESectorSize);
+    entry->data_offset_ = game_offset_ + (sector * kXESectorSize);
     entry->data_size_ = length;
   }
 
   // Add to parent.
+  path_index_.emplace(MakeIndexKey(entry->path()), entry.get());
   parent->children_.emplace_back(std::move(entry));
 
   // Read next file in the list.
-  if (node_r && !ReadEntry(state, buffer, node_r, parent)) {
+  if (node_r && !ReadEntry(buffer, buffer_size, node_r, parent)) {
     return false;
   }
 
@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 #include "xenia/base/mapped_memory.h"
 #include "xenia/vfs/device.h"
@@ -40,6 +41,8 @@ class DiscImageDevice : public Device {
   uint32_t bytes_per_sector() const override { return 2 * 1024; }
 
  private:
+  friend class DiscImageEntry;
+
   enum class Error {
     kSuccess = 0,
     kErrorOutOfMemory = -1,
@@ -51,6 +54,10 @@ class DiscImageDevice : public Device {
   std::wstring local_path_;
   std::unique_ptr<Entry> root_entry_;
   std::unique_ptr<MappedMemory> mmap_;
+  size_t game_offset_ = 0;
+  // Every entry read so far, by lowercase path with \ separators. Entries are
+  // only created when their parent directory is first listed.
+  std::unordered_map<std::string, Entry*> path_index_;
 
   typedef struct {
     uint8_t* ptr;
@@ -63,8 +70,9 @@ class DiscImageDevice : public Device {
 
   Error Verify(ParseState* state);
   bool VerifyMagic(ParseState* state, size_t offset);
-  Error ReadAllEntries(ParseState* state, const uint8_t* root_buffer);
-  bool ReadEntry(ParseState* state, const uint8_t* buffer,
+  // Creates the entries of one directory, leaving their own children unread.
+  void ReadChildren(DiscImageEntry* parent);
+  bool ReadEntry(const uint8_t* buffer, size_t buffer_size,
                  uint16_t entry_ordinal, DiscImageEntry* parent);
 };
 
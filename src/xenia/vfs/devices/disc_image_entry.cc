@@ -12,6 +12,7 @@
 #include <algorithm>
 
 #include "xenia/base/math.h"
+#include "xenia/vfs/devices/disc_image_device.h"
 #include "xenia/vfs/devices/disc_image_file.h"
 
 namespace xe {
@@ -22,7 +23,10 @@ DiscImageEntry::DiscImageEntry(Device* device, Entry* parent, std::string path,
     : Entry(device, parent, path),
       mmap_(mmap),
       data_offset_(0),
-      data_size_(0) {}
+      data_size_(0),
+      children_offset_(0),
+      children_size_(0),
+      children_loaded_(false) {}
 
 DiscImageEntry::~DiscImageEntry() = default;
 
@@ -41,6 +45,17 @@ X_STATUS DiscImageEntry::Open(uint32_t desired_access, File** out_file) {
   return X_STATUS_SUCCESS;
 }
 
+void DiscImageEntry::LoadChildren() {
+  auto global_lock = global_critical_region_.Acquire();
+  if (children_loaded_) {
+    return;
+  }
+  children_loaded_ = true;
+  if (children_size_) {
+    static_cast<DiscImageDevice*>(device_)->ReadChildren(this);
+  }
+}
+
 std::unique_ptr<MappedMemory> DiscImageEntry::OpenMapped(
     MappedMemory::Mode mode, size_t offset, size_t length) {
   if (mode != MappedMemory::Mode::kRead) {
@@ -43,12 +43,20 @@ class DiscImageEntry : public Entry {
                                            size_t offset,
                                            size_t length) override;
 
+ protected:
+  void LoadChildren() override;
+
  private:
   friend class DiscImageDevice;
 
   MappedMemory* mmap_;
   size_t data_offset_;
   size_t data_size_;
+  // Directories: where the GDFX tree of their children is in the image. It's
+  // only parsed once something looks at them.
+  size_t children_offset_;
+  size_t children_size_;
+  bool children_loaded_;
 };
 
 }  // namespace vfs
@@ -11,11 +11,15 @@
 
 #include <algorithm>
 
+#include "xenia/base/memory.h"
 #include "xenia/vfs/devices/disc_image_entry.h"
 
 namespace xe {
 namespace vfs {
 
+// Reads at least this large are copied with non-temporal stores.
+const size_t kStreamingCopyThreshold = 256 * 1024;
+
 DiscImageFile::DiscImageFile(uint32_t file_access, DiscImageEntry* entry)
     : File(file_access, entry), entry_(entry) {}
 
@@ -31,7 +35,13 @@ X_STATUS DiscImageFile::ReadSync(void* buffer, size_t buffer_length,
   size_t real_offset = entry_->data_offset() + byte_offset;
   size_t real_length =
       std::min(buffer_length, entry_->data_size() - byte_offset);
-  std::memcpy(buffer, entry_->mmap()->data() + real_offset, real_length);
+  auto src = entry_->mmap()->data() + real_offset;
+  if (real_length >= kStreamingCopyThreshold) {
+    // Bulk asset loads; keep them from flushing the cache.
+    xe::copy_streaming(buffer, src, real_length);
+  } else {
+    std::memcpy(buffer, src, real_length);
+  }
   *out_bytes_read = real_length;
   return X_STATUS_SUCCESS;
 }
@@ -393,8 +393,6 @@ StfsContainerDevice::Error StfsContainerDevice::ReadEntrySVOD(
       uint32_t block_index = data_block;
       size_t remaining_size = xe::round_up(length, 0x800);
 
-      size_t last_record = -1;
-      size_t last_offset = -1;
       while (remaining_size) {
         const size_t BLOCK_SIZE = 0x800;
 
@@ -404,16 +402,8 @@ StfsContainerDevice::Error StfsContainerDevice::ReadEntrySVOD(
         block_index++;
         remaining_size -= BLOCK_SIZE;
 
-        if (offset - last_offset == 0x800) {
-          // Consecutive, so append to last entry.
-          entry->block_list_[last_record].length += BLOCK_SIZE;
-          last_offset = offset;
-          continue;
-        }
-
-        entry->block_list_.push_back({file_index, offset, BLOCK_SIZE});
-        last_record = entry->block_list_.size() - 1;
-        last_offset = offset;
+        // Consecutive blocks are appended to the last record.
+        entry->AppendBlock(file_index, offset, BLOCK_SIZE);
       }
     }
   }
@@ -555,7 +545,8 @@ StfsContainerDevice::Error StfsContainerDevice::ReadSTFS() {
 
       all_entries.push_back(entry.get());
 
-      // Fill in all block records.
+      // Fill in all block records, merging blocks that are next to each
+      // other in the package so reads can copy them at once.
       // It's easier to do this now and just look them up later, at the cost
       // of some memory. Nasty chain walk.
       // TODO(benvanik): optimize if flag 0x40 (consecutive) is set.
@@ -567,7 +558,7 @@ StfsContainerDevice::Error StfsContainerDevice::ReadSTFS() {
           size_t block_size =
               std::min(static_cast<size_t>(0x1000), remaining_size);
           size_t offset = BlockToOffsetSTFS(block_index);
-          entry->block_list_.push_back({0, offset, block_size});
+          entry->AppendBlock(0, offset, block_size);
           remaining_size -= block_size;
           auto block_hash = GetBlockHash(data, block_index, 0);
           if (table_size_shift_ && block_hash.info < 0x80) {
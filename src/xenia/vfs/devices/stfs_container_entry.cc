@@ -11,6 +11,7 @@
 #include "xenia/base/math.h"
 #include "xenia/vfs/devices/stfs_container_file.h"
 
+#include <algorithm>
 #include <map>
 
 namespace xe {
@@ -34,6 +35,29 @@ std::unique_ptr<StfsContainerEntry> StfsContainerEntry::Create(
   return std::move(entry);
 }
 
+void StfsContainerEntry::AppendBlock(size_t file, size_t offset,
+                                     size_t length) {
+  if (!block_list_.empty()) {
+    auto& last = block_list_.back();
+    if (last.file == file && last.offset + last.length == offset) {
+      last.length += length;
+      return;
+    }
+  }
+  size_t data_offset = 0;
+  if (!block_list_.empty()) {
+    data_offset = block_offsets_.back() + block_list_.back().length;
+  }
+  block_offsets_.push_back(data_offset);
+  block_list_.push_back({file, offset, length});
+}
+
+size_t StfsContainerEntry::FindBlockRecord(size_t byte_offset) const {
+  auto it = std::upper_bound(block_offsets_.begin(), block_offsets_.end(),
+                             byte_offset);
+  return it == block_offsets_.begin() ? 0 : (it - block_offsets_.begin()) - 1;
+}
+
 X_STATUS StfsContainerEntry::Open(uint32_t desired_access, File** out_file) {
   *out_file = new StfsContainerFile(desired_access, this);
   return X_STATUS_SUCCESS;
@@ -43,21 +43,32 @@ class StfsContainerEntry : public Entry {
 
   X_STATUS Open(uint32_t desired_access, File** out_file) override;
 
+  // Physically contiguous extents of the entry data, in order.
   struct BlockRecord {
     size_t file;
     size_t offset;
     size_t length;
   };
   const std::vector<BlockRecord>& block_list() const { return block_list_; }
+  // Offset in the entry data where each record starts.
+  const std::vector<size_t>& block_offsets() const { return block_offsets_; }
+
+  // Index of the record holding the given byte of the entry data.
+  size_t FindBlockRecord(size_t byte_offset) const;
 
  private:
   friend class StfsContainerDevice;
 
+  // Appends data to the block list, extending the last record if it directly
+  // follows it in the same file.
+  void AppendBlock(size_t file, size_t offset, size_t length);
+
   MultifileMemoryMap* mmap_;
   size_t data_offset_;
   size_t data_size_;
   size_t block_;
   std::vector<BlockRecord> block_list_;
+  std::vector<size_t> block_offsets_;
 };
 
 }  // namespace vfs
@@ -13,6 +13,7 @@
 #include <cmath>
 
 #include "xenia/base/math.h"
+#include "xenia/base/memory.h"
 #include "xenia/vfs/devices/stfs_container_entry.h"
 
 namespace xe {
@@ -33,24 +34,28 @@ X_STATUS StfsContainerFile::ReadSync(void* buffer, size_t buffer_length,
     return X_STATUS_END_OF_FILE;
   }
 
-  size_t src_offset = 0;
   uint8_t* p = reinterpret_cast<uint8_t*>(buffer);
-  size_t remaining_length =
-      std::min(buffer_length, entry_->size() - byte_offset);
-  *out_bytes_read = remaining_length;
-
-  for (size_t i = 0; i < entry_->block_list().size(); i++) {
-    auto& record = entry_->block_list()[i];
-    if (src_offset + record.length <= byte_offset) {
-      // Doesn't begin in this region. Skip it.
-      src_offset += record.length;
-      continue;
-    }
+  size_t length = std::min(buffer_length, entry_->size() - byte_offset);
+  size_t remaining_length = length;
 
+  // Records are whole extents, so this is one copy unless the read crosses
+  // a gap in the package.
+  auto& block_list = entry_->block_list();
+  size_t i = entry_->FindBlockRecord(byte_offset);
+  if (i >= block_list.size()) {
+    // A malformed package can give an entry a size but too few blocks.
+    return X_STATUS_FILE_CORRUPT_ERROR;
+  }
+  size_t src_offset = entry_->block_offsets()[i];
+  for (; i < block_list.size(); i++) {
+    auto& record = block_list[i];
     uint8_t* src = entry_->mmap()->at(record.file)->data();
 
     size_t read_offset =
         (byte_offset > src_offset) ? byte_offset - src_offset : 0;
+    if (read_offset >= record.length) {
+      break;
+    }
     size_t read_length =
         std::min(record.length - read_offset, remaining_length);
     std::memcpy(p, src + record.offset + read_offset, read_length);
@@ -62,9 +67,41 @@ X_STATUS StfsContainerFile::ReadSync(void* buffer, size_t buffer_length,
       break;
     }
   }
+  if (remaining_length) {
+    // The blocks ran out before the entry's size.
+    return X_STATUS_FILE_CORRUPT_ERROR;
+  }
+  *out_bytes_read = length;
+
+  // The read ended inside record i, so it's in range.
+  size_t end_offset = byte_offset + length;
+  if (sequential_offset_.exchange(end_offset) == byte_offset) {
+    ReadAhead(i, end_offset);
+  }
 
   return X_STATUS_SUCCESS;
 }
 
+void StfsContainerFile::ReadAhead(size_t record_index, size_t byte_offset) {
+  const size_t kReadAheadSize = 1024 * 1024;
+  auto& block_list = entry_->block_list();
+  size_t end_offset = std::min(byte_offset + kReadAheadSize, entry_->size());
+  for (size_t i = record_index;
+       i < block_list.size() && byte_offset < end_offset; i++) {
+    auto& record = block_list[i];
+    size_t record_offset = entry_->block_offsets()[i];
+    if (record_offset + record.length <= byte_offset) {
+      continue;
+    }
+    size_t read_offset = byte_offset - record_offset;
+    size_t length =
+        std::min(record.length - read_offset, end_offset - byte_offset);
+    xe::memory::Prefetch(
+        entry_->mmap()->at(record.file)->data() + record.offset + read_offset,
+        length);
+    byte_offset += length;
+  }
+}
+
 }  // namespace vfs
 }  // namespace xe
\ No newline at end of file
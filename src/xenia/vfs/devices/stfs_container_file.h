@@ -10,6 +10,8 @@
 #ifndef XENIA_VFS_DEVICES_STFS_CONTAINER_FILE_H_
 #define XENIA_VFS_DEVICES_STFS_CONTAINER_FILE_H_
 
+#include <atomic>
+
 #include "xenia/vfs/file.h"
 
 #include "xenia/xbox.h"
@@ -35,7 +37,12 @@ class StfsContainerFile : public File {
   X_STATUS SetLength(size_t length) override { return X_STATUS_ACCESS_DENIED; }
 
  private:
+  // Hints the OS to page in the data after a sequential read.
+  void ReadAhead(size_t record_index, size_t byte_offset);
+
   StfsContainerEntry* entry_;
+  // Where the last read ended, to detect sequential reads.
+  std::atomic<size_t> sequential_offset_ = {0};
 };
 
 }  // namespace vfs
@@ -39,6 +39,7 @@ void Entry::Dump(xe::StringBuffer* string_buffer, int indent) {
   }
   string_buffer->Append(name());
   string_buffer->Append('\n');
+  LoadChildren();
   for (auto& child : children_) {
     child->Dump(string_buffer, indent + 2);
   }
@@ -48,6 +49,7 @@ bool Entry::is_read_only() const { return device_->is_read_only(); }
 
 Entry* Entry::GetChild(std::string name) {
   auto global_lock = global_critical_region_.Acquire();
+  LoadChildren();
   // TODO(benvanik): a faster search
   for (auto& child : children_) {
     if (strcasecmp(child->name().c_str(), name.c_str()) == 0) {
@@ -60,6 +62,7 @@ Entry* Entry::GetChild(std::string name) {
 Entry* Entry::IterateChildren(const xe::filesystem::WildcardEngine& engine,
                               size_t* current_index) {
   auto global_lock = global_critical_region_.Acquire();
+  LoadChildren();
   while (*current_index < children_.size()) {
     auto& child = children_[*current_index];
     *current_index = *current_index + 1;
@@ -85,6 +88,7 @@ Entry* Entry::CreateEntry(std::string name, uint32_t attributes) {
   }
   children_.push_back(std::move(entry));
   // TODO(benvanik): resort? would break iteration?
+  device_->MarkTreeChanged();
   Touch();
   return children_.back().get();
 }
@@ -106,6 +110,7 @@ bool Entry::Delete(Entry* entry) {
       break;
     }
   }
+  device_->MarkTreeChanged();
   Touch();
   return true;
 }
@@ -98,10 +98,14 @@ class Entry {
 
   Entry* GetChild(std::string name);
 
-  const std::vector<std::unique_ptr<Entry>>& children() const {
+  const std::vector<std::unique_ptr<Entry>>& children() {
+    LoadChildren();
     return children_;
   }
-  size_t child_count() const { return children_.size(); }
+  size_t child_count() {
+    LoadChildren();
+    return children_.size();
+  }
   Entry* IterateChildren(const xe::filesystem::WildcardEngine& engine,
                          size_t* current_index);
 
@@ -130,6 +134,8 @@ class Entry {
     return nullptr;
   }
   virtual bool DeleteEntryInternal(Entry* entry) { return false; }
+  // Called before children_ is used, for devices that read them on demand.
+  virtual void LoadChildren() {}
 
   xe::global_critical_region global_critical_region_;
   Device* device_;
@@ -12,7 +12,7 @@ project("xenia-vfs")
   defines({
   })
   recursive_platform_files()
-  removefiles({"vfs_dump.cc"})
+  removefiles({"vfs_dump.cc", "vfs_bench.cc"})
 
 project("xenia-vfs-dump")
   uuid("2EF270C7-41A8-4D0E-ACC5-59693A9CCE32")
@@ -32,3 +32,20 @@ project("xenia-vfs-dump")
     project_root,
   })
 
+project("xenia-vfs-bench")
+  uuid("6b1c3e52-9d4a-4f0e-8a37-2c5d1e7f9b08")
+  kind("ConsoleApp")
+  language("C++")
+  links({
+    "xenia-base",
+    "xenia-vfs",
+  })
+  defines({})
+
+  files({
+    "vfs_bench.cc",
+    project_root.."/src/xenia/base/main_"..platform_suffix..".cc",
+  })
+  resincludedirs({
+    project_root,
+  })
@@ -0,0 +1,147 @@
+/**
+ ******************************************************************************
+ * Xenia : Xbox 360 Emulator Research Project                                 *
+ ******************************************************************************
+ * Copyright 2019 Ben Vanik. All rights reserved.                             *
+ * Released under the BSD license - see LICENSE in the root for more details. *
+ ******************************************************************************
+ */
+
+#include <algorithm>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "xenia/base/clock.h"
+#include "xenia/base/filesystem.h"
+#include "xenia/base/logging.h"
+#include "xenia/base/main.h"
+#include "xenia/base/string.h"
+
+#include "xenia/vfs/devices/disc_image_device.h"
+#include "xenia/vfs/devices/host_path_device.h"
+#include "xenia/vfs/devices/stfs_container_device.h"
+#include "xenia/vfs/file.h"
+
+namespace xe {
+namespace vfs {
+
+DEFINE_transient_string(source, "",
+                        "Specifies the folder, .iso or package to read.",
+                        "General");
+
+DEFINE_int32(bench_read_size, 64 * 1024,
+             "Size in bytes of each sequential read.", "General");
+
+DEFINE_int32(bench_random_reads, 1000,
+             "Number of 4KB reads at random offsets to make in each file.",
+             "General");
+
+struct BenchStats {
+  uint64_t bytes = 0;
+  uint64_t reads = 0;
+  uint64_t ticks = 0;
+
+  void Log(const char* name) const {
+    double seconds = double(ticks) / Clock::host_tick_frequency_platform();
+    if (seconds <= 0.0) {
+      seconds = 1e-9;
+    }
+    XELOGI("%s: %llu reads, %.1f MB in %.3fs: %.1f MB/s, %.0f reads/s", name,
+           static_cast<unsigned long long>(reads), bytes / (1024.0 * 1024.0),
+           seconds, bytes / (1024.0 * 1024.0) / seconds, reads / seconds);
+  }
+};
+
+std::unique_ptr<vfs::Device> CreateDevice(const std::wstring& path) {
+  if (xe::filesystem::IsFolder(path)) {
+    return std::make_unique<vfs::HostPathDevice>("", path, true);
+  }
+  auto last_dot = path.find_last_of('.');
+  if (last_dot != std::wstring::npos) {
+    auto extension = path.substr(last_dot);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   tolower);
+    if (extension == L".iso") {
+      return std::make_unique<vfs::DiscImageDevice>("", path);
+    }
+  }
+  return std::make_unique<vfs::StfsContainerDevice>("", path);
+}
+
+int vfs_bench_main(const std::vector<std::wstring>& args) {
+  if (args.size() <= 1) {
+    XELOGE("Usage: %S [source]", args[0].c_str());
+    return 1;
+  }
+
+  auto device = CreateDevice(args[1]);
+  if (!device->Initialize()) {
+    XELOGE("Failed to initialize device");
+    return 1;
+  }
+
+  size_t read_size = std::max(cvars::bench_read_size, 1);
+  std::vector<uint8_t> buffer(read_size);
+  std::mt19937_64 random(1234);
+  BenchStats sequential_stats;
+  BenchStats random_stats;
+
+  std::queue<vfs::Entry*> queue;
+  queue.push(device->ResolvePath("/"));
+  while (!queue.empty()) {
+    auto entry = queue.front();
+    queue.pop();
+    for (auto& child : entry->children()) {
+      queue.push(child.get());
+    }
+    if (entry->attributes() & kFileAttributeDirectory || !entry->size()) {
+      continue;
+    }
+
+    vfs::File* file = nullptr;
+    if (entry->Open(FileAccess::kFileReadData, &file) != X_STATUS_SUCCESS) {
+      XELOGW("Failed to open %s", entry->path().c_str());
+      continue;
+    }
+
+    // Front to back, as a title streaming an asset would.
+    uint64_t start = Clock::host_tick_count_platform();
+    for (size_t offset = 0; offset < entry->size();) {
+      size_t bytes_read = 0;
+      if (file->ReadSync(buffer.data(), read_size, offset, &bytes_read) !=
+              X_STATUS_SUCCESS ||
+          !bytes_read) {
+        break;
+      }
+      offset += bytes_read;
+      sequential_stats.bytes += bytes_read;
+      ++sequential_stats.reads;
+    }
+    sequential_stats.ticks += Clock::host_tick_count_platform() - start;
+
+    start = Clock::host_tick_count_platform();
+    for (int i = 0; i < cvars::bench_random_reads; ++i) {
+      size_t length = std::min(read_size, size_t(4096));
+      size_t offset = random() % entry->size();
+      size_t bytes_read = 0;
+      file->ReadSync(buffer.data(), length, offset, &bytes_read);
+      random_stats.bytes += bytes_read;
+      ++random_stats.reads;
+    }
+    random_stats.ticks += Clock::host_tick_count_platform() - start;
+
+    file->Destroy();
+  }
+
+  sequential_stats.Log("Sequential");
+  random_stats.Log("Random 4KB");
+  return 0;
+}
+
+}  // namespace vfs
+}  // namespace xe
+
+DEFINE_ENTRY_POINT(L"xenia-vfs-bench", xe::vfs::vfs_bench_main, "[source]",
+                   "source");
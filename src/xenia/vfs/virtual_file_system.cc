@@ -9,6 +9,8 @@
 
 #include "xenia/vfs/virtual_file_system.h"
 
+#include <cctype>
+
 #include "xenia/base/filesystem.h"
 #include "xenia/base/logging.h"
 #include "xenia/base/string.h"
@@ -20,6 +22,10 @@ namespace vfs {
 VirtualFileSystem::VirtualFileSystem() {}
 
 VirtualFileSystem::~VirtualFileSystem() {
+  XELOGD("Path cache: %llu hits, %llu misses",
+         static_cast<unsigned long long>(path_cache_hits_),
+         static_cast<unsigned long long>(path_cache_misses_));
+
   // Delete all devices.
   // This will explode if anyone is still using data from them.
   devices_.clear();
@@ -29,6 +35,7 @@ VirtualFileSystem::~VirtualFileSystem() {
 bool VirtualFileSystem::RegisterDevice(std::unique_ptr<Device> device) {
   auto global_lock = global_critical_region_.Acquire();
   devices_.emplace_back(std::move(device));
+  path_cache_.clear();
   return true;
 }
 
@@ -38,6 +45,7 @@ bool VirtualFileSystem::UnregisterDevice(const std::string& path) {
     if ((*it)->mount_path() == path) {
       XELOGD("Unregistered device: %s", (*it)->mount_path().c_str());
       devices_.erase(it);
+      path_cache_.clear();
       return true;
     }
   }
@@ -48,6 +56,7 @@ bool VirtualFileSystem::RegisterSymbolicLink(const std::string& path,
                                              const std::string& target) {
   auto global_lock = global_critical_region_.Acquire();
   symlinks_.insert({path, target});
+  path_cache_.clear();
   XELOGD("Registered symbolic link: %s => %s", path.c_str(), target.c_str());
 
   return true;
@@ -63,6 +72,7 @@ bool VirtualFileSystem::UnregisterSymbolicLink(const std::string& path) {
          it->second.c_str());
 
   symlinks_.erase(it);
+  path_cache_.clear();
   return true;
 }
 
@@ -103,6 +113,36 @@ bool VirtualFileSystem::ResolveSymbolicLink(const std::string& path,
 Entry* VirtualFileSystem::ResolvePath(const std::string& path) {
   auto global_lock = global_critical_region_.Acquire();
 
+  // Guest paths are case insensitive, so they share cache entries.
+  std::string key(path);
+  for (auto& c : key) {
+    c = char(std::tolower(static_cast<unsigned char>(c)));
+  }
+  auto it = path_cache_.find(key);
+  if (it != path_cache_.end()) {
+    const auto& cached = it->second;
+    if (cached.tree_generation == cached.device->tree_generation()) {
+      ++path_cache_hits_;
+      return cached.entry;
+    }
+    path_cache_.erase(it);
+  }
+  ++path_cache_misses_;
+
+  Device* device = nullptr;
+  auto entry = ResolvePathUncached(path, &device);
+  if (device) {
+    if (path_cache_.size() >= kPathCacheMaxSize) {
+      path_cache_.clear();
+    }
+    path_cache_.emplace(std::move(key),
+                        CachedPath{device, device->tree_generation(), entry});
+  }
+  return entry;
+}
+
+Entry* VirtualFileSystem::ResolvePathUncached(const std::string& path,
+                                              Device** out_device) {
   // Resolve relative paths
   std::string normalized_path(xe::filesystem::CanonicalizePath(path));
 
@@ -123,6 +163,7 @@ Entry* VirtualFileSystem::ResolvePath(const std::string& path) {
   }
 
   const auto& device = *it;
+  *out_device = device.get();
   auto relative_path = normalized_path.substr(device->mount_path().size());
   return device->ResolvePath(relative_path);
 }
@@ -38,6 +38,9 @@ class VirtualFileSystem {
   Entry* ResolvePath(const std::string& path);
   Entry* ResolveBasePath(const std::string& path);
 
+  uint64_t path_cache_hits() const { return path_cache_hits_; }
+  uint64_t path_cache_misses() const { return path_cache_misses_; }
+
   Entry* CreatePath(const std::string& path, uint32_t attributes);
   bool DeletePath(const std::string& path);
 
@@ -47,11 +50,24 @@ class VirtualFileSystem {
                     FileAction* out_action);
 
  private:
+  // ResolvePath results, including misses, by lowercase guest path. Entries
+  // are only valid while their device's tree_generation is unchanged.
+  struct CachedPath {
+    Device* device;
+    uint32_t tree_generation;
+    Entry* entry;
+  };
+  static const size_t kPathCacheMaxSize = 4096;
+
   xe::global_critical_region global_critical_region_;
   std::vector<std::unique_ptr<Device>> devices_;
   std::unordered_map<std::string, std::string> symlinks_;
+  std::unordered_map<std::string, CachedPath> path_cache_;
+  uint64_t path_cache_hits_ = 0;
+  uint64_t path_cache_misses_ = 0;
 
   bool ResolveSymbolicLink(const std::string& path, std::string& result);
+  Entry* ResolvePathUncached(const std::string& path, Device** out_device);
 };
 
 }  // namespace vfs